@@ -1,9 +1,16 @@
+#define MUDUO_LOG_MODULE kLogModuleTcp
+
 #include "Acceptor.h"
 
+#include "EventLoop.h"
 #include "InetAddress.h"
+#include "IoUringPoller.h"
 #include "Logger.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <strings.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -20,7 +27,12 @@ Acceptor::Acceptor(EventLoop *loop, const InetAddress &listenAddr, bool reusepor
     : loop_(loop)
     , acceptSocket_(createNonblocking())  // socket
     , acceptChannel_(loop, acceptSocket_.fd())
-    , listening_(false) 
+    , listening_(false)
+    , completionMode_(false)
+    , maxAcceptsPerEvent_(kMaxAcceptsPerEvent)
+    , idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC))
+    , numAccepted_(0)
+    , numDropped_(0)
 {
     acceptSocket_.setReuseAddr(true);
     acceptSocket_.setReusePort(reuseport);
@@ -32,30 +44,121 @@ Acceptor::Acceptor(EventLoop *loop, const InetAddress &listenAddr, bool reusepor
 }
 
 Acceptor::~Acceptor() {
+    if (acceptOp_) {
+        // 最后一个完成事件可能在 Acceptor 析构之后才到，回调不能再访问 this
+        acceptOp_->callback = [](int, const char *, uint32_t) {};
+        loop_->ioUringPoller()->cancel(acceptOp_);
+    }
     acceptChannel_.disableAll();
     acceptChannel_.remove();
+    if (idleFd_ >= 0) {
+        ::close(idleFd_);
+    }
 }
 
 void Acceptor::listen() {
     listening_ = true;
     acceptSocket_.listen();         // listen
-    acceptChannel_.enableReading(); // acceptChannel_ => Poller
+    if (!completionMode_ || !startAccept()) {
+        acceptChannel_.enableReading(); // acceptChannel_ => Poller
+    }
+}
+
+bool Acceptor::startAccept() {
+    IoUringPoller *poller = loop_->ioUringPoller();
+    if (poller == nullptr || !poller->enableCompletion()) {
+        LOG_ERROR("Acceptor::startAccept - io_uring completion mode is not available, use readiness mode");
+        return false;
+    }
+    if (!acceptOp_) {
+        acceptOp_ = std::make_shared<IoUringOp>();
+        acceptOp_->callback =
+            std::bind(&Acceptor::onAcceptComplete, this, std::placeholders::_1, std::placeholders::_3);
+    }
+    poller->submitAccept(acceptSocket_.fd(), acceptOp_);
+    return true;
+}
+
+// multishot ACCEPT 的完成事件，res 是新连接的 fd（已经是 SOCK_NONBLOCK | SOCK_CLOEXEC）
+void Acceptor::onAcceptComplete(int res, uint32_t flags) {
+    if (res >= 0) {
+        sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+        bzero(&addr, sizeof(addr));
+        ::getpeername(res, (sockaddr *)&addr, &len);
+        if (newConnectionCallback_) {
+            ++numAccepted_;
+            newConnectionCallback_(res, InetAddress(addr));
+        } else {
+            ::close(res);
+        }
+    } else if (res == -ECANCELED) {
+        return;
+    } else if ((res == -EMFILE || res == -ENFILE) && dropOne()) {
+        LOG_RATELIMIT(ERROR, "Acceptor::onAcceptComplete() sockfd reached limit, drop connection");
+    } else {
+        LOG_RATELIMIT(ERROR, "Acceptor::onAcceptComplete() accept error: %d", -res);
+    }
+    // 内核终止了 multishot（出错或者 CQ 溢出），重新提交
+    if (!(flags & IORING_CQE_F_MORE)) {
+        loop_->ioUringPoller()->submitAccept(acceptSocket_.fd(), acceptOp_);
+    }
 }
 
-// listenfd 有事件发生了，就是有新用户连接了
+/**
+ * listenfd 有事件发生了，就是有新用户连接了
+ * 一次 accept 到 EAGAIN，连接风暴时不用每个连接都回到 epoll_wait；最多 maxAcceptsPerEvent_ 个，
+ * 剩下的留到下一次 loop 迭代，避免饿死同一个 loop 上的其他连接
+ */
 void Acceptor::handleRead() {
+    for (int i = 0; i < maxAcceptsPerEvent_; ++i) {
+        if (!acceptOne()) {
+            return;
+        }
+    }
+    // LT 模式 listenfd 仍然可读，下一次 poll 还会返回；ET 模式不会再通知，需要自己放回 ready 列表
+    if (acceptChannel_.edgeTriggered()) {
+        acceptChannel_.keepReady(EPOLLIN);
+    }
+}
+
+bool Acceptor::acceptOne() {
     InetAddress peerAddr;
     int connfd = acceptSocket_.accept(&peerAddr);
     if (connfd >= 0) {
         if (newConnectionCallback_) {  // 轮询找到 subLoop，唤醒分发当前的新客户端的 Channel
+            ++numAccepted_;
             newConnectionCallback_(connfd, peerAddr);
         } else {
             ::close(connfd);
         }
-    } else {
-        LOG_ERROR("Acceptor::handleRead() accept error: %d", errno);
-        if (errno == EMFILE) {
-            LOG_ERROR("Acceptor::handleRead() sockfd reached limit!");
-        }
+        return true;
+    }
+    int savedErrno = errno;
+    if (savedErrno == EMFILE || savedErrno == ENFILE) {
+        // 连接一直留在 backlog 里 listenfd 就一直可读，LT 模式下 loop 会空转，所以要把连接取出来关掉
+        LOG_RATELIMIT(ERROR, "Acceptor::handleRead() sockfd reached limit, drop connection");
+        return dropOne();
+    }
+    if (savedErrno != EAGAIN) {
+        // accept 失败时 listenfd 仍然可读，每次 poll 都会回来，需要限速
+        LOG_RATELIMIT(ERROR, "Acceptor::handleRead() accept error: %d", savedErrno);
+    }
+    return false;
+}
+
+/**
+ *!NOTE: 关掉预留的 fd 和重新打开之间，其他线程可能抢走这个位置，这时 idleFd_ 为 -1，下一次再尝试打开
+ */
+bool Acceptor::dropOne() {
+    if (idleFd_ >= 0) {
+        ::close(idleFd_);
+    }
+    int connfd = ::accept(acceptSocket_.fd(), nullptr, nullptr);
+    if (connfd >= 0) {
+        ::close(connfd);
+        ++numDropped_;
     }
+    idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return connfd >= 0;
 }
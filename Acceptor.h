@@ -4,8 +4,12 @@
 #include "Socket.h"
 #include "noncopyable.h"
 
+#include <atomic>
+#include <memory>
+
 class EventLoop;
 class InetAddress;
+struct IoUringOp;
 
 class Acceptor : noncopyable {
   public:
@@ -16,11 +20,30 @@ class Acceptor : noncopyable {
 
     void setNewConnectionCallback(const NewConnectionCallback &cb) { newConnectionCallback_ = cb; }
 
+    // 边缘触发，必须在 listen 之前设置
+    void setEdgeTriggered(bool on) { acceptChannel_.setEdgeTriggered(on); }
+
+    // 每次可读事件最多 accept 多少个连接，默认 kMaxAcceptsPerEvent，剩下的留到下一次 loop 迭代
+    void setMaxAcceptsPerEvent(int n) { maxAcceptsPerEvent_ = n > 0 ? n : 1; }
+
+    // io_uring 完成模式，必须在 listen 之前设置，一个 multishot ACCEPT 持续接受新连接，poller 不是 io_uring 时忽略
+    void setCompletionMode(bool on) { completionMode_ = on; }
+
     bool listening() const { return listening_; }
     void listen();
 
+    // 可以在任意线程读取
+    uint64_t acceptedCount() const { return numAccepted_; }  // 交给 newConnectionCallback 的连接数
+    uint64_t droppedCount() const { return numDropped_; }    // fd 用完时直接关闭的连接数
+
   private:
+    static const int kMaxAcceptsPerEvent = 64;
+
     void handleRead();
+    bool acceptOne();  // accept 一个连接，没有新连接或者出错时返回 false
+    bool dropOne();    // fd 用完了，用预留的 fd accept 一个连接再关掉，没有关掉连接时返回 false
+    bool startAccept();  // 提交 multishot ACCEPT，poller 不支持完成模式时返回 false
+    void onAcceptComplete(int res, uint32_t flags);
 
     EventLoop *loop_;
     Socket acceptSocket_;
@@ -29,4 +52,10 @@ class Acceptor : noncopyable {
     // 将 accept 到的 connfd 绑定到 channel 上并注册事件，由上层 TcpServer 设置回调
     NewConnectionCallback newConnectionCallback_;
     bool listening_;
+    bool completionMode_;
+    int maxAcceptsPerEvent_;
+    int idleFd_;  // 预留的 fd，EMFILE 时关掉腾出一个位置
+    std::atomic<uint64_t> numAccepted_;
+    std::atomic<uint64_t> numDropped_;
+    std::shared_ptr<IoUringOp> acceptOp_;
 };
@@ -0,0 +1,177 @@
+#include "AsyncLogging.h"
+
+#include "LogFile.h"
+
+#include <stdio.h>
+
+#include <chrono>
+
+namespace {
+std::atomic<uint64_t> s_numCreated(0);
+const size_t kMaxFreeBuffers = 16;  // 回收 buffer 的上限，多余的直接释放
+}  // namespace
+
+AsyncLogging::AsyncLogging(const std::string &basename, off_t rollSize, int flushInterval, size_t maxPendingBuffers)
+    : basename_(basename)
+    , rollSize_(rollSize)
+    , flushInterval_(flushInterval)
+    , maxPendingBuffers_(maxPendingBuffers)
+    , id_(++s_numCreated)
+    , running_(false)
+    , droppedLines_(0)
+    , thread_(std::bind(&AsyncLogging::threadFunc, this), "AsyncLogging") {}
+
+AsyncLogging::~AsyncLogging() { stop(); }
+
+void AsyncLogging::start() {
+    running_ = true;
+    thread_.start();
+}
+
+// 没有 start 或者已经 stop 过时什么都不做，可以重复调用
+void AsyncLogging::stop() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);  // 防止后台线程错过 notify 多等一个 flushInterval
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cond_.notify_one();
+    thread_.join();
+}
+
+// 当前线程的 front buffer，第一次写日志时注册
+AsyncLogging::ThreadBuffer *AsyncLogging::threadBuffer() {
+    static thread_local ThreadBufferPtr t_buffer;
+    static thread_local uint64_t t_owner = 0;
+
+    if (t_owner != id_) {
+        ThreadBufferPtr buffer(new ThreadBuffer);
+        buffer->current = takeFreeBuffer();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        threadBuffers_.push_back(buffer);
+        t_buffer = buffer;
+        t_owner = id_;
+    }
+    return t_buffer.get();
+}
+
+AsyncLogging::LogBufferPtr AsyncLogging::takeFreeBuffer() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!freeBuffers_.empty()) {
+            LogBufferPtr buffer(std::move(freeBuffers_.back()));
+            freeBuffers_.pop_back();
+            return buffer;
+        }
+    }
+    return LogBufferPtr(new LogBuffer);
+}
+
+void AsyncLogging::append(const char *logline, size_t len) {
+    if (len >= LogBuffer::kSize) {
+        ++droppedLines_;
+        return;
+    }
+
+    ThreadBuffer *tb = threadBuffer();
+    std::unique_lock<std::mutex> lock(tb->mutex);
+    if (tb->current->avail() > len) {
+        tb->current->append(logline, len);  // 绝大多数情况，只有一次 memcpy
+        return;
+    }
+
+    // front buffer 写满了，交给后台线程
+    {
+        std::unique_lock<std::mutex> globalLock(mutex_);
+        if (fullBuffers_.size() >= maxPendingBuffers_) {
+            // 后台来不及落盘，丢弃这一行而不是阻塞 IO 线程
+            ++droppedLines_;
+            return;
+        }
+        fullBuffers_.push_back(std::move(tb->current));
+        if (!freeBuffers_.empty()) {
+            tb->current = std::move(freeBuffers_.back());
+            freeBuffers_.pop_back();
+        } else {
+            tb->current.reset(new LogBuffer);
+        }
+        cond_.notify_one();
+    }
+    tb->current->append(logline, len);
+}
+
+void AsyncLogging::threadFunc() {
+    LogFile output(basename_, rollSize_);
+    std::vector<LogBufferPtr> buffersToWrite;
+    std::vector<ThreadBufferPtr> threads;
+    LogBufferPtr spare(new LogBuffer);
+    int64_t reportedDropped = 0;
+
+    bool running = true;
+    while (running) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (fullBuffers_.empty() && running_) {
+                cond_.wait_for(lock, std::chrono::seconds(flushInterval_));
+            }
+            running = running_;  // stop 之后再写最后一轮
+            buffersToWrite.swap(fullBuffers_);
+            threads = threadBuffers_;
+        }
+
+        // 换出每个线程还没写满的 front buffer，保证日志最多延迟 flushInterval 秒落盘
+        for (const ThreadBufferPtr &tb : threads) {
+            if (!spare) {
+                spare = takeFreeBuffer();
+            }
+            std::unique_lock<std::mutex> lock(tb->mutex);
+            if (tb->current->length() > 0) {
+                tb->current.swap(spare);
+                buffersToWrite.push_back(std::move(spare));
+            }
+        }
+
+        int64_t dropped = droppedLines_;
+        if (dropped != reportedDropped) {
+            char buf[128];
+            int len = snprintf(buf,
+                               sizeof(buf),
+                               "[ERROR] AsyncLogging dropped %ld log lines, %ld in total\n",
+                               dropped - reportedDropped,
+                               dropped);
+            output.append(buf, len);
+            reportedDropped = dropped;
+        }
+
+        for (LogBufferPtr &buffer : buffersToWrite) {
+            output.append(buffer->data(), buffer->length());
+            buffer->reset();
+        }
+        output.flush();
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (LogBufferPtr &buffer : buffersToWrite) {
+                if (freeBuffers_.size() < kMaxFreeBuffers) {
+                    freeBuffers_.push_back(std::move(buffer));
+                }
+            }
+
+            // 线程退出之后只剩 threadBuffers_ 和 threads 两个引用，内容已经在上面写出去了
+            for (size_t i = 0; i < threadBuffers_.size();) {
+                if (threadBuffers_[i].use_count() == 2 && threadBuffers_[i]->current->length() == 0) {
+                    threadBuffers_[i] = threadBuffers_.back();
+                    threadBuffers_.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+        }
+        buffersToWrite.clear();
+        threads.clear();
+    }
+    output.flush();
+}
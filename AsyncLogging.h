@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Thread.h"
+#include "noncopyable.h"
+
+#include <string.h>
+#include <sys/types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * 异步日志后端
+ * - 前端: 每个线程一块 front buffer，LOG_* 只做内存拷贝，不做系统调用
+ *   buffer 写满后交给后台线程，后台积压的 buffer 超过上限时直接丢弃并计数，不会阻塞 IO 线程
+ * - 后端: 后台线程在有写满的 buffer 或者每隔 flushInterval 秒，换出所有线程的 front buffer，
+ *   写入滚动日志文件 LogFile
+ *
+ * 使用方式:
+ *   AsyncLogging *g_asyncLog = new AsyncLogging("/tmp/server", 500 * 1024 * 1024);
+ *   void asyncOutput(const char *msg, size_t len) { g_asyncLog->append(msg, len); }
+ *   g_asyncLog->start();
+ *   Logger::setOutput(asyncOutput);
+ */
+class AsyncLogging : noncopyable {
+  public:
+    AsyncLogging(const std::string &basename, off_t rollSize, int flushInterval = 3, size_t maxPendingBuffers = 16);
+    ~AsyncLogging();
+
+    void append(const char *logline, size_t len);  // 线程安全
+
+    void start();
+    void stop();  // 可以重复调用，没有 start 时什么都不做
+
+    int64_t droppedLines() const { return droppedLines_; }
+
+  private:
+    // 固定大小的日志缓冲区
+    class LogBuffer : noncopyable {
+      public:
+        static const size_t kSize = 512 * 1024;
+
+        LogBuffer() : cur_(data_) {}
+
+        void append(const char *buf, size_t len) {
+            memcpy(cur_, buf, len);
+            cur_ += len;
+        }
+
+        const char *data() const { return data_; }
+        size_t length() const { return static_cast<size_t>(cur_ - data_); }
+        size_t avail() const { return static_cast<size_t>(data_ + kSize - cur_); }
+        void reset() { cur_ = data_; }
+
+      private:
+        char data_[kSize];
+        char *cur_;
+    };
+
+    using LogBufferPtr = std::unique_ptr<LogBuffer>;
+
+    // 每个线程一块 front buffer，mutex 只和后台线程竞争
+    struct ThreadBuffer {
+        std::mutex mutex;
+        LogBufferPtr current;
+    };
+
+    using ThreadBufferPtr = std::shared_ptr<ThreadBuffer>;
+
+    ThreadBuffer *threadBuffer();
+    LogBufferPtr takeFreeBuffer();
+    void threadFunc();
+
+    const std::string basename_;
+    const off_t rollSize_;
+    const int flushInterval_;
+    const size_t maxPendingBuffers_;
+    const uint64_t id_;  // 区分不同的 AsyncLogging 实例，thread_local 缓存用
+
+    std::atomic_bool running_;
+    std::atomic<int64_t> droppedLines_;
+    Thread thread_;
+
+    std::mutex mutex_;  // 保护下面的成员
+    std::condition_variable cond_;
+    std::vector<ThreadBufferPtr> threadBuffers_;  // 所有写过日志的线程
+    std::vector<LogBufferPtr> fullBuffers_;       // 写满待落盘的 buffer
+    std::vector<LogBufferPtr> freeBuffers_;       // 落盘后回收的 buffer
+};
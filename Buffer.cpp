@@ -4,13 +4,25 @@
 #include <sys/uio.h>
 #include <unistd.h>
 
+const size_t Buffer::kExtraBufSize;
+const size_t Buffer::kMinReadHint;
+
+namespace {
+//!NOTE: one loop per thread，线程局部的溢出区就是每个 loop 共享的，不需要每次 read 都在栈上清零 64K
+__thread char t_extrabuf[Buffer::kExtraBufSize];
+}  // namespace
+
 /**
  * !NOTE: [TcpConn inputBuffer 视角] 从 fd 读数据，相当于读到 buffer 的写缓冲区
  * 从 fd 上读数据，Poller 工作在 LT 模式
  * Buffer 缓冲区是有大小的，但是从 fd 上读取数据的时候却不知道 tcp 数据最终的大小
+ * 1. 先根据 readHint_ 保证 buffer 有足够的可写空间，大部分数据直接读到 buffer 里
+ * 2. 超出的部分读到线程局部的 extrabuf，再 append 到 buffer
  */
 ssize_t Buffer::readFd(int fd, int *saveErrno) {
-    char extrabuf[65536] = {0};  // 栈上分配的内存空间 64K
+    if (writableBytes() < readHint_) {
+        ensureWritableBytes(readHint_);
+    }
 
     struct iovec vec[2];  // iovec 结构体包含起始地址以及对应长度
 
@@ -18,26 +30,99 @@ ssize_t Buffer::readFd(int fd, int *saveErrno) {
     vec[0].iov_base = begin() + writerIndex_;
     vec[0].iov_len = writable;
 
-    vec[1].iov_base = extrabuf;
-    vec[2].iov_len = sizeof(extrabuf);
+    vec[1].iov_base = t_extrabuf;
+    vec[1].iov_len = sizeof(t_extrabuf);
 
-    // 相当于一次最多读 64K 的数据
-    const int iovcnt = (writable < sizeof(extrabuf)) ? 2 : 1;
-    const size_t n = ::readv(fd, vec, iovcnt);
+    // 相当于一次最多读 writable + 64K 的数据
+    const int iovcnt = (writable < sizeof(t_extrabuf)) ? 2 : 1;
+    const ssize_t n = ::readv(fd, vec, iovcnt);
     if (n < 0) {
         *saveErrno = errno;
-    } else if (n <= writable) {  // buffer 可写缓冲区够存放
+    } else if (static_cast<size_t>(n) <= writable) {  // buffer 可写缓冲区够存放
         writerIndex_ += n;
     } else {
         // buffer 可写缓冲区不够存放，extrabuf 写入了数据
         writerIndex_ = buffer_.size();
-        append(extrabuf, n - writable);  // 从 writerIndex_ 开始写剩余的数据
+        append(t_extrabuf, n - writable);  // 从 writerIndex_ 开始写剩余的数据
+    }
+
+    if (n > 0) {
+        adjustReadHint(n, writable);
     }
     return n;
 }
 
+// 非 LT 的一次性读完: 读到 EAGAIN、EOF 或者超过 maxBytes 为止
+ssize_t Buffer::readFdUntilEAgain(int fd, int *saveErrno, size_t maxBytes) {
+    size_t total = 0;
+    while (true) {
+        int savedErrno = 0;
+        size_t writable = writableBytes();
+        size_t capacity = writable < sizeof(t_extrabuf) ? writable + sizeof(t_extrabuf) : writable;
+        ssize_t n = readFd(fd, &savedErrno);
+        if (n > 0) {
+            total += n;
+            if (static_cast<size_t>(n) < capacity) {
+                *saveErrno = EAGAIN;  // 没有读满，socket 已经读空了，不需要再 read 一次 EAGAIN
+                break;
+            }
+            if (total >= maxBytes) {
+                break;
+            }
+        } else if (n == 0) {
+            break;  // EOF，有数据时先上报数据，下一次 readable 再处理关闭
+        } else {
+            if (savedErrno == EINTR) {
+                continue;
+            }
+            *saveErrno = savedErrno;  // EAGAIN 也返回给上层，ET 模式据此判断是否已经读空
+            if (total == 0) {
+                return n;
+            }
+            break;
+        }
+    }
+    return static_cast<ssize_t>(total);
+}
+
+/**
+ * 读到的数据量接近或超过 inline 部分时放大估计值，否则慢慢衰减（1/8 的指数平均）
+ * 上限是 extrabuf 的大小，避免单个连接的 buffer 过大
+ */
+void Buffer::adjustReadHint(size_t n, size_t capacity) {
+    if (n >= capacity) {
+        readHint_ = std::min(readHint_ * 2, kExtraBufSize);
+    } else {
+        readHint_ = std::max((readHint_ * 7 + n) / 8, kMinReadHint);
+    }
+}
+
 Buffer::~Buffer() {}
 
+// 一次取出最多 kBatch 个 '\n' 的位置再逐个切分，行很短时一个 SIMD 块里的多个行尾只比较一次
+size_t Buffer::splitLines(std::vector<StringPiece> *lines) const {
+    static const size_t kBatch = 64;
+    const char *positions[kBatch];
+    const char *start = peek();
+    const char *end = beginWrite();
+    const char *lineBegin = start;
+    size_t n = kBatch;
+    while (n == kBatch) {
+        n = SimdSearch::findAll(lineBegin, end, '\n', positions, kBatch);
+        // 一批一起 resize，逐个 push_back 每行都要重新检查容量
+        size_t first = lines->size();
+        lines->resize(first + n);
+        StringPiece *out = lines->data() + first;
+        for (size_t i = 0; i < n; ++i) {
+            const char *eol = positions[i];
+            const char *lineEnd = eol > lineBegin && eol[-1] == '\r' ? eol - 1 : eol;
+            out[i] = StringPiece(lineBegin, lineEnd - lineBegin);
+            lineBegin = eol + 1;
+        }
+    }
+    return lineBegin - start;
+}
+
 //!NOTE: [TcpConn outputBuffer 视角] 向 fd 写数据，相当于就是从 buffer 读缓存区拿数据
 ssize_t Buffer::writeFd(int fd, int *saveErrno) {
     ssize_t n = ::write(fd, peek(), readableBytes());
@@ -1,5 +1,13 @@
 #pragma once
 
+#include "SimdSearch.h"
+#include "StringPiece.h"
+
+#include <assert.h>
+#include <endian.h>
+#include <stdint.h>
+#include <string.h>
+
 #include <algorithm>
 #include <string>
 #include <vector>
@@ -20,9 +28,14 @@ class Buffer {
   public:
     static const size_t kCheapPrepend = 8;
     static const size_t kInitialSize = 1024;
+    static const size_t kExtraBufSize = 65536;  // 每个线程（loop）共享的溢出区大小
+    static const size_t kMinReadHint = 512;
 
     explicit Buffer(size_t initialSize = kInitialSize)
-        : buffer_(kCheapPrepend + initialSize), readerIndex_(kCheapPrepend), writerIndex_(kCheapPrepend) {}
+        : buffer_(kCheapPrepend + initialSize)
+        , readerIndex_(kCheapPrepend)
+        , writerIndex_(kCheapPrepend)
+        , readHint_(kMinReadHint) {}
 
     ~Buffer();
 
@@ -46,6 +59,9 @@ class Buffer {
         }
     }
 
+    // end 是可读区域里的位置，例如 findCRLF() + 2
+    void retrieveUntil(const char *end) { retrieve(end - peek()); }
+
     void retrieveAll() {
         readerIndex_ = kCheapPrepend;
         writerIndex_ = kCheapPrepend;
@@ -75,14 +91,132 @@ class Buffer {
         writerIndex_ += len;  // 更新 writeIndex
     }
 
+    void append(const void *data, size_t len) { append(static_cast<const char *>(data), len); }
+
+    /**
+     * 二进制协议的整数，append / prepend 时转成网络字节序，peek / read 时转回主机字节序
+     * - peek 不移动 readerIndex_，read 相当于 peek 之后 retrieve，可读数据不够时是调用者的错误（assert）
+     * - prepend 写到可读数据的前面，用的是 kCheapPrepend 预留的空间：先把消息体 append 进来，
+     *   再 prepend 长度之类的头部，不用把头部和消息体拼成一个新的 string
+     */
+    void appendInt64(int64_t x) {
+        uint64_t be = htobe64(static_cast<uint64_t>(x));
+        append(&be, sizeof be);
+    }
+    void appendInt32(int32_t x) {
+        uint32_t be = htobe32(static_cast<uint32_t>(x));
+        append(&be, sizeof be);
+    }
+    void appendInt16(int16_t x) {
+        uint16_t be = htobe16(static_cast<uint16_t>(x));
+        append(&be, sizeof be);
+    }
+    void appendInt8(int8_t x) { append(&x, sizeof x); }
+
+    int64_t peekInt64() const {
+        assert(readableBytes() >= sizeof(int64_t));
+        uint64_t be;
+        ::memcpy(&be, peek(), sizeof be);
+        return static_cast<int64_t>(be64toh(be));
+    }
+    int32_t peekInt32() const {
+        assert(readableBytes() >= sizeof(int32_t));
+        uint32_t be;
+        ::memcpy(&be, peek(), sizeof be);
+        return static_cast<int32_t>(be32toh(be));
+    }
+    int16_t peekInt16() const {
+        assert(readableBytes() >= sizeof(int16_t));
+        uint16_t be;
+        ::memcpy(&be, peek(), sizeof be);
+        return static_cast<int16_t>(be16toh(be));
+    }
+    int8_t peekInt8() const {
+        assert(readableBytes() >= sizeof(int8_t));
+        return static_cast<int8_t>(*peek());
+    }
+
+    int64_t readInt64() {
+        int64_t x = peekInt64();
+        retrieve(sizeof x);
+        return x;
+    }
+    int32_t readInt32() {
+        int32_t x = peekInt32();
+        retrieve(sizeof x);
+        return x;
+    }
+    int16_t readInt16() {
+        int16_t x = peekInt16();
+        retrieve(sizeof x);
+        return x;
+    }
+    int8_t readInt8() {
+        int8_t x = peekInt8();
+        retrieve(sizeof x);
+        return x;
+    }
+
+    void prepend(const void *data, size_t len) {
+        assert(len <= prependableBytes());
+        readerIndex_ -= len;
+        ::memcpy(begin() + readerIndex_, data, len);
+    }
+    void prependInt64(int64_t x) {
+        uint64_t be = htobe64(static_cast<uint64_t>(x));
+        prepend(&be, sizeof be);
+    }
+    void prependInt32(int32_t x) {
+        uint32_t be = htobe32(static_cast<uint32_t>(x));
+        prepend(&be, sizeof be);
+    }
+    void prependInt16(int16_t x) {
+        uint16_t be = htobe16(static_cast<uint16_t>(x));
+        prepend(&be, sizeof be);
+    }
+    void prependInt8(int8_t x) { prepend(&x, sizeof x); }
+
+    size_t internalCapacity() const { return buffer_.capacity(); }
+
+    // 释放多余的容量，只保留可读数据和 reserve 字节，空闲连接不用一直占着初始的 kInitialSize
+    void shrink(size_t reserve) {
+        size_t readable = readableBytes();
+        std::vector<char> buf(kCheapPrepend + readable + reserve);
+        std::copy(peek(), peek() + readable, buf.begin() + kCheapPrepend);
+        buffer_.swap(buf);
+        readerIndex_ = kCheapPrepend;
+        writerIndex_ = kCheapPrepend + readable;
+    }
+
     char *beginWrite() { return begin() + writerIndex_; }
 
     const char *beginWrite() const { return begin() + writerIndex_; }
 
-    ssize_t readFd(int fd, int *saveErrno);   // 从 fd 上读取数据
+    // 直接写到 beginWrite() 之后（例如 snprintf），先 ensureWritableBytes
+    void hasWritten(size_t len) { writerIndex_ += len; }
+
+    // 以下查找都在可读区域里进行，start 必须在 [peek(), beginWrite()] 之间，返回 nullptr 表示没有找到
+    // 实现参考 SimdSearch，按 CPU 选择 AVX2 / SSE2
+    const char *findCRLF() const { return SimdSearch::findCRLF(peek(), beginWrite()); }
+    const char *findCRLF(const char *start) const { return SimdSearch::findCRLF(start, beginWrite()); }
+    const char *findEOL() const { return SimdSearch::findByte(peek(), beginWrite(), '\n'); }
+    const char *findEOL(const char *start) const { return SimdSearch::findByte(start, beginWrite(), '\n'); }
+    const char *findByte(char c) const { return SimdSearch::findByte(peek(), beginWrite(), c); }
+    const char *findByte(char c, const char *start) const { return SimdSearch::findByte(start, beginWrite(), c); }
+
+    // 可读区域里所有完整的行（以 '\n' 结尾）追加到 lines，不包括行尾的 "\r\n" 或者 "\n"，不拷贝数据
+    // 返回这些行占用的字节数，处理完之后 retrieve 这么多，最后不完整的一行留在 Buffer 里等更多数据
+    size_t splitLines(std::vector<StringPiece> *lines) const;
+
+    ssize_t readFd(int fd, int *saveErrno);  // 从 fd 上读取数据，一次 readv
+    // 循环读直到 EAGAIN 或者本次读到的数据超过 maxBytes，返回读到的总字节数
+    // 读空了（EAGAIN 或者没有读满）时 saveErrno 为 EAGAIN，因为 EOF 或者 maxBytes 停下来时不修改 saveErrno
+    ssize_t readFdUntilEAgain(int fd, int *saveErrno, size_t maxBytes);
     ssize_t writeFd(int fd, int *saveErrno);  // 通过 fd 发送数据
 
   private:
+    void adjustReadHint(size_t n, size_t capacity);
+
     char *begin() {
         return &*buffer_.begin();  // vector 底层数组首元素的地址，也就是数组的起始地址
     }
@@ -111,4 +245,5 @@ class Buffer {
     std::vector<char> buffer_;
     size_t readerIndex_;
     size_t writerIndex_;
+    size_t readHint_;  // 根据最近读到的数据量估计下一次 read 的大小
 };
@@ -0,0 +1,216 @@
+#include "BufferChain.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+const size_t BufferChain::kSegmentSize;
+const size_t BufferChain::kRefThreshold;
+
+namespace {
+const size_t kMaxSpareSegments = 1;  // 每个连接最多缓存一个空闲分段，连接多的时候不会占太多内存
+}  // namespace
+
+BufferChain::Segment &BufferChain::appendSegment() {
+    segments_.push_back(Segment());
+    Segment &seg = segments_.back();
+    if (!spare_.empty()) {
+        seg.owned.swap(spare_.back());
+        spare_.pop_back();
+    }
+    return seg;
+}
+
+void BufferChain::popFront() {
+    Segment &seg = segments_.front();
+    if (!seg.shared && !seg.isFile() && seg.owned.capacity() <= kSegmentSize && spare_.size() < kMaxSpareSegments) {
+        seg.owned.clear();
+        spare_.push_back(std::string());
+        spare_.back().swap(seg.owned);
+    }
+    segments_.pop_front();
+}
+
+void BufferChain::append(const char *data, size_t len) {
+    readableBytes_ += len;
+    while (len > 0) {
+        if (segments_.empty() || !segments_.back().appendable()) {
+            appendSegment().owned.reserve(std::min(len, kSegmentSize));
+        }
+        std::string &tail = segments_.back().owned;
+        size_t n = std::min(len, kSegmentSize - tail.size());
+        tail.append(data, n);
+        data += n;
+        len -= n;
+    }
+}
+
+void BufferChain::append(std::string &&data) { append(std::move(data), 0); }
+
+void BufferChain::append(std::string &&data, size_t offset) {
+    if (offset >= data.size()) {
+        return;
+    }
+    if (data.size() - offset < kRefThreshold) {
+        append(data.data() + offset, data.size() - offset);
+        return;
+    }
+    readableBytes_ += data.size() - offset;
+    segments_.push_back(Segment());
+    segments_.back().owned.swap(data);
+    segments_.back().offset = offset;
+}
+
+void BufferChain::append(const std::shared_ptr<const std::string> &data) { append(data, 0); }
+
+void BufferChain::append(const std::shared_ptr<const std::string> &data, size_t offset) {
+    if (!data || offset >= data->size()) {
+        return;
+    }
+    readableBytes_ += data->size() - offset;
+    segments_.push_back(Segment());
+    segments_.back().shared = data;
+    segments_.back().offset = offset;
+}
+
+void BufferChain::appendFile(int fd, off_t offset, size_t length, const std::shared_ptr<const void> &owner) {
+    if (length == 0) {
+        return;
+    }
+    readableBytes_ += length;
+    segments_.push_back(Segment());
+    Segment &seg = segments_.back();
+    seg.fd = fd;
+    seg.fileOffset = offset;
+    seg.fileLength = length;
+    seg.fileOwner = owner;
+}
+
+void BufferChain::appendPipe(int fd, size_t length, const std::shared_ptr<const void> &owner) {
+    if (length == 0) {
+        return;
+    }
+    readableBytes_ += length;
+    if (!segments_.empty() && segments_.back().pipe && segments_.back().fd == fd) {
+        segments_.back().fileLength += length;  // pipe 里的数据本来就是连续的
+        return;
+    }
+    segments_.push_back(Segment());
+    Segment &seg = segments_.back();
+    seg.fd = fd;
+    seg.fileLength = length;
+    seg.fileOwner = owner;
+    seg.pipe = true;
+}
+
+void BufferChain::append(BufferChain &&other) {
+    for (Segment &seg : other.segments_) {
+        segments_.push_back(std::move(seg));
+    }
+    readableBytes_ += other.readableBytes_;
+    other.segments_.clear();
+    other.readableBytes_ = 0;
+}
+
+void BufferChain::swap(BufferChain &other) {
+    segments_.swap(other.segments_);
+    spare_.swap(other.spare_);
+    std::swap(readableBytes_, other.readableBytes_);
+}
+
+void BufferChain::retrieve(size_t len) {
+    if (len >= readableBytes_) {
+        retrieveAll();
+        return;
+    }
+    readableBytes_ -= len;
+    while (len > 0) {
+        Segment &seg = segments_.front();
+        size_t n = seg.size();
+        if (len < n) {
+            seg.offset += len;
+            break;
+        }
+        len -= n;
+        popFront();
+    }
+}
+
+void BufferChain::retrieveAll() {
+    while (!segments_.empty()) {
+        popFront();
+    }
+    readableBytes_ = 0;
+}
+
+//!NOTE: [TcpConn outputBuffer 视角] 一次系统调用把前面 IOV_MAX 个分段都交给内核
+ssize_t BufferChain::writeFd(int fd, int *saveErrno) {
+    if (!segments_.empty() && segments_.front().isFile()) {
+        return segments_.front().pipe ? splicePipeSegment(fd, saveErrno) : sendFileSegment(fd, saveErrno);
+    }
+
+    struct iovec vec[IOV_MAX];
+    size_t total = 0;
+    int iovcnt = peekIov(vec, IOV_MAX, &total);
+
+    ssize_t n = ::writev(fd, vec, iovcnt);
+    if (n < 0) {
+        *saveErrno = errno;
+    } else if (static_cast<size_t>(n) < total) {
+        *saveErrno = EAGAIN;
+    }
+    return n;
+}
+
+int BufferChain::peekIov(struct iovec *iov, int maxIov, size_t *total) const {
+    int iovcnt = 0;
+    *total = 0;
+    for (std::deque<Segment>::const_iterator it = segments_.begin();
+         it != segments_.end() && !it->isFile() && iovcnt < maxIov;
+         ++it) {
+        iov[iovcnt].iov_base = const_cast<char *>(it->data());
+        iov[iovcnt].iov_len = it->size();
+        *total += it->size();
+        ++iovcnt;
+    }
+    return iovcnt;
+}
+
+//!NOTE: sendfile 直接从 page cache 拷贝到 socket，文件数据不经过用户空间
+ssize_t BufferChain::sendFileSegment(int fd, int *saveErrno) {
+    const Segment &seg = segments_.front();
+    off_t offset = seg.fileOffset + static_cast<off_t>(seg.offset);
+    ssize_t n = ::sendfile(fd, seg.fd, &offset, seg.size());
+    if (n < 0) {
+        *saveErrno = errno;
+    } else if (n == 0) {
+        *saveErrno = EIO;  // 文件被截断了，剩下的数据永远发不出去
+        n = -1;
+    } else if (static_cast<size_t>(n) < seg.size()) {
+        *saveErrno = EAGAIN;
+    }
+    return n;
+}
+
+//!NOTE: splice 只移动 pipe 里的页引用，数据不经过用户空间；pipe 是空的说明记录的长度和 pipe 不一致，当作 EIO
+ssize_t BufferChain::splicePipeSegment(int fd, int *saveErrno) {
+    const Segment &seg = segments_.front();
+    ssize_t n = ::splice(seg.fd, nullptr, fd, nullptr, seg.size(), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (n < 0) {
+        *saveErrno = errno;
+    } else if (n == 0) {
+        *saveErrno = EIO;
+        n = -1;
+    } else if (static_cast<size_t>(n) < seg.size()) {
+        *saveErrno = EAGAIN;
+    }
+    return n;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "noncopyable.h"
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * TcpConnection 的发送缓冲区，由多个分段组成的链表
+ *
+ * +-----------+-----------+----------------------+-----------+
+ * |  owned    |  owned    |  shared (1MiB 响应)   |  owned    |
+ * +-----------+-----------+----------------------+-----------+
+ *   ^ offset_
+ *
+ * - 小块数据拷贝到尾部的 owned 分段里（最多 kSegmentSize），和原来的 Buffer 一样
+ * - 大块数据如果调用者把所有权交出来（std::string&& 或 shared_ptr），只引用不拷贝
+ * - 发送的时候一次 writev 最多聚合 IOV_MAX 个分段，已经发送完的分段直接出队，不会有 makeSpace 的 memmove
+ * - 文件分段只记录 fd + 区间，轮到它的时候用 sendfile 发送，数据不经过用户空间
+ * - pipe 分段只记录 pipe 读端和其中属于它的字节数，轮到它的时候用 splice 发送（TcpConnection::forwardTo）
+ *
+ * 不是线程安全的，只在 TcpConnection 所属的 loop 线程中使用
+ */
+class BufferChain : noncopyable {
+  public:
+    static const size_t kSegmentSize = 64 * 1024;  // owned 分段的最大长度，超过之后新开一个分段
+    static const size_t kRefThreshold = 16 * 1024;  // 大于等于它的 std::string&& 直接接管，不拷贝
+
+    BufferChain() : readableBytes_(0) {}
+
+    size_t readableBytes() const { return readableBytes_; }
+    size_t numSegments() const { return segments_.size(); }
+
+    void append(const char *data, size_t len);                    // 拷贝
+    void append(std::string &&data);                              // 大块数据接管，小块数据拷贝
+    void append(std::string &&data, size_t offset);               // 前 offset 个字节已经发送过了
+    void append(const std::shared_ptr<const std::string> &data);  // 引用，不拷贝
+    void append(const std::shared_ptr<const std::string> &data, size_t offset);
+    // 文件 fd 的 [offset, offset + length)，owner 非空时持有它直到发送完（例如 CachedFile）
+    void appendFile(int fd, off_t offset, size_t length, const std::shared_ptr<const void> &owner);
+    // pipe 读端 fd 里接下来的 length 个字节，owner 持有 pipe 直到发送完，和尾部同一个 pipe 的分段合并
+    void appendPipe(int fd, size_t length, const std::shared_ptr<const void> &owner);
+    void append(BufferChain &&other);  // 把 other 的分段整体移动到尾部，不拷贝数据
+
+    void swap(BufferChain &other);
+
+    void retrieve(size_t len);  // 丢弃前面 len 个字节，和 Buffer::retrieve 一样
+    void retrieveAll();
+
+    // 一次 writev 发送尽可能多的内存分段，第一个分段是文件时改用 sendfile，是 pipe 时改用 splice，
+    // 不会 retrieve，返回值和 ::writev 一样
+    // 文件比记录的长度短（被截断）时返回 -1，saveErrno 为 EIO
+    // 只写出去一部分（socket 发送缓冲区满了）时 saveErrno 为 EAGAIN，ET 模式不需要再写一次
+    ssize_t writeFd(int fd, int *saveErrno);
+
+    // 从头开始的内存分段填到 iov 里，遇到文件（或 pipe）分段停下，返回分段数，total 为总字节数
+    int peekIov(struct iovec *iov, int maxIov, size_t *total) const;
+    bool frontIsFile() const { return !segments_.empty() && segments_.front().isFile(); }
+
+    //!NOTE: 异步发送（io_uring SENDMSG）进行中数据地址不能变，尾部分段不再追加，之后的数据新开一个分段
+    void seal() {
+        if (!segments_.empty()) {
+            segments_.back().sealed = true;
+        }
+    }
+
+  private:
+    struct Segment {
+        std::string owned;
+        std::shared_ptr<const std::string> shared;  // 非空表示这是一个引用分段
+        size_t offset;                              // 已经发送的字节数
+
+        int fd;  // >= 0 表示这是一个文件分段
+        off_t fileOffset;
+        size_t fileLength;
+        std::shared_ptr<const void> fileOwner;
+        bool pipe;    // 文件分段的 fd 是 pipe 读端，没有偏移，splice 读出来的就是下一段数据
+        bool sealed;  // 见 seal()
+
+        Segment() : offset(0), fd(-1), fileOffset(0), fileLength(0), pipe(false), sealed(false) {}
+
+        bool isFile() const { return fd >= 0; }
+        // 只有尾部未满的 owned 分段可以继续追加
+        bool appendable() const { return !shared && !isFile() && !sealed && owned.size() < kSegmentSize; }
+
+        const char *data() const { return (shared ? shared->data() : owned.data()) + offset; }
+        size_t size() const {
+            if (isFile()) {
+                return fileLength - offset;
+            }
+            return (shared ? shared->size() : owned.size()) - offset;
+        }
+    };
+
+    Segment &appendSegment();
+    ssize_t sendFileSegment(int fd, int *saveErrno);
+    ssize_t splicePipeSegment(int fd, int *saveErrno);
+    void popFront();
+
+    std::deque<Segment> segments_;
+    std::vector<std::string> spare_;  // 回收的 owned 分段，保留 capacity 避免反复分配
+    size_t readableBytes_;
+};
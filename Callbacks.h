@@ -15,4 +15,6 @@ using WriteCompleteCallback = std::function<void(const TcpConnectionPtr &)>;
 
 using HighWaterMarkCallback = std::function<void(const TcpConnectionPtr &, size_t)>;
 
-using MessageCallback = std::function<void(const TcpConnectionPtr &, Buffer *, Timestamp)>;
\ No newline at end of file
+using MessageCallback = std::function<void(const TcpConnectionPtr &, Buffer *, Timestamp)>;
+
+using TimerCallback = std::function<void()>;
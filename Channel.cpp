@@ -1,7 +1,6 @@
 #include "Channel.h"
 
 #include "EventLoop.h"
-#include "Logger.h"
 
 #include <sys/epoll.h>
 
@@ -16,6 +15,9 @@ Channel::Channel(EventLoop *loop, int fd)
     , events_(0)
     , revents_(0)
     , index_(-1)
+    , edgeTriggered_(false)
+    , registeredEvents_(0)
+    , readyEvents_(0)
     , tied_(false) {}
 
 Channel::~Channel() {
@@ -42,6 +44,25 @@ void Channel::update() {
 // 在 channel 所属的 EventLoop 中把当前的 channel 删除掉
 void Channel::remove() { loop_->removeChannel(this); }
 
+int Channel::pollEvents() const {
+    if (!edgeTriggered_ || events_ == kNoneEvent) {
+        return events_;
+    }
+    int events = events_ | EPOLLET;
+    if (writeCallback_) {
+        events |= kWriteEvent;  // ET 模式一直关注 EPOLLOUT，避免每次部分写都 epoll_ctl MOD
+    }
+    return events;
+}
+
+void Channel::keepReady(int revents) {
+    bool queued = readyEvents_ != 0;
+    readyEvents_ |= revents;
+    if (!queued) {
+        loop_->queueReadyChannel(this);
+    }
+}
+
 // fd 得到 poller 通知之后处理事件
 void Channel::handleEvent(Timestamp receiveTime) {
     if (tied_) {
@@ -57,8 +78,6 @@ void Channel::handleEvent(Timestamp receiveTime) {
 
 // 根据 poller 通知的 channel 发生的具体事件，由 channel 负责调用具体的回调操作
 void Channel::handleEventWithGuard(Timestamp receiveTime) {
-    LOG_INFO("Channel::handleEventWithGuard - channel handleEvent revents: %d", revents_);
-
     // 异常
     if ((revents_ & EPOLLHUP) && !(revents_ & EPOLLIN)) {
         if (closeCallback_) {
@@ -80,8 +99,8 @@ void Channel::handleEventWithGuard(Timestamp receiveTime) {
         }
     }
 
-    // 写事件
-    if (revents_ & EPOLLOUT) {
+    // 写事件，ET 模式下 EPOLLOUT 一直注册着，没有数据要写时忽略
+    if ((revents_ & EPOLLOUT) && isWriting()) {
         if (writeCallback_) {
             writeCallback_();
         }
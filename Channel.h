@@ -37,6 +37,24 @@ class Channel : noncopyable {
     int events() const { return events_; }
     void set_revents(int revt) { revents_ = revt; }
 
+    /**
+     * 边缘触发（EPOLLET），必须在注册到 poller 之前设置
+     * ET 模式下设置了 writeCallback 的 channel 一直注册 EPOLLOUT，enableWriting / disableWriting 只修改
+     * isWriting() 的状态，不调用 epoll_ctl，没有在写的时候忽略 EPOLLOUT
+     */
+    void setEdgeTriggered(bool on) { edgeTriggered_ = on; }
+    bool edgeTriggered() const { return edgeTriggered_; }
+
+    // 实际注册到 poller 的事件，registeredEvents 由 poller 记录，相同时 poller 不再调用 epoll_ctl
+    int pollEvents() const;
+    int registeredEvents() const { return registeredEvents_; }
+    void set_registeredEvents(int events) { registeredEvents_ = events; }
+
+    // ET 模式下回调因为预算用完还没有读完 / 写完，下一次 loop 迭代以 revents 再处理一次，不等 epoll 通知
+    void keepReady(int revents);
+    int readyEvents() const { return readyEvents_; }
+    void set_readyEvents(int revents) { readyEvents_ = revents; }
+
     // 设置 channel.fd 读事件
     void enableReading() {
         events_ |= kReadEvent;
@@ -93,6 +111,10 @@ class Channel : noncopyable {
 
     int index_;  // channel 状态，被 Poller 调用
 
+    bool edgeTriggered_;
+    int registeredEvents_;  // 上一次 epoll_ctl 注册的事件
+    int readyEvents_;       // 非 0 表示在 EventLoop 的 readyChannels_ 里
+
     std::weak_ptr<void> tie_;
     bool tied_;
 
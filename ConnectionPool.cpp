@@ -0,0 +1,148 @@
+#define MUDUO_LOG_MODULE kLogModuleTcp
+
+#include "ConnectionPool.h"
+
+#include "EventLoop.h"
+#include "Logger.h"
+#include "TcpClient.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+static void noopConnectionCallback(const TcpConnectionPtr &) {}
+
+ConnectionPool::ConnectionPool(EventLoop *loop, const InetAddress &serverAddr, const std::string &nameArg, int size)
+    : loop_(loop)
+    , name_(nameArg)
+    , started_(false)
+    , numConnected_(0) {
+    for (int i = 0; i < size; ++i) {
+        char buf[32] = {0};
+        snprintf(buf, sizeof(buf), "#%d", i);
+        std::unique_ptr<TcpClient> client(new TcpClient(loop, serverAddr, name_ + buf));
+        client->enableRetry();
+        client->setConnectionCallback(std::bind(&ConnectionPool::onConnection, this, std::placeholders::_1));
+        clients_.push_back(std::move(client));
+    }
+    idle_.reserve(clients_.size());
+}
+
+/**
+ *!NOTE: stop 只是把 forceClose 放进了队列，连接真正关闭时还会回调 connectionCallback，
+ * 这里先换成空的回调，之后 TcpClient 析构时不会再访问 ConnectionPool
+ */
+ConnectionPool::~ConnectionPool() {
+    stop();
+    for (auto &client : clients_) {
+        TcpConnectionPtr conn = client->connection();
+        if (conn) {
+            conn->setConnectionCallback(noopConnectionCallback);
+        }
+    }
+    clients_.clear();
+}
+
+void ConnectionPool::setRetryDelay(int initMs, int maxMs) {
+    for (auto &client : clients_) {
+        client->setRetryDelay(initMs, maxMs);
+    }
+}
+
+void ConnectionPool::start() {
+    if (started_) {
+        return;
+    }
+    started_ = true;
+    for (auto &client : clients_) {
+        if (messageCallback_) {
+            client->setMessageCallback(messageCallback_);
+        }
+        client->connect();
+    }
+}
+
+void ConnectionPool::stop() {
+    if (!started_) {
+        return;
+    }
+    started_ = false;
+    idle_.clear();
+    for (auto &client : clients_) {
+        client->stop();
+        TcpConnectionPtr conn = client->connection();
+        if (conn) {
+            conn->forceClose();
+        }
+    }
+
+    std::deque<AcquireCallback> waiters;
+    waiters.swap(waiters_);
+    for (auto &cb : waiters) {
+        cb(TcpConnectionPtr());
+    }
+}
+
+void ConnectionPool::acquire(const AcquireCallback &cb) {
+    TcpConnectionPtr conn = tryAcquire();
+    if (conn) {
+        cb(conn);
+    } else if (started_) {
+        waiters_.push_back(cb);
+    } else {
+        cb(TcpConnectionPtr());
+    }
+}
+
+TcpConnectionPtr ConnectionPool::tryAcquire() {
+    while (!idle_.empty()) {
+        TcpConnectionPtr conn = std::move(idle_.back());
+        idle_.pop_back();
+        if (conn->connected()) {
+            return conn;
+        }
+    }
+    return TcpConnectionPtr();
+}
+
+void ConnectionPool::release(const TcpConnectionPtr &conn) {
+    if (!started_ || !conn->connected()) {
+        return;  // 断开的连接由 TcpClient 重连，重连成功之后会重新放回来
+    }
+    giveBack(conn);
+}
+
+void ConnectionPool::giveBack(const TcpConnectionPtr &conn) {
+    if (!waiters_.empty()) {
+        AcquireCallback cb = std::move(waiters_.front());
+        waiters_.pop_front();
+        cb(conn);
+    } else {
+        idle_.push_back(conn);
+    }
+}
+
+void ConnectionPool::onConnection(const TcpConnectionPtr &conn) {
+    if (conn->connected()) {
+        ++numConnected_;
+        if (connectionCallback_) {
+            connectionCallback_(conn);
+        }
+        if (started_) {
+            giveBack(conn);
+        }
+    } else {
+        --numConnected_;
+        auto it = std::find(idle_.begin(), idle_.end(), conn);
+        if (it != idle_.end()) {
+            idle_.erase(it);
+        }
+        LOG_INFO("ConnectionPool::onConnection[%s] - [%s] disconnected, %d connected",
+                 name_.c_str(),
+                 conn->name().c_str(),
+                 numConnected_);
+        if (connectionCallback_) {
+            connectionCallback_(conn);
+        }
+    }
+}
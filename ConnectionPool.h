@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Callbacks.h"
+#include "InetAddress.h"
+#include "noncopyable.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class EventLoop;
+class TcpClient;
+
+/**
+ * 一个 loop 上到同一个上游的连接池，start 之后预先建立 size 个连接，断开之后由 TcpClient 自动重连
+ * - acquire 借出一个已经建立的连接，请求不需要等 TCP 握手；没有空闲连接时排队，release 或者重连成功之后按顺序交给等待者
+ * - 借出期间连接归调用者独占，收到完整响应之后 release；已经断开的连接 release 时直接丢弃
+ * - 每个 loop 一个连接池（例如在 TcpServer 的 ThreadInitCallback 里创建），所有方法只能在 loop 线程调用，不需要加锁
+ * - 所有连接共用 messageCallback_，调用者根据 TcpConnectionPtr 找到对应的请求
+ */
+class ConnectionPool : noncopyable {
+  public:
+    using AcquireCallback = std::function<void(const TcpConnectionPtr &)>;
+
+    ConnectionPool(EventLoop *loop, const InetAddress &serverAddr, const std::string &nameArg, int size);
+    ~ConnectionPool();
+
+    // 必须在 start 之前设置；connectionCallback 在连接建立和断开时回调，借出的连接断开时调用者由此得知
+    void setConnectionCallback(const ConnectionCallback &cb) { connectionCallback_ = cb; }
+    void setMessageCallback(const MessageCallback &cb) { messageCallback_ = cb; }
+    void setRetryDelay(int initMs, int maxMs);  // 参考 Connector::setRetryDelay
+
+    void start();
+    void stop();  // 关闭所有连接，等待者回调空的 TcpConnectionPtr
+
+    // 有空闲连接时直接回调，否则排队
+    void acquire(const AcquireCallback &cb);
+    TcpConnectionPtr tryAcquire();  // 没有空闲连接时返回空
+    void release(const TcpConnectionPtr &conn);
+
+    size_t size() const { return clients_.size(); }
+    size_t idleCount() const { return idle_.size(); }
+    size_t waitingCount() const { return waiters_.size(); }
+    int connectedCount() const { return numConnected_; }
+
+  private:
+    void onConnection(const TcpConnectionPtr &conn);
+    void giveBack(const TcpConnectionPtr &conn);  // 有等待者就交给它，否则放回 idle_
+
+    EventLoop *loop_;
+    const std::string name_;
+    bool started_;
+    int numConnected_;
+
+    ConnectionCallback connectionCallback_;
+    MessageCallback messageCallback_;
+
+    std::vector<std::unique_ptr<TcpClient>> clients_;
+    std::vector<TcpConnectionPtr> idle_;  // 后进先出，最近用过的连接更可能还在 CPU 缓存里
+    std::deque<AcquireCallback> waiters_;
+};
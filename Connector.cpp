@@ -0,0 +1,199 @@
+#define MUDUO_LOG_MODULE kLogModuleTcp
+
+#include "Connector.h"
+
+#include "Channel.h"
+#include "EventLoop.h"
+#include "Logger.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+const int Connector::kInitRetryDelayMs;
+const int Connector::kMaxRetryDelayMs;
+
+Connector::Connector(EventLoop *loop, const InetAddress &serverAddr)
+    : loop_(loop)
+    , serverAddr_(serverAddr)
+    , connect_(false)
+    , state_(kDisconnected)
+    , initRetryDelayMs_(kInitRetryDelayMs)
+    , maxRetryDelayMs_(kMaxRetryDelayMs)
+    , retryDelayMs_(kInitRetryDelayMs) {
+    LOG_DEBUG("Connector::ctor[%p]", this);
+}
+
+Connector::~Connector() {
+    LOG_DEBUG("Connector::dtor[%p]", this);
+    if (channel_) {
+        LOG_ERROR("Connector::dtor - [%s] destroyed while connecting", serverAddr_.toIpPort().c_str());
+    }
+}
+
+void Connector::setRetryDelay(int initMs, int maxMs) {
+    initRetryDelayMs_ = std::max(initMs, 1);
+    maxRetryDelayMs_ = std::max(maxMs, initRetryDelayMs_);
+    retryDelayMs_ = initRetryDelayMs_;
+}
+
+void Connector::start() {
+    connect_ = true;
+    loop_->runInLoop(std::bind(&Connector::startInLoop, shared_from_this()));
+}
+
+void Connector::startInLoop() {
+    if (state_ != kDisconnected) {
+        return;  // 重试的定时器和 restart 可能同时触发
+    }
+    if (connect_) {
+        connect();
+    } else {
+        LOG_DEBUG("Connector::startInLoop - do not connect");
+    }
+}
+
+void Connector::restart() {
+    setState(kDisconnected);
+    retryDelayMs_ = initRetryDelayMs_;
+    connect_ = true;
+    startInLoop();
+}
+
+void Connector::stop() {
+    connect_ = false;
+    loop_->queueInLoop(std::bind(&Connector::stopInLoop, shared_from_this()));
+}
+
+void Connector::stopInLoop() {
+    loop_->cancel(retryTimer_);
+    if (state_ == kConnecting) {
+        setState(kDisconnected);
+        int sockfd = removeAndResetChannel();
+        ::close(sockfd);
+    }
+}
+
+void Connector::connect() {
+    int sockfd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sockfd < 0) {
+        LOG_ERROR("Connector::connect - socket error: %d", errno);
+        retry(-1);  // fd 用完之类的错误，过一会儿再试
+        return;
+    }
+    int ret = ::connect(sockfd, (const sockaddr *)serverAddr_.getSockAddr(), sizeof(sockaddr_in));
+    int savedErrno = (ret == 0) ? 0 : errno;
+    switch (savedErrno) {
+    case 0:
+    case EINPROGRESS:
+    case EINTR:
+    case EISCONN:
+        connecting(sockfd);
+        break;
+
+    // 对端没有监听或者本地端口暂时用完，退避之后重试
+    case EAGAIN:
+    case EADDRINUSE:
+    case EADDRNOTAVAIL:
+    case ECONNREFUSED:
+    case ENETUNREACH:
+        retry(sockfd);
+        break;
+
+    default:
+        LOG_ERROR("Connector::connect - [%s] connect error: %d", serverAddr_.toIpPort().c_str(), savedErrno);
+        ::close(sockfd);
+        break;
+    }
+}
+
+// 连接进行中，等 sockfd 可写
+void Connector::connecting(int sockfd) {
+    setState(kConnecting);
+    channel_.reset(new Channel(loop_, sockfd));
+    channel_->setWriteCallback(std::bind(&Connector::handleWrite, this));
+    channel_->setErrorCallback(std::bind(&Connector::handleError, this));
+    channel_->tie(shared_from_this());
+    channel_->enableWriting();
+}
+
+/**
+ * 连接结束之后 sockfd 交给 TcpConnection，这里的 channel 要从 poller 中删掉
+ *!NOTE: 现在正处在 channel_ 的回调里，不能直接析构 channel_，放到 doPendingFunctors 里再释放
+ */
+int Connector::removeAndResetChannel() {
+    channel_->disableAll();
+    channel_->remove();
+    int sockfd = channel_->fd();
+    loop_->queueInLoop(std::bind(&Connector::resetChannel, shared_from_this()));
+    return sockfd;
+}
+
+void Connector::resetChannel() {
+    if (state_ != kConnecting) {
+        channel_.reset();
+    }
+}
+
+void Connector::handleWrite() {
+    if (state_ != kConnecting) {
+        return;
+    }
+    int sockfd = removeAndResetChannel();
+
+    int optval = 0;
+    socklen_t optlen = sizeof(optval);
+    int err = ::getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &optval, &optlen) < 0 ? errno : optval;
+    if (err != 0) {
+        LOG_DEBUG("Connector::handleWrite - [%s] SO_ERROR = %d", serverAddr_.toIpPort().c_str(), err);
+        retry(sockfd);
+        return;
+    }
+
+    // 连本机时没有监听的端口可能正好被分配成本地端口，连上自己
+    sockaddr_in local;
+    sockaddr_in peer;
+    socklen_t addrLen = sizeof(local);
+    ::getsockname(sockfd, (sockaddr *)&local, &addrLen);
+    addrLen = sizeof(peer);
+    ::getpeername(sockfd, (sockaddr *)&peer, &addrLen);
+    if (local.sin_port == peer.sin_port && local.sin_addr.s_addr == peer.sin_addr.s_addr) {
+        LOG_DEBUG("Connector::handleWrite - self connect");
+        retry(sockfd);
+        return;
+    }
+
+    setState(kConnected);
+    if (connect_ && newConnectionCallback_) {
+        newConnectionCallback_(sockfd);
+    } else {
+        ::close(sockfd);
+    }
+}
+
+void Connector::handleError() {
+    if (state_ != kConnecting) {
+        return;
+    }
+    int sockfd = removeAndResetChannel();
+    LOG_DEBUG("Connector::handleError - [%s] connect failed", serverAddr_.toIpPort().c_str());
+    retry(sockfd);
+}
+
+// 关闭这次的 sockfd，retryDelayMs_ 之后重新 connect，每次翻倍
+void Connector::retry(int sockfd) {
+    if (sockfd >= 0) {
+        ::close(sockfd);
+    }
+    setState(kDisconnected);
+    if (!connect_) {
+        return;
+    }
+    LOG_INFO("Connector::retry - connecting to %s in %d ms", serverAddr_.toIpPort().c_str(), retryDelayMs_);
+    retryTimer_ = loop_->runAfter(retryDelayMs_ / 1000.0, std::bind(&Connector::startInLoop, shared_from_this()));
+    retryDelayMs_ = std::min(retryDelayMs_ * 2, maxRetryDelayMs_);
+}
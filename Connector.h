@@ -0,0 +1,67 @@
+#pragma once
+
+#include "InetAddress.h"
+#include "TimerId.h"
+#include "noncopyable.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class Channel;
+class EventLoop;
+
+/**
+ * 主动发起连接，和 Acceptor 对应: Acceptor 得到 accept 的 connfd，Connector 得到 connect 成功的 sockfd
+ * - 非阻塞 connect 返回 EINPROGRESS 之后注册 channel 的写事件，可写时用 SO_ERROR 判断连接是否成功
+ * - 失败之后按指数退避重试，kInitRetryDelayMs 开始每次翻倍，最多 kMaxRetryDelayMs
+ * - 只负责建立连接，sockfd 交给 newConnectionCallback_ 之后就不再管理，由 TcpClient 创建 TcpConnection
+ */
+class Connector : noncopyable, public std::enable_shared_from_this<Connector> {
+  public:
+    using NewConnectionCallback = std::function<void(int sockfd)>;
+
+    Connector(EventLoop *loop, const InetAddress &serverAddr);
+    ~Connector();
+
+    void setNewConnectionCallback(const NewConnectionCallback &cb) { newConnectionCallback_ = cb; }
+
+    // 重试的退避区间，必须在 start 之前设置
+    void setRetryDelay(int initMs, int maxMs);
+
+    const InetAddress &serverAddress() const { return serverAddr_; }
+
+    void start();    // 可以在任意线程调用
+    void restart();  // 只能在 loop 线程调用，连接断开之后重新连接，退避时间恢复到初始值
+    void stop();     // 可以在任意线程调用
+
+  private:
+    enum States { kDisconnected, kConnecting, kConnected };
+
+    static const int kInitRetryDelayMs = 500;
+    static const int kMaxRetryDelayMs = 30 * 1000;
+
+    void setState(States s) { state_ = s; }
+    void startInLoop();
+    void stopInLoop();
+    void connect();
+    void connecting(int sockfd);
+    void handleWrite();
+    void handleError();
+    void retry(int sockfd);
+    int removeAndResetChannel();
+    void resetChannel();
+
+    EventLoop *loop_;
+    InetAddress serverAddr_;
+    std::atomic_bool connect_;  // 用户是否希望连接，stop 之后为 false
+    std::atomic_int state_;
+    std::unique_ptr<Channel> channel_;  // 只在 connect 进行中存在
+    NewConnectionCallback newConnectionCallback_;
+    int initRetryDelayMs_;
+    int maxRetryDelayMs_;
+    int retryDelayMs_;
+    TimerId retryTimer_;
+};
+
+using ConnectorPtr = std::shared_ptr<Connector>;
@@ -0,0 +1,78 @@
+#include "CpuAffinity.h"
+
+#include <errno.h>
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <map>
+#include <utility>
+
+namespace CpuAffinity {
+
+// /sys/devices/system/cpu/cpuN/topology/ 下的一个整数，读不到返回 -1
+static int readTopology(int cpu, const char *name) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+    FILE *fp = ::fopen(path, "r");
+    if (fp == nullptr) {
+        return -1;
+    }
+    int value = -1;
+    if (::fscanf(fp, "%d", &value) != 1) {
+        value = -1;
+    }
+    ::fclose(fp);
+    return value;
+}
+
+std::vector<int> physicalCores() {
+    std::vector<int> cpus;
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (::sched_getaffinity(0, sizeof(allowed), &allowed) < 0) {
+        return cpus;
+    }
+
+    // (socket, core) => 第一个逻辑 CPU，map 按 socket、core 排好序；读不到拓扑的 CPU 当作单独的核
+    std::map<std::pair<int, int>, int> cores;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        int package = readTopology(cpu, "physical_package_id");
+        int core = readTopology(cpu, "core_id");
+        if (core < 0) {
+            core = cpu;
+        }
+        cores.insert(std::make_pair(std::make_pair(package, core), cpu));  // 已经有了就保留编号小的兄弟
+    }
+    for (auto &item : cores) {
+        cpus.push_back(item.second);
+    }
+    return cpus;
+}
+
+bool pinCurrentThread(const std::vector<int> &cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (CPU_COUNT(&set) == 0) {
+        errno = EINVAL;
+        return false;
+    }
+    return ::sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+bool useLocalMemory() {
+    // glibc 没有 set_mempolicy 的封装，不依赖 libnuma 直接走系统调用；没有 NUMA 的内核返回 ENOSYS
+    return ::syscall(SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0) == 0;
+}
+
+}  // namespace CpuAffinity
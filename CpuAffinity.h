@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * 线程的 CPU 绑定和 NUMA 内存策略，只作用于调用的线程
+ * - physicalCores: 每个物理核取一个逻辑 CPU（跳过超线程兄弟），按 socket、core 排序，只包括进程允许使用的 CPU
+ * - pinCurrentThread: sched_setaffinity 绑定到 cpus
+ * - useLocalMemory: set_mempolicy(MPOL_LOCAL)，之后这个线程分配的内存在它当前所在的 NUMA 节点上，
+ *   进程被 numactl --interleave 之类启动时也不受影响
+ */
+namespace CpuAffinity {
+
+std::vector<int> physicalCores();
+
+bool pinCurrentThread(const std::vector<int> &cpus);  // 失败返回 false，errno 保存原因
+
+bool useLocalMemory();
+
+}  // namespace CpuAffinity
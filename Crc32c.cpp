@@ -0,0 +1,100 @@
+#include "Crc32c.h"
+
+#include <string.h>
+
+#include <atomic>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define MUDUO_CRC32C_X86 1
+#endif
+
+namespace {
+
+const uint32_t kPolynomial = 0x82F63B78;  // 0x1EDC6F41 按位反转
+
+struct Table {
+    uint32_t entries[256];
+
+    Table() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (crc & 1 ? kPolynomial : 0);
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+uint32_t extendSoftware(uint32_t crc, const char *data, size_t len) {
+    static const Table table;
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc = table.entries[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+#ifdef MUDUO_CRC32C_X86
+__attribute__((target("sse4.2"))) uint32_t extendHardware(uint32_t crc, const char *data, size_t len) {
+    uint64_t crc64 = ~crc;
+    const char *end = data + len;
+    for (; end - data >= 8; data += 8) {
+        uint64_t word;
+        ::memcpy(&word, data, sizeof word);
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    uint32_t crc32 = static_cast<uint32_t>(crc64);
+    for (; data < end; ++data) {
+        crc32 = _mm_crc32_u8(crc32, static_cast<unsigned char>(*data));
+    }
+    return ~crc32;
+}
+#endif
+
+bool supportsHardware() {
+#ifdef MUDUO_CRC32C_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+#else
+    return false;
+#endif
+}
+
+using ExtendFunc = uint32_t (*)(uint32_t, const char *, size_t);
+
+ExtendFunc select(bool hardware) {
+#ifdef MUDUO_CRC32C_X86
+    if (hardware && supportsHardware()) {
+        return extendHardware;
+    }
+#endif
+    (void)hardware;
+    return extendSoftware;
+}
+
+// 和 SimdSearch 一样第一次使用时才检测 CPU，不依赖全局对象的初始化顺序
+std::atomic<ExtendFunc> g_extend(nullptr);
+
+inline ExtendFunc extendFunc() {
+    ExtendFunc func = g_extend.load(std::memory_order_relaxed);
+    if (func == nullptr) {
+        func = select(true);
+        g_extend.store(func, std::memory_order_relaxed);
+    }
+    return func;
+}
+
+}  // namespace
+
+namespace Crc32c {
+
+uint32_t extend(uint32_t crc, const char *data, size_t len) { return extendFunc()(crc, data, len); }
+
+bool hardware() { return extendFunc() != extendSoftware; }
+
+void setHardware(bool on) { g_extend.store(select(on), std::memory_order_relaxed); }
+
+}  // namespace Crc32c
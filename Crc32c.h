@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * CRC32C（Castagnoli 多项式，iSCSI / ext4 / RocksDB 用的那个），LengthHeaderCodec 的校验和
+ * - x86-64 的 CPU 支持 SSE4.2 时用 crc32 指令，一次 8 字节，否则查表，运行时选择
+ * - extend 可以分段计算：extend(extend(0, a), b) == value(a + b)
+ */
+namespace Crc32c {
+
+uint32_t extend(uint32_t crc, const char *data, size_t len);
+
+inline uint32_t value(const char *data, size_t len) { return extend(0, data, len); }
+
+bool hardware();  // 是否使用 SSE4.2 的 crc32 指令
+// 强制使用查表的实现（性能测试对比），不是线程安全的，在使用之前设置
+void setHardware(bool on);
+
+}  // namespace Crc32c
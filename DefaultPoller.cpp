@@ -1,12 +1,31 @@
+#define MUDUO_LOG_MODULE kLogModuleLoop
+
 #include "EPollPoller.h"
+#include "EventLoop.h"
+#include "IoUringPoller.h"
+#include "Logger.h"
 #include "Poller.h"
 
 #include <stdlib.h>
 
-Poller *Poller::newDefaultPoller(EventLoop *loop) {
+#include <memory>
+
+Poller *Poller::newDefaultPoller(EventLoop *loop, int type) {
+    if (type == EventLoop::kDefaultPoller) {
+        type = ::getenv("MUDUO_USE_IO_URING") ? EventLoop::kIoUringPoller : EventLoop::kEPollPoller;
+    }
     if (::getenv("MUDUO_USE_POLL")) {
-        return nullptr;  // 生成 poller 实例，这里先不考虑 poll
-    } else {
-        return new EPollPoller(loop);  // 生成 epoller 实例
+        // 没有 poll(2) 的实现，以前这里返回 nullptr 会让 EventLoop 崩溃
+        LOG_ERROR("Poller::newDefaultPoller - MUDUO_USE_POLL is not supported, using epoll");
+        type = EventLoop::kEPollPoller;
+    }
+
+    if (type == EventLoop::kIoUringPoller) {
+        std::unique_ptr<IoUringPoller> poller(new IoUringPoller(loop));
+        if (poller->valid()) {
+            return poller.release();
+        }
+        LOG_ERROR("Poller::newDefaultPoller - io_uring unavailable (errno %d), using epoll", poller->setupErrno());
     }
+    return new EPollPoller(loop);  // 生成 epoller 实例
 }
@@ -1,3 +1,5 @@
+#define MUDUO_LOG_MODULE kLogModuleLoop
+
 #include "EPollPoller.h"
 
 #include "Channel.h"
@@ -24,24 +26,20 @@ EPollPoller::EPollPoller(EventLoop *loop)
 EPollPoller::~EPollPoller() { ::close(epollfd_); }
 
 // 实际就是 epoll_wait 等待感兴趣的事件，并且通过 fillActiveChannels 告知 EventLoop 活跃的 channels
+//!NOTE: poll / updateChannel / removeChannel 在每次读写事件切换时都会调用，只在出错时打日志
 Timestamp EPollPoller::poll(int timeoutMs, ChannelList *activeChannels) {
-    //!TODO: poll 调用时非常频繁的，使用 LOG_DEBUG 更合适
-    LOG_DEBUG("EPollPoller::poll - fd total count: %lu", activeChannels->size());
-
+    ++numPolls_;
     int numEvents = ::epoll_wait(epollfd_, &(*events_.begin()), static_cast<int>(events_.size()), timeoutMs);
     int savedErrno = errno;  // 防止多线程改变 errno
     Timestamp now(Timestamp::now());
 
     if (numEvents > 0) {  // 监听到事件
-        LOG_INFO("EPollPoller::poll - %d events happened", numEvents);
         fillActiveChannels(numEvents, activeChannels);
 
         if (numEvents == events_.size()) {  // vector EventList 所有，需要扩容
             events_.resize(events_.size() * 2);
         }
-    } else if (numEvents == 0) {  // 超时
-        LOG_DEBUG("EPollPoller::poll - %dms timeout!", timeoutMs);
-    } else {  // 错误
+    } else if (numEvents < 0) {  // 错误，0 是超时
         if (savedErrno != EINTR) { // 外部中断还需要继续处理
             errno = savedErrno;
             LOG_ERROR("EPollPoller::poll err! errno=%d", errno);
@@ -67,40 +65,39 @@ void EPollPoller::fillActiveChannels(int numEvents, ChannelList *activeChannels)
  *
  *           EventLoop
  *  ChannelList     Poller
- *                  ChannelMap <fd, channel*>
+ *                  ChannelTable [fd] => channel*
  */
 void EPollPoller::updateChannel(Channel *channel) {
     const int index = channel->index();
-    LOG_INFO("EPollPoller::updateChannel - fd = %d, events = %d, index = %d", channel->fd(), channel->events(), index);
+    checkChannel(channel, index != kNew);  // kDeleted 的 channel 只是不在 epoll 里，仍然在 channels_ 中
 
     // 理解 kNew, kAdded, kDeleted 之间的逻辑
     if (index == kNew || index == kDeleted) {
         if (index == kNew) {
-            int fd = channel->fd();
-            channels_[fd] = channel;
+            addChannel(channel);
         }
 
         channel->set_index(kAdded);
         update(EPOLL_CTL_ADD, channel);
     } else {  // channel 已经在 poller 上注册过了
-        int fd = channel->fd();
         if (channel->isNoneEvent()) {  // 注册过但是不关心了需要删除
             update(EPOLL_CTL_DEL, channel);
             channel->set_index(kDeleted);
-        } else {  // 已经注册并需要修改的情况
+        } else if (channel->pollEvents() != channel->registeredEvents()) {  // 已经注册并需要修改的情况
             update(EPOLL_CTL_MOD, channel);
         }
+        // 注册的事件没有变化（例如 ET 模式下 enableWriting / disableWriting）不需要 epoll_ctl
     }
 }
 
 // 从 Poller 中删除 channel
 void EPollPoller::removeChannel(Channel *channel) {
-    int fd = channel->fd();
-    channels_.erase(fd);
-
-    LOG_INFO("EPollPoller::removeChannel - fd = %d", fd);
-
     int index = channel->index(); // 获取 channel 的状态
+    if (index != kNew) {
+        checkChannel(channel, true);
+    }
+    eraseChannel(channel);
+
     if (index == kAdded) {
         update(EPOLL_CTL_DEL, channel);
     }
@@ -115,10 +112,12 @@ void EPollPoller::update(int operation, Channel *channel) {
     epoll_event event;
     bzero(&event, sizeof(event));
 
-    event.events = channel->events();
+    event.events = channel->pollEvents();
     event.data.fd = fd;
     event.data.ptr = channel;  // event.data 是联合体，注意这里 ptr 是 void* 类型，之间通常使用的是 fd
 
+    ++numUpdates_;
+    channel->set_registeredEvents(operation == EPOLL_CTL_DEL ? 0 : event.events);
     if (::epoll_ctl(epollfd_, operation, fd, &event) < 0) {
         if (operation == EPOLL_CTL_DEL) {
             LOG_ERROR("EPollPoller::update - epoll_ctl del error: %d", errno);
@@ -1,12 +1,18 @@
+#define MUDUO_LOG_MODULE kLogModuleLoop
+
 #include "EventLoop.h"
 
 #include "Channel.h"
+#include "IoUringPoller.h"
 #include "Logger.h"
 #include "Poller.h"
+#include "TimerQueue.h"
 
 #include <errno.h>
 #include <sys/eventfd.h>
 
+#include <algorithm>
+
 // 防止一个线程创建多个 EventLoop，thread_local 机制
 __thread EventLoop *t_loopInThisThread = nullptr;
 
@@ -22,14 +28,28 @@ int createEventfd() {
     return evtfd;
 }
 
-EventLoop::EventLoop()
+EventLoop::EventLoop(PollerType pollerType)
     : looping_(false)
     , quit_(false)
     , callingPendingFunctors_(false)
     , threadId_(CurrentThread::tid())
-    , poller_(Poller::newDefaultPoller(this))
+    , poller_(Poller::newDefaultPoller(this, pollerType))
+    , timerQueue_(new TimerQueue(this))
     , wakeupFd_(createEventfd())
     , wakeupChannel_(new Channel(this, wakeupFd_))
+    , functorPool_(kFunctorPoolSize)
+    , hasMorePendingFunctors_(false)
+    , wakeupPending_(false)
+    , numConnections_(0)
+    , queuedBytes_(0)
+    , busyPermille_(0)
+    , windowStartUs_(Timestamp::now().microSecondsSinceEpoch())
+    , windowBusyUs_(0)
+    , busyPollUs_(0)
+    , socketBusyPollUs_(0)
+    , spinning_(false)
+    , busyPollStats_()
+    , skippedWakeups_(0)
 // , currentActivateChannels_(nullptr)
 {
     LOG_DEBUG("EventLoop::EventLoop() - created %p in thread %d", this, threadId_);
@@ -44,10 +64,17 @@ EventLoop::EventLoop()
     wakeupChannel_->setReadCallback(std::bind(&EventLoop::handleRead, this));
 
     // 每一个 eventloop 都将监听 wakeupchannel 的 EPOLLIN 读事件了
+    // 一次 read 就会把 eventfd 的计数清零，可以边缘触发；io_uring 下是 multishot，每次唤醒不需要重新提交
+    wakeupChannel_->setEdgeTriggered(true);
     wakeupChannel_->enableReading();
 }
 
 EventLoop::~EventLoop() {
+    // 没有执行的回调直接丢弃，和原来的 vector 析构一样
+    while (FunctorNode *node = pendingFunctors_.pop()) {
+        node->functor.reset();
+        functorPool_.free(node);
+    }
     wakeupChannel_->disableAll();
     wakeupChannel_->remove();
     ::close(wakeupFd_);
@@ -66,13 +93,24 @@ void EventLoop::loop() {
         activateChannels_.clear();
 
         // 监听两类 fd，一种是 client 的 fd，一种是 wakeupfd
-        pollReturnTime_ = poller_->poll(kPollTimeMs, &activateChannels_);
+        // 还有没执行完的回调或者 ET 模式下没有读完 / 写完的 channel，poll 不阻塞
+        bool busy = hasMorePendingFunctors_ || !readyChannels_.empty();
+        if (!busy && busyPollUs_ > 0) {
+            pollReturnTime_ = busyPoll();
+        } else {
+            pollReturnTime_ = poller_->poll(busy ? 0 : kPollTimeMs, &activateChannels_);
+        }
+
+        // 这一次迭代之前 keepReady 的 channel，处理过程中再 keepReady 的留到下一次迭代，避免一个连接占住 loop
+        processingChannels_.swap(readyChannels_);
 
         for (Channel *channel : activateChannels_) {
             // poller 监听哪些 channel 发生事件了，然后上报给 EventLoop，通知 channel 处理相应的事件
             channel->handleEvent(pollReturnTime_);
         }
 
+        doReadyChannels();
+
         // 执行当前 EventLoop 事件循环需要处理的回调操作
         /**
          * IO 线程 mainLoop accept fd <==  channel subloop
@@ -80,6 +118,8 @@ void EventLoop::loop() {
          * 执行之前 mainLoop 注册的 cb
          */
         doPendingFunctors();
+
+        updateBusyRatio();
     }
 
     LOG_INFO("EventLoop::loop() - %p stop looping.", this);
@@ -110,16 +150,16 @@ void EventLoop::runInLoop(Functor cb) {
     if (isInLoopThread()) {  // 在当前的 loop 线程中执行 cb
         cb();
     } else {  // 在非当前 loop 线程中执行 cb，就需要唤醒 loop 所在线程，执行 cb
-        queueInLoop(cb);
+        queueInLoop(std::move(cb));
     }
 }
 
 // 把 cb 放入队列中，唤醒 loop 所在的线程，执行 cb
 void EventLoop::queueInLoop(Functor cb) {
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        pendingFunctors_.emplace_back(cb);
-    }
+    // 不拷贝 cb 里绑定的参数，也不加锁，节点从池子里分配
+    FunctorNode *node = functorPool_.alloc();
+    node->functor = std::move(cb);
+    pendingFunctors_.push(node);
 
     // 唤醒相应的，需要执行上面回调操作的 loop 的线程了
     //!NOTE: callingPendingFunctors_ 当前 loop 正在执行回调，但是 loop 又有了新的回调，因此还需要唤醒 poller 以便再次执行
@@ -128,8 +168,20 @@ void EventLoop::queueInLoop(Functor cb) {
     }
 }
 
-// 用来唤醒 loop 所在的线程，向 wakeupFd_ 写一个数据，wakeupChannel 就发生读事件，当前 loop 线程就会被唤醒
+/**
+ * 用来唤醒 loop 所在的线程，向 wakeupFd_ 写一个数据，wakeupChannel 就发生读事件，当前 loop 线程就会被唤醒
+ *!NOTE: wakeupPending_ 保证 loop 处理 wakeupFd_ 之前只有第一个生产者会 write，其他生产者直接返回
+ */
 void EventLoop::wakeup() {
+    // 和 busyPoll 里的 fence 配对: 要么这里看到 spinning_ 为 false 去写 eventfd，要么 loop 阻塞之前看到新的回调
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (spinning_.load(std::memory_order_relaxed)) {
+        skippedWakeups_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (wakeupPending_.exchange(true, std::memory_order_acq_rel)) {
+        return;  // eventfd 已经可读了，loop 一定会醒来执行 doPendingFunctors
+    }
     uint64_t one = 1;
     ssize_t n = write(wakeupFd_, &one, sizeof(one));
     if (n != sizeof(one)) {
@@ -137,14 +189,127 @@ void EventLoop::wakeup() {
     }
 }
 
+TimerId EventLoop::runAt(Timestamp time, TimerCallback cb) { return timerQueue_->addTimer(std::move(cb), time, 0.0); }
+
+TimerId EventLoop::runAfter(double delay, TimerCallback cb) {
+    Timestamp time(addTime(Timestamp::now(), delay));
+    return runAt(time, std::move(cb));
+}
+
+TimerId EventLoop::runEvery(double interval, TimerCallback cb) {
+    Timestamp time(addTime(Timestamp::now(), interval));
+    return timerQueue_->addTimer(std::move(cb), time, interval);
+}
+
+void EventLoop::cancel(TimerId timerId) { timerQueue_->cancel(timerId); }
+
+/**
+ * poll 返回之后到这里都是在处理事件，每次迭代多一次取时间
+ *!NOTE: loop 阻塞在 poll 里的时候 busyPermille_ 保持上一个窗口的值，醒来之后的窗口包括阻塞的时间，会变得很小
+ */
+void EventLoop::updateBusyRatio() {
+    int64_t now = Timestamp::now().microSecondsSinceEpoch();
+    windowBusyUs_ += now - pollReturnTime_.microSecondsSinceEpoch();
+    int64_t elapsed = now - windowStartUs_;
+    if (elapsed >= kLoadWindowUs) {
+        busyPermille_.store(static_cast<int>(std::min<int64_t>(windowBusyUs_ * 1000 / elapsed, 1000)),
+                            std::memory_order_relaxed);
+        windowStartUs_ = now;
+        windowBusyUs_ = 0;
+    }
+}
+
+void EventLoop::setBusyPoll(int64_t budgetUs, int socketBusyPollUs) {
+    busyPollUs_ = budgetUs > 0 ? budgetUs : 0;
+    socketBusyPollUs_ = socketBusyPollUs > 0 ? socketBusyPollUs : 0;
+}
+
+/**
+ * poll(0) 返回的时间就是当前时间，自旋不需要额外取时间
+ *!NOTE: 预算用完之后先清掉 spinning_ 再检查一次队列，期间 queueInLoop 的生产者可能看到 spinning_ 跳过了 eventfd
+ */
+Timestamp EventLoop::busyPoll() {
+    spinning_.store(true, std::memory_order_relaxed);
+    Timestamp now = poller_->poll(0, &activateChannels_);
+    int64_t deadline = now.microSecondsSinceEpoch() + busyPollUs_;
+    while (activateChannels_.empty() && pendingFunctors_.empty() && !quit_) {
+        if (now.microSecondsSinceEpoch() >= deadline) {
+            spinning_.store(false, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!pendingFunctors_.empty() || quit_) {
+                break;
+            }
+            ++busyPollStats_.sleeps;
+            return poller_->poll(kPollTimeMs, &activateChannels_);
+        }
+        ++busyPollStats_.spinPolls;
+        now = poller_->poll(0, &activateChannels_);
+    }
+    spinning_.store(false, std::memory_order_relaxed);
+    ++busyPollStats_.spinWakeups;
+    return now;
+}
+
+EventLoop::BusyPollStats EventLoop::busyPollStats() const {
+    BusyPollStats stats = busyPollStats_;
+    stats.skippedWakeups = skippedWakeups_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+EventLoop::Load EventLoop::load() const {
+    Load load;
+    load.connections = numConnections_.load(std::memory_order_relaxed);
+    load.queuedBytes = queuedBytes_.load(std::memory_order_relaxed);
+    load.busyRatio = busyPermille_.load(std::memory_order_relaxed) / 1000.0;
+    return load;
+}
+
 // 调用 poller->updateChannel
 void EventLoop::updateChannel(Channel *channel) { poller_->updateChannel(channel); }
 
 // 调用 poller->removeChannel
-void EventLoop::removeChannel(Channel *channel) { poller_->removeChannel(channel); }
+void EventLoop::removeChannel(Channel *channel) {
+    // channel 马上就要析构了，不能留在 ready 列表里
+    if (channel->readyEvents() != 0) {
+        channel->set_readyEvents(0);
+        std::replace(readyChannels_.begin(), readyChannels_.end(), channel, static_cast<Channel *>(nullptr));
+        std::replace(processingChannels_.begin(), processingChannels_.end(), channel, static_cast<Channel *>(nullptr));
+    }
+    poller_->removeChannel(channel);
+}
 
 // 调用 poller->hasChannel
-void EventLoop::hasChannel(Channel *channel) { poller_->hasChannel(channel); }
+bool EventLoop::hasChannel(Channel *channel) { return poller_->hasChannel(channel); }
+
+void EventLoop::queueReadyChannel(Channel *channel) { readyChannels_.push_back(channel); }
+
+uint64_t EventLoop::pollCount() const { return poller_->numPolls(); }
+
+uint64_t EventLoop::pollerUpdateCount() const { return poller_->numUpdates(); }
+
+uint64_t EventLoop::pollerSyscallCount() const { return poller_->numSyscalls(); }
+
+IoUringPoller *EventLoop::ioUringPoller() const { return dynamic_cast<IoUringPoller *>(poller_.get()); }
+
+/**
+ * 处理 ET 模式下上一次没有处理完的 channel，以 keepReady 记录的事件再调用一次 handleEvent
+ *!NOTE: 回调里可能关闭其他连接（removeChannel 置空），已经 disableAll 的 channel 不再处理
+ */
+void EventLoop::doReadyChannels() {
+    for (size_t i = 0; i < processingChannels_.size(); ++i) {
+        Channel *channel = processingChannels_[i];
+        if (channel == nullptr) {
+            continue;
+        }
+        int revents = channel->readyEvents() & channel->events();
+        channel->set_readyEvents(0);
+        if (revents != 0) {
+            channel->set_revents(revents);
+            channel->handleEvent(pollReturnTime_);
+        }
+    }
+    processingChannels_.clear();
+}
 
 void EventLoop::handleRead() {
     uint64_t one = 1;
@@ -152,21 +317,29 @@ void EventLoop::handleRead() {
     if (n != sizeof(one)) {
         LOG_ERROR("EventLoop::handleRead() - reads %ld bytes instead of 8", n);
     }
+    //!NOTE: 先读 eventfd 再清除标志。反过来的话，清除和 read 之间的 write 会被这次 read 读走，
+    // 标志却还是 true，之后的生产者都不再 write，回调要等到 poll 超时才执行；
+    // 这个顺序下 read 和清除之间跳过 write 的生产者，回调已经入队了，handleRead 之后的 doPendingFunctors 会执行
+    wakeupPending_.store(false, std::memory_order_release);
 }
 
-// 执行回调
+/**
+ * 执行回调
+ *!NOTE: 每次最多执行 kMaxPendingFunctors 个，生产者太快时剩下的留到下一次迭代，
+ * 下一次 poll 的超时时间为 0，先处理已经就绪的 IO 再继续执行回调
+ */
 void EventLoop::doPendingFunctors() {
-    std::vector<Functor> functors;
     callingPendingFunctors_ = true;
 
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        functors.swap(pendingFunctors_);  // 解放 pendingFunctors_，减少时延
-    }
-
-    for (const Functor &functor : functors) {
-        functor();  // 执行当前 loop 需要执行的回调操作
+    int n = 0;
+    FunctorNode *node = nullptr;
+    while (n < kMaxPendingFunctors && (node = pendingFunctors_.pop()) != nullptr) {
+        node->functor();  // 执行当前 loop 需要执行的回调操作
+        node->functor.reset();
+        functorPool_.free(node);
+        ++n;
     }
+    hasMorePendingFunctors_ = (n == kMaxPendingFunctors && !pendingFunctors_.empty());
 
     callingPendingFunctors_ = false;
-}
\ No newline at end of file
+}
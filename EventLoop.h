@@ -1,6 +1,11 @@
 #pragma once
 
+#include "Callbacks.h"
 #include "CurrentThread.h"
+#include "LockFreePool.h"
+#include "MpscQueue.h"
+#include "Task.h"
+#include "TimerId.h"
 #include "Timestamp.h"
 #include "noncopyable.h"
 
@@ -11,14 +16,20 @@
 #include <vector>
 
 class Channel;  // 前置声明
+class IoUringPoller;
 class Poller;
+class TimerQueue;
 
 /* 事件循环类，主要包含两大模块 Channel + Poller（epoll 的抽象） */
 class EventLoop : noncopyable {
   public:
-    using Functor = std::function<void()>;
+    using Functor = Task;  // 只能移动，库里的调用点都不需要堆分配
 
-    EventLoop();
+    // IO 复用的实现，kDefaultPoller 时设置了环境变量 MUDUO_USE_IO_URING 就使用 io_uring，否则使用 epoll
+    // io_uring 不可用时退回 epoll
+    enum PollerType { kDefaultPoller, kEPollPoller, kIoUringPoller };
+
+    explicit EventLoop(PollerType pollerType = kDefaultPoller);
     ~EventLoop();
 
     void loop();  // 开启事件循环
@@ -31,17 +42,75 @@ class EventLoop : noncopyable {
 
     void wakeup();  // 用来唤醒 loop 所在的线程
 
+    // 定时器，可以跨线程调用
+    TimerId runAt(Timestamp time, TimerCallback cb);      // 在 time 时刻执行 cb
+    TimerId runAfter(double delay, TimerCallback cb);     // delay 秒之后执行 cb
+    TimerId runEvery(double interval, TimerCallback cb);  // 每隔 interval 秒执行一次 cb
+    void cancel(TimerId timerId);
+
     // EventLoop 调用 Poller 方法，实际上是 channel 想要调用
     void updateChannel(Channel *channel);
     void removeChannel(Channel *channel);
-    void hasChannel(Channel *channel);
+    bool hasChannel(Channel *channel);
+
+    // ET 模式下还没有处理完的 channel，下一次 loop 迭代直接处理，poll 不阻塞，由 Channel::keepReady 调用
+    void queueReadyChannel(Channel *channel);
+
+    // poller 的统计，只能在 loop 线程调用
+    uint64_t pollCount() const;
+    uint64_t pollerUpdateCount() const;
+    uint64_t pollerSyscallCount() const;
+
+    /**
+     * 忙轮询: 没有事件时先用 poll(0) 自旋 budgetUs 微秒，同时检查 pendingFunctors_，都没有再阻塞在 poll 里
+     * 自旋期间其他线程 queueInLoop 不写 eventfd，loop 也不用经过 futex 唤醒和调度，换来的是自旋时占满一个 CPU
+     * socketBusyPollUs > 0 时这个 loop 上新建立的连接设置 SO_BUSY_POLL
+     * budgetUs <= 0 关闭，只能在 loop 线程或者 loop() 之前调用
+     */
+    void setBusyPoll(int64_t budgetUs, int socketBusyPollUs = 0);
+    int socketBusyPollUs() const { return socketBusyPollUs_; }
+
+    // 忙轮询的统计，只能在 loop 线程读取
+    struct BusyPollStats {
+        uint64_t spinPolls;       // 自旋时 poll(0) 的次数
+        uint64_t spinWakeups;     // 自旋期间等到了事件或者回调
+        uint64_t sleeps;          // 自旋超过预算，阻塞在 poll 里
+        uint64_t skippedWakeups;  // 因为 loop 在自旋，queueInLoop 省掉的 eventfd 写
+    };
+    BusyPollStats busyPollStats() const;
+
+    // 负载统计，loop 线程（TcpConnection）更新，任意线程读取，EventLoopThreadPool 的 LoopSelector 据此选择 loop
+    struct Load {
+        int connections;      // 已经建立的连接数
+        int64_t queuedBytes;  // 所有连接 outputBuffer_ 里还没有发出去的字节数
+        double busyRatio;     // 最近一个统计窗口里处理事件（不包括阻塞在 poll）的时间占比
+    };
+    Load load() const;
+    void addConnections(int delta) { numConnections_.fetch_add(delta, std::memory_order_relaxed); }
+    void addQueuedBytes(int64_t delta) { queuedBytes_.fetch_add(delta, std::memory_order_relaxed); }
+
+    // poller 是 io_uring 时返回它（完成模式的 IO 使用），否则返回 nullptr
+    IoUringPoller *ioUringPoller() const;
 
     // 判断 EventLoop 对象是否在自己的线程里面
     bool isInLoopThread() { return threadId_ == CurrentThread::tid(); }
 
   private:
     void handleRead();         // 处理 wakeup
-    void doPendingFunctors();  // 执行回调
+    void doPendingFunctors();  // 执行回调，每次最多 kMaxPendingFunctors 个
+    void doReadyChannels();    // 处理 readyChannels_
+    void updateBusyRatio();    // 累计这一次迭代的处理时间，窗口结束时更新 busyPermille_
+    Timestamp busyPoll();      // 自旋 busyPollUs_ 微秒，没有事件再阻塞
+
+    // pendingFunctors_ 的节点，从 functorPool_ 分配
+    struct FunctorNode {
+        std::atomic<FunctorNode *> next_;
+        Functor functor;
+    };
+
+    static const int kMaxPendingFunctors = 1024;  // 一次 loop 迭代最多执行的回调数量，避免饿死 IO
+    static const uint32_t kFunctorPoolSize = 1024;  // 超过之后的节点在堆上分配
+    static const int64_t kLoadWindowUs = 100 * 1000;  // busyRatio 的统计窗口
 
     using ChannelList = std::vector<Channel *>;
 
@@ -51,6 +120,7 @@ class EventLoop : noncopyable {
     const pid_t threadId_;      // 记录当前 loop 的线程 id
     Timestamp pollReturnTime_;  // poller 返回发生事件的 channels 的时间点
     std::unique_ptr<Poller> poller_;
+    std::unique_ptr<TimerQueue> timerQueue_;  // 依赖 poller_，声明顺序不能换
 
     //!NOTE: 理解 eventfd()
     //!NOTE: 主要作用，当 mainLoop 获取一个新用户的 channel，通过轮询算法选择一个 subloop，通过该成员唤醒subloop 处理 channel
@@ -59,9 +129,25 @@ class EventLoop : noncopyable {
     std::unique_ptr<Channel> wakeupChannel_;
 
     ChannelList activateChannels_;
+    ChannelList readyChannels_;       // Channel::keepReady 加入，下一次迭代处理
+    ChannelList processingChannels_;  // 正在处理的 readyChannels_，removeChannel 时置空
     // Channel *currentActivateChannels_; // assert
 
-    std::atomic_bool callingPendingFunctors_;  // 表示当前 loop 是否有需要执行的回调操作
-    std::vector<Functor> pendingFunctors_;     // 存储 loop 需要执行的所有回调操作
-    std::mutex mutex_;                         // 互斥锁，用来保护上面 vector 容器的线程安全操作
+    std::atomic_bool callingPendingFunctors_;   // 表示当前 loop 是否有需要执行的回调操作
+    LockFreePool<FunctorNode> functorPool_;     // pendingFunctors_ 的节点池，queueInLoop 不分配内存
+    MpscQueue<FunctorNode> pendingFunctors_;    // 存储 loop 需要执行的所有回调操作，无锁多生产者单消费者
+    bool hasMorePendingFunctors_;               // 上一次没有执行完，下一次 poll 不阻塞
+    std::atomic_bool wakeupPending_;            // 已经 write 过 wakeupFd_ 还没有被 loop 读走
+
+    std::atomic_int numConnections_;
+    std::atomic<int64_t> queuedBytes_;
+    std::atomic_int busyPermille_;  // 最近一个窗口的 busyRatio * 1000
+    int64_t windowStartUs_;         // 下面两个只在 loop 线程访问
+    int64_t windowBusyUs_;
+
+    int64_t busyPollUs_;
+    int socketBusyPollUs_;
+    std::atomic_bool spinning_;  // loop 正在 busyPoll 自旋，wakeup 不需要写 eventfd
+    BusyPollStats busyPollStats_;
+    std::atomic<uint64_t> skippedWakeups_;
 };
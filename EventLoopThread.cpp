@@ -1,12 +1,15 @@
 #include "EventLoopThread.h"
 
-EventLoopThread::EventLoopThread(const ThreadInitCallback &cb, const std::string &name)
+EventLoopThread::EventLoopThread(const ThreadInitCallback &cb,
+                                 const std::string &name,
+                                 EventLoop::PollerType pollerType)
     : loop_(nullptr)
     , exiting_(false)
     , thread_(std::bind(&EventLoopThread::threadFunc, this), name)
     , mutex_() // 默认构造
     , cond_()
-    , callback_(cb) {}
+    , callback_(cb)
+    , pollerType_(pollerType) {}
 
 EventLoopThread::~EventLoopThread() {
     exiting_ = true;
@@ -33,7 +36,7 @@ EventLoop *EventLoopThread::startLoop() {
 // 下面这个方法在单独的新线程里面运行
 void EventLoopThread::threadFunc() {
     // 创建一个独立的 EventLoop，和上面的线程是一一对应的，one loop per thread
-    EventLoop loop;
+    EventLoop loop(pollerType_);
 
     if (callback_) {
         callback_(&loop);
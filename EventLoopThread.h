@@ -13,9 +13,13 @@ class EventLoopThread {
     using ThreadInitCallback = std::function<void(EventLoop *)>;
 
     explicit EventLoopThread(const ThreadInitCallback &cb = ThreadInitCallback(),
-                             const std::string &name = std::string());
+                             const std::string &name = std::string(),
+                             EventLoop::PollerType pollerType = EventLoop::kDefaultPoller);
     ~EventLoopThread();
 
+    // 参考 Thread::setCpuAffinity，必须在 startLoop 之前设置
+    void setCpuAffinity(const std::vector<int> &cpus, bool localMemory) { thread_.setCpuAffinity(cpus, localMemory); }
+
     EventLoop *startLoop();
 
   private:
@@ -27,4 +31,5 @@ class EventLoopThread {
     std::mutex mutex_;
     std::condition_variable cond_;
     ThreadInitCallback callback_;
+    EventLoop::PollerType pollerType_;
 };
@@ -1,12 +1,17 @@
 #include "EventLoopThreadPool.h"
+#include "CpuAffinity.h"
+#include "EventLoop.h"
 #include "EventLoopThread.h"
+#include "Logger.h"
 
 EventLoopThreadPool::EventLoopThreadPool(EventLoop *baseLoop, const std::string &nameArg)
     : baseLoop_(baseLoop)
     , name_(nameArg)
     , started_(false)
     , numThreads_(0)
-    , next_(0) {}
+    , next_(0)
+    , pollerType_(0)
+    , cpuPerPhysicalCore_(false) {}
 
 EventLoopThreadPool::~EventLoopThreadPool() {
     // EventLoop 都是 stack 上的，不需要手动释放
@@ -16,12 +21,27 @@ EventLoopThreadPool::~EventLoopThreadPool() {
 void EventLoopThreadPool::start(const ThreadInitCallback &cb) {
     started_ = true;
 
+    if (cpuPerPhysicalCore_) {
+        cpuSets_.clear();
+        for (int cpu : CpuAffinity::physicalCores()) {
+            cpuSets_.push_back(std::vector<int>(1, cpu));
+        }
+        if (static_cast<size_t>(numThreads_) > cpuSets_.size()) {
+            LOG_INFO("EventLoopThreadPool::start - %d loops on %zu physical cores, some cores run more than one loop",
+                     numThreads_,
+                     cpuSets_.size());
+        }
+    }
+
     for (int i = 0; i < numThreads_; ++i) {
         char buf[name_.size() + 32];
         snprintf(buf, sizeof(buf), "%s%d", name_.c_str(), i);
 
-        EventLoopThread *t = new EventLoopThread(cb, buf);
+        EventLoopThread *t = new EventLoopThread(cb, buf, static_cast<EventLoop::PollerType>(pollerType_));
         threads_.push_back(std::unique_ptr<EventLoopThread>(t));
+        if (!cpuSets_.empty()) {
+            t->setCpuAffinity(cpuSets_[i % cpuSets_.size()], true);
+        }
 
         loops_.push_back(t->startLoop());  // 底层创建线程，绑定一个新的 EventLoop，并返回该 loop 的地址
     }
@@ -48,6 +68,13 @@ EventLoop *EventLoopThreadPool::getNextLoop() {
     return loop;
 }
 
+EventLoop *EventLoopThreadPool::getNextLoop(const InetAddress &peerAddr) {
+    if (loops_.empty() || !selector_) {
+        return getNextLoop();
+    }
+    return selector_->select(loops_, peerAddr);
+}
+
 std::vector<EventLoop *> EventLoopThreadPool::getAllLoops() {
     if (loops_.empty()) {
         return std::vector<EventLoop *>(1, baseLoop_);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "LoopSelector.h"
 #include "noncopyable.h"
 
 #include <functional>
@@ -9,6 +10,7 @@
 
 class EventLoop;
 class EventLoopThread;
+class InetAddress;
 
 class EventLoopThreadPool {
   public:
@@ -18,11 +20,27 @@ class EventLoopThreadPool {
     ~EventLoopThreadPool();
 
     void setThreadNum(int numThreads) { numThreads_ = numThreads; } // 设置线程池线程数量
+    // subLoop 使用的 IO 复用实现（EventLoop::PollerType），必须在 start 之前设置
+    void setPollerType(int pollerType) { pollerType_ = pollerType; }
+
+    /**
+     * subLoop 的 CPU 放置，必须在 start 之前设置，线程在构造 EventLoop 之前绑定，并且使用 MPOL_LOCAL 分配内存
+     * - setCpuAffinity: 第 i 个 subLoop 绑定到 cpuSets[i % cpuSets.size()]
+     * - setCpuAffinityPerPhysicalCore: 每个物理核一个 subLoop（CpuAffinity::physicalCores），subLoop 比核多时从头复用
+     */
+    void setCpuAffinity(const std::vector<std::vector<int>> &cpuSets) { cpuSets_ = cpuSets; }
+    void setCpuAffinityPerPhysicalCore() { cpuPerPhysicalCore_ = true; }
 
     void start(const ThreadInitCallback &cb = ThreadInitCallback());
 
+    // 新连接选择 subLoop 的策略，必须在 start 之前设置，默认轮询
+    void setLoopSelector(std::unique_ptr<LoopSelector> selector) { selector_ = std::move(selector); }
+    void setLoopSelectPolicy(LoopSelector::Policy policy) { selector_.reset(LoopSelector::newSelector(policy)); }
+
     // 如果工作在多线程中，baseLoop_ 默认以轮询的方式分配 channel 给 subloop
     EventLoop *getNextLoop();
+    // 按 selector_ 给 peerAddr 的新连接选择 subLoop，没有 subLoop 时返回 baseLoop_
+    EventLoop *getNextLoop(const InetAddress &peerAddr);
 
     std::vector<EventLoop *> getAllLoops();
 
@@ -35,6 +53,10 @@ class EventLoopThreadPool {
     bool started_;
     int numThreads_;
     int next_; // 轮询下标
+    int pollerType_;
     std::vector<std::unique_ptr<EventLoopThread>> threads_;
     std::vector<EventLoop *> loops_;
+    std::unique_ptr<LoopSelector> selector_;
+    std::vector<std::vector<int>> cpuSets_;
+    bool cpuPerPhysicalCore_;
 };
@@ -0,0 +1,81 @@
+#define MUDUO_LOG_MODULE kLogModuleTcp
+
+#include "FileCache.h"
+
+#include "Logger.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+CachedFile::~CachedFile() { ::close(fd_); }
+
+CachedFilePtr FileCache::open(const std::string &path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = files_.find(path);
+        if (it != files_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);  // 移到头部
+            return it->second->second;
+        }
+    }
+
+    // open / fstat 不持锁；errno 是返回给调用者的失败原因，LOG_ERROR 之后要恢复
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        int savedErrno = errno;
+        LOG_ERROR("FileCache::open - open %s failed, errno = %d", path.c_str(), savedErrno);
+        errno = savedErrno;
+        return CachedFilePtr();
+    }
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+        int savedErrno = errno;
+        ::close(fd);
+        LOG_ERROR("FileCache::open - fstat %s failed, errno = %d", path.c_str(), savedErrno);
+        errno = savedErrno;
+        return CachedFilePtr();
+    }
+    if (!S_ISREG(st.st_mode)) {
+        ::close(fd);
+        LOG_ERROR("FileCache::open - %s is not a regular file", path.c_str());
+        errno = EINVAL;
+        return CachedFilePtr();
+    }
+    CachedFilePtr file = std::make_shared<const CachedFile>(fd, static_cast<size_t>(st.st_size));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(path);
+    if (it != files_.end()) {  // 其他线程同时打开了同一个文件，用先放进来的那个
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->second;
+    }
+    lru_.push_front(std::make_pair(path, file));
+    files_[path] = lru_.begin();
+    while (lru_.size() > capacity_) {
+        files_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+    return file;
+}
+
+void FileCache::invalidate(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(path);
+    if (it != files_.end()) {
+        lru_.erase(it->second);
+        files_.erase(it);
+    }
+}
+
+void FileCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_.clear();
+    lru_.clear();
+}
+
+size_t FileCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "noncopyable.h"
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// 一个打开的只读文件，析构时 close，TcpConnection::sendFile 发送期间持有它的引用
+class CachedFile : noncopyable {
+  public:
+    CachedFile(int fd, size_t size) : fd_(fd), size_(size) {}
+    ~CachedFile();
+
+    int fd() const { return fd_; }
+    size_t size() const { return size_; }
+
+  private:
+    const int fd_;
+    const size_t size_;
+};
+
+using CachedFilePtr = std::shared_ptr<const CachedFile>;
+
+/**
+ * 热点文件的 fd 缓存，LRU 淘汰，命中时不再 open / fstat
+ * 被淘汰的文件如果还在发送，fd 由 CachedFilePtr 的引用计数保证不会提前关闭
+ * 文件内容变化之后需要调用 invalidate，缓存不会检查 mtime
+ * 线程安全，多个 loop 可以共享同一个 FileCache
+ */
+class FileCache : noncopyable {
+  public:
+    explicit FileCache(size_t capacity = 64) : capacity_(capacity) {}
+
+    CachedFilePtr open(const std::string &path);  // 打开失败返回空指针，errno 保存原因
+    void invalidate(const std::string &path);
+    void clear();
+
+    size_t size() const;
+
+  private:
+    using LruList = std::list<std::pair<std::string, CachedFilePtr>>;
+
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    LruList lru_;  // 头部是最近使用的
+    std::unordered_map<std::string, LruList::iterator> files_;
+};
@@ -0,0 +1,321 @@
+#include "HttpContext.h"
+
+#include "Buffer.h"
+#include "SimdSearch.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace {
+
+const size_t kChunkedBodyKeep = 64 * 1024;  // 超过这个大小的 chunked body 处理完就释放，不在连接上一直占着
+
+HttpRequest::Method toMethod(const StringPiece &token) {
+    switch (token.size()) {
+    case 3:
+        if (token == "GET") return HttpRequest::kGet;
+        if (token == "PUT") return HttpRequest::kPut;
+        break;
+    case 4:
+        if (token == "POST") return HttpRequest::kPost;
+        if (token == "HEAD") return HttpRequest::kHead;
+        break;
+    case 5:
+        if (token == "PATCH") return HttpRequest::kPatch;
+        break;
+    case 6:
+        if (token == "DELETE") return HttpRequest::kDelete;
+        break;
+    case 7:
+        if (token == "OPTIONS") return HttpRequest::kOptions;
+        break;
+    }
+    return HttpRequest::kInvalid;
+}
+
+// 返回 end 表示没有找到，和 std::find 一样，memchr 比逐字节比较快
+const char *findChar(const char *begin, const char *end, char c) {
+    const void *p = ::memchr(begin, c, end - begin);
+    return p ? static_cast<const char *>(p) : end;
+}
+
+bool isBlank(char c) { return c == ' ' || c == '\t'; }
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    return (c | 0x20) - 'a' + 10;
+}
+
+}  // namespace
+
+void HttpContext::reset() {
+    state_ = kExpectHeaders;
+    scanned_ = 0;
+    headerLength_ = 0;
+    bodyLength_ = 0;
+    cursor_ = 0;
+    chunkRemaining_ = 0;
+    requestLength_ = 0;
+    errorStatus_ = 0;
+    connectionIndex_ = -1;
+    contentLengthIndex_ = -1;
+    transferEncodingIndex_ = -1;
+    if (chunkedBody_.capacity() > kChunkedBodyKeep) {
+        std::string().swap(chunkedBody_);
+    } else {
+        chunkedBody_.clear();
+    }
+    request_.reset();
+}
+
+HttpContext::ParseResult HttpContext::parse(const Buffer *buf) {
+    const char *base = buf->peek();
+    size_t len = buf->readableBytes();
+
+    if (state_ == kGotAll) {
+        return complete(base);
+    }
+
+    if (state_ == kExpectHeaders) {
+        // 只扫描新到的数据，往回退 3 个字节防止 "\r\n\r\n" 被拆在两次 read 之间
+        size_t start = scanned_ > 3 ? scanned_ - 3 : 0;
+        const char *blank = len > start ? static_cast<const char *>(::memmem(base + start, len - start, "\r\n\r\n", 4))
+                                        : nullptr;
+        if (blank == nullptr) {
+            scanned_ = len;
+            return len > kMaxHeaderBytes ? fail(431) : kNeedMore;
+        }
+        headerLength_ = blank - base + 4;
+        if (headerLength_ > kMaxHeaderBytes) {
+            return fail(431);
+        }
+
+        request_.base_ = base;
+        const char *lineEnd = SimdSearch::findCRLF(base, base + headerLength_);
+        if (!parseRequestLine(base, lineEnd) || !parseHeaders(base, lineEnd + 2, base + headerLength_ - 2) ||
+            !parseBodyLength()) {
+            return kError;
+        }
+    }
+
+    if (state_ == kExpectBody) {
+        if (len < headerLength_ + bodyLength_) {
+            return kNeedMore;
+        }
+        requestLength_ = headerLength_ + bodyLength_;
+        return complete(base);
+    }
+    return parseChunks(base, len);
+}
+
+bool HttpContext::parseRequestLine(const char *begin, const char *end) {
+    const char *space = findChar(begin, end, ' ');
+    request_.method_ = toMethod(StringPiece(begin, space - begin));
+    if (space == end) {
+        errorStatus_ = 400;
+        return false;
+    }
+    if (request_.method_ == HttpRequest::kInvalid) {
+        errorStatus_ = 501;
+        return false;
+    }
+
+    const char *target = space + 1;
+    space = findChar(target, end, ' ');
+    if (space == end || space == target) {
+        errorStatus_ = 400;
+        return false;
+    }
+    const char *question = findChar(target, space, '?');
+    request_.path_.offset = static_cast<uint32_t>(target - begin);
+    request_.path_.length = static_cast<uint32_t>(question - target);
+    if (question != space) {
+        request_.query_.offset = static_cast<uint32_t>(question + 1 - begin);
+        request_.query_.length = static_cast<uint32_t>(space - question - 1);
+    }
+
+    StringPiece version(space + 1, end - space - 1);
+    if (version == "HTTP/1.1") {
+        request_.version_ = HttpRequest::kHttp11;
+    } else if (version == "HTTP/1.0") {
+        request_.version_ = HttpRequest::kHttp10;
+    } else {
+        errorStatus_ = version.size() > 5 && ::memcmp(version.data(), "HTTP/", 5) == 0 ? 505 : 400;
+        return false;
+    }
+    return true;
+}
+
+// [begin, end) 是请求行之后的若干行 header，每一行都以 \r\n 结尾
+bool HttpContext::parseHeaders(const char *base, const char *begin, const char *end) {
+    for (const char *line = begin; line < end;) {
+        const char *eol = SimdSearch::findCRLF(line, end);
+        const char *colon = findChar(line, eol, ':');
+        // header 名字里不能有空白，这样也拒绝了已经废弃的折行（obs-fold）
+        if (colon == line || colon == eol || std::find_if(line, colon, isBlank) != colon) {
+            errorStatus_ = 400;
+            return false;
+        }
+        if (request_.numHeaders_ == HttpRequest::kMaxHeaders) {
+            errorStatus_ = 431;
+            return false;
+        }
+
+        const char *value = colon + 1;
+        while (value < eol && (*value == ' ' || *value == '\t')) {
+            ++value;
+        }
+        const char *valueEnd = eol;
+        while (valueEnd > value && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t')) {
+            --valueEnd;
+        }
+
+        StringPiece fieldName(line, colon - line);
+        int *index = nullptr;
+        if (fieldName.equalsIgnoreCase("Connection")) {
+            index = &connectionIndex_;
+        } else if (fieldName.equalsIgnoreCase("Content-Length")) {
+            index = &contentLengthIndex_;
+        } else if (fieldName.equalsIgnoreCase("Transfer-Encoding")) {
+            index = &transferEncodingIndex_;
+        }
+        if (index != nullptr && *index < 0) {
+            *index = request_.numHeaders_;
+        } else if (index != nullptr && index != &connectionIndex_) {
+            errorStatus_ = 400;  // 重复的 Content-Length / Transfer-Encoding 也可能用来走私请求
+            return false;
+        }
+
+        HttpRequest::Range &name = request_.headerNames_[request_.numHeaders_];
+        name.offset = static_cast<uint32_t>(line - base);
+        name.length = static_cast<uint32_t>(colon - line);
+        HttpRequest::Range &range = request_.headerValues_[request_.numHeaders_];
+        range.offset = static_cast<uint32_t>(value - base);
+        range.length = static_cast<uint32_t>(valueEnd - value);
+        ++request_.numHeaders_;
+        line = eol + 2;
+    }
+    return true;
+}
+
+// 根据 header 决定长连接和 body 的边界
+bool HttpContext::parseBodyLength() {
+    StringPiece connection = headerValue(connectionIndex_);
+    if (request_.version_ == HttpRequest::kHttp11) {
+        request_.keepAlive_ = !connection.equalsIgnoreCase("close");
+    } else {
+        request_.keepAlive_ = connection.equalsIgnoreCase("keep-alive");
+    }
+
+    StringPiece transferEncoding = headerValue(transferEncodingIndex_);
+    StringPiece contentLength = headerValue(contentLengthIndex_);
+    if (!transferEncoding.empty()) {
+        //!NOTE: 同时带 Content-Length 和 chunked 是请求走私的常见手法，直接拒绝
+        if (!transferEncoding.equalsIgnoreCase("chunked")) {
+            errorStatus_ = 501;
+            return false;
+        }
+        if (!contentLength.empty()) {
+            errorStatus_ = 400;
+            return false;
+        }
+        request_.chunked_ = true;
+        cursor_ = headerLength_;
+        state_ = kExpectChunkSize;
+        return true;
+    }
+
+    bodyLength_ = 0;
+    if (!contentLength.empty()) {
+        for (char c : contentLength) {
+            if (c < '0' || c > '9') {
+                errorStatus_ = 400;
+                return false;
+            }
+            bodyLength_ = bodyLength_ * 10 + (c - '0');
+            if (bodyLength_ > kMaxBodyBytes) {
+                errorStatus_ = 413;
+                return false;
+            }
+        }
+    }
+    state_ = kExpectBody;
+    return true;
+}
+
+// chunked 的 body 边收边解码到 chunkedBody_，cursor_ 记住解析到的位置，数据不完整时下次从这里继续
+HttpContext::ParseResult HttpContext::parseChunks(const char *base, size_t len) {
+    while (true) {
+        if (state_ == kExpectChunkData) {
+            if (len < cursor_ + chunkRemaining_ + 2) {
+                return kNeedMore;
+            }
+            const char *data = base + cursor_;
+            if (data[chunkRemaining_] != '\r' || data[chunkRemaining_ + 1] != '\n') {
+                return fail(400);
+            }
+            chunkedBody_.append(data, chunkRemaining_);
+            cursor_ += chunkRemaining_ + 2;
+            state_ = kExpectChunkSize;
+        }
+
+        // 很小的 chunk 也会让分帧的开销远大于 body 本身，整个请求也要有上限
+        if (cursor_ - headerLength_ > 2 * kMaxBodyBytes) {
+            return fail(413);
+        }
+        const char *line = base + cursor_;
+        const char *eol = len > cursor_ ? SimdSearch::findCRLF(line, base + len) : nullptr;
+        if (eol == nullptr) {
+            return len - cursor_ > kMaxChunkLineBytes ? fail(400) : kNeedMore;
+        }
+        if (static_cast<size_t>(eol - line) > kMaxChunkLineBytes) {
+            return fail(400);
+        }
+        cursor_ = eol + 2 - base;
+
+        if (state_ == kExpectChunkTrailer) {
+            if (eol == line) {
+                requestLength_ = cursor_;
+                return complete(base);
+            }
+            continue;  // trailer 里的 header 直接忽略
+        }
+
+        size_t size = 0;
+        const char *p = line;
+        for (; p < eol && isxdigit(static_cast<unsigned char>(*p)); ++p) {
+            size = size * 16 + hexValue(*p);
+            if (size > kMaxBodyBytes) {
+                return fail(413);
+            }
+        }
+        // chunk size 后面可以跟 ";name=value" 形式的扩展，忽略
+        if (p == line || (p < eol && *p != ';' && *p != ' ' && *p != '\t')) {
+            return fail(400);
+        }
+        if (size == 0) {
+            state_ = kExpectChunkTrailer;
+        } else if (chunkedBody_.size() + size > kMaxBodyBytes) {
+            return fail(413);
+        } else {
+            chunkRemaining_ = size;
+            state_ = kExpectChunkData;
+        }
+    }
+}
+
+// 把解析结果绑定到当前的 Buffer::peek()
+HttpContext::ParseResult HttpContext::complete(const char *base) {
+    request_.base_ = base;
+    if (request_.chunked_) {
+        request_.bodyData_ = chunkedBody_.data();
+        request_.bodyLength_ = chunkedBody_.size();
+    } else {
+        request_.bodyData_ = base + headerLength_;
+        request_.bodyLength_ = bodyLength_;
+    }
+    state_ = kGotAll;
+    return kComplete;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "HttpRequest.h"
+#include "noncopyable.h"
+
+#include <string>
+
+class Buffer;
+
+/**
+ * 每个连接一个的增量 HTTP/1.1 请求解析器，直接在 Buffer::peek() 上解析，不 retrieve
+ * - 数据不完整时返回 kNeedMore 并记住已经扫描过的位置，下一次从那里继续找 header 的结尾，不会重复扫描
+ * - header 放在 HttpRequest 的定长数组里，Content-Length 的 body 直接指向 Buffer，稳态下不分配内存；
+ *   chunked 的 body 解码到 chunkedBody_，容量在请求之间复用
+ * - kComplete 之后调用者处理请求，retrieve(requestLength()) 再 reset()，同一个 Buffer 里流水线的下一个请求接着解析
+ * - kError 时 errorStatus() 是应该返回的状态码（400 / 413 / 431 / 501 / 505），连接不能再继续使用
+ */
+class HttpContext : noncopyable {
+  public:
+    enum ParseResult { kNeedMore, kComplete, kError };
+
+    static const size_t kMaxHeaderBytes = 8 * 1024;    // 请求行加所有 header
+    static const size_t kMaxBodyBytes = 1024 * 1024;   // Content-Length 或者 chunked 解码之后的长度
+    static const size_t kMaxChunkLineBytes = 1024;     // chunk size 行和 trailer 行
+
+    HttpContext() { reset(); }
+
+    ParseResult parse(const Buffer *buf);
+    void reset();
+
+    const HttpRequest &request() const { return request_; }
+    size_t requestLength() const { return requestLength_; }  // 这个请求在 Buffer 里占用的字节数
+    int errorStatus() const { return errorStatus_; }
+
+  private:
+    enum State { kExpectHeaders, kExpectBody, kExpectChunkSize, kExpectChunkData, kExpectChunkTrailer, kGotAll };
+
+    ParseResult fail(int status) {
+        errorStatus_ = status;
+        return kError;
+    }
+    bool parseRequestLine(const char *begin, const char *end);
+    bool parseHeaders(const char *base, const char *begin, const char *end);
+    bool parseBodyLength();
+    ParseResult parseChunks(const char *base, size_t len);
+    ParseResult complete(const char *base);
+    StringPiece headerValue(int index) const { return index < 0 ? StringPiece() : request_.headerValue(index); }
+
+    State state_;
+    size_t scanned_;       // 已经找过 header 结尾的字节数
+    size_t headerLength_;  // 包括最后的空行
+    size_t bodyLength_;    // Content-Length
+    size_t cursor_;        // chunked 解析到的位置（相对请求起始）
+    size_t chunkRemaining_;
+    size_t requestLength_;
+    int errorStatus_;
+    // 决定长连接和 body 边界的 header 在解析时顺便记下下标，不用再按名字查找，-1 表示没有
+    int connectionIndex_;
+    int contentLengthIndex_;
+    int transferEncodingIndex_;
+    std::string chunkedBody_;
+    HttpRequest request_;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "StringPiece.h"
+
+#include <stdint.h>
+
+/**
+ * HttpContext 解析出来的请求，不拷贝任何数据
+ * - 请求行和 header 记录的是相对请求起始位置的偏移，解析完成时才绑定到 Buffer::peek()，
+ *   等待 body 期间 Buffer 扩容挪动数据也不影响
+ * - path、header、body 都指向连接的 inputBuffer_（chunked 的 body 指向 HttpContext 里解码后的数据），
+ *   只在 HttpServer 的回调期间有效，需要保存的要自己拷贝
+ */
+class HttpRequest {
+  public:
+    enum Method { kInvalid, kGet, kPost, kHead, kPut, kDelete, kOptions, kPatch };
+    enum Version { kUnknown, kHttp10, kHttp11 };
+
+    static const int kMaxHeaders = 64;
+
+    HttpRequest() { reset(); }
+
+    Method method() const { return method_; }
+    const char *methodString() const;
+    Version version() const { return version_; }
+
+    StringPiece path() const { return piece(path_); }
+    StringPiece query() const { return piece(query_); }  // '?' 之后的部分，不包括 '?'
+
+    // 名字不区分大小写，没有时返回空的 StringPiece
+    StringPiece getHeader(const StringPiece &name) const {
+        for (int i = 0; i < numHeaders_; ++i) {
+            if (piece(headerNames_[i]).equalsIgnoreCase(name)) {
+                return piece(headerValues_[i]);
+            }
+        }
+        return StringPiece();
+    }
+    int headerCount() const { return numHeaders_; }
+    StringPiece headerName(int i) const { return piece(headerNames_[i]); }
+    StringPiece headerValue(int i) const { return piece(headerValues_[i]); }
+
+    StringPiece body() const { return StringPiece(bodyData_, bodyLength_); }
+
+    bool keepAlive() const { return keepAlive_; }  // HTTP/1.1 默认长连接，HTTP/1.0 需要 Connection: keep-alive
+    bool chunked() const { return chunked_; }
+
+  private:
+    friend class HttpContext;
+
+    struct Range {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    StringPiece piece(const Range &range) const { return StringPiece(base_ + range.offset, range.length); }
+
+    void reset() {
+        base_ = nullptr;
+        method_ = kInvalid;
+        version_ = kUnknown;
+        path_.offset = path_.length = 0;
+        query_.offset = query_.length = 0;
+        numHeaders_ = 0;
+        bodyData_ = nullptr;
+        bodyLength_ = 0;
+        keepAlive_ = false;
+        chunked_ = false;
+    }
+
+    const char *base_;  // 请求在 Buffer 里的起始地址，解析完成时设置
+    Method method_;
+    Version version_;
+    Range path_;
+    Range query_;
+    Range headerNames_[kMaxHeaders];
+    Range headerValues_[kMaxHeaders];
+    int numHeaders_;
+    const char *bodyData_;
+    size_t bodyLength_;
+    bool keepAlive_;
+    bool chunked_;
+};
+
+inline const char *HttpRequest::methodString() const {
+    switch (method_) {
+    case kGet:
+        return "GET";
+    case kPost:
+        return "POST";
+    case kHead:
+        return "HEAD";
+    case kPut:
+        return "PUT";
+    case kDelete:
+        return "DELETE";
+    case kOptions:
+        return "OPTIONS";
+    case kPatch:
+        return "PATCH";
+    default:
+        return "UNKNOWN";
+    }
+}
@@ -0,0 +1,82 @@
+#include "HttpResponse.h"
+
+#include <string.h>
+
+const char *HttpResponse::reasonPhrase(int code) {
+    switch (code) {
+    case k200Ok:
+        return "OK";
+    case k204NoContent:
+        return "No Content";
+    case k301MovedPermanently:
+        return "Moved Permanently";
+    case k304NotModified:
+        return "Not Modified";
+    case k400BadRequest:
+        return "Bad Request";
+    case k404NotFound:
+        return "Not Found";
+    case k413PayloadTooLarge:
+        return "Payload Too Large";
+    case k431RequestHeaderFieldsTooLarge:
+        return "Request Header Fields Too Large";
+    case k500InternalServerError:
+        return "Internal Server Error";
+    case k501NotImplemented:
+        return "Not Implemented";
+    case k505HttpVersionNotSupported:
+        return "HTTP Version Not Supported";
+    default:
+        return "Unknown";
+    }
+}
+
+namespace {
+
+char *appendLiteral(char *p, const char *data, size_t len) {
+    ::memcpy(p, data, len);
+    return p + len;
+}
+
+char *appendDecimal(char *p, size_t value) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (n > 0) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+}  // namespace
+
+void HttpResponse::appendToBuffer(Buffer *output) const {
+    // 回调没有设置状态码的当作 500，免得客户端一直等
+    int code = statusCode_ == kUnknown ? k500InternalServerError : statusCode_;
+    StringPiece message = statusMessage_.empty() ? StringPiece(reasonPhrase(code)) : StringPiece(statusMessage_);
+
+    //!NOTE: 状态行和固定的 header 直接拼到输出 Buffer 的可写区域，不用 snprintf，每个响应省下两三百纳秒
+    output->ensureWritableBytes(128 + message.size());
+    char *begin = output->beginWrite();
+    char *p = appendLiteral(begin, "HTTP/1.1 ", 9);
+    p = appendDecimal(p, static_cast<size_t>(code));
+    *p++ = ' ';
+    p = appendLiteral(p, message.data(), message.size());
+    p = appendLiteral(p, "\r\nContent-Length: ", 18);
+    p = appendDecimal(p, body_.size());
+    if (closeConnection_) {
+        p = appendLiteral(p, "\r\nConnection: close\r\n", 21);
+    } else {
+        p = appendLiteral(p, "\r\nConnection: Keep-Alive\r\n", 26);
+    }
+    output->hasWritten(p - begin);
+
+    output->append(headers_.peek(), headers_.readableBytes());
+    output->append("\r\n", 2);
+    if (!headRequest_) {
+        output->append(body_.data(), body_.size());
+    }
+}
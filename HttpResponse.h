@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Buffer.h"
+#include "StringPiece.h"
+#include "noncopyable.h"
+
+#include <string>
+
+/**
+ * HttpServer 回调里填写的响应，每个连接一个，在请求之间复用
+ * - addHeader 直接把 "name: value\r\n" 写进 headers_，setBody 复用 body_ 的容量，稳态下不分配内存
+ * - appendToBuffer 把状态行、Content-Length、Connection、其余 header 和 body 依次写进输出 Buffer，
+ *   流水线的多个响应按请求的顺序拼在一起，最后一次 send 出去
+ */
+class HttpResponse : noncopyable {
+  public:
+    enum StatusCode {
+        kUnknown,
+        k200Ok = 200,
+        k204NoContent = 204,
+        k301MovedPermanently = 301,
+        k304NotModified = 304,
+        k400BadRequest = 400,
+        k404NotFound = 404,
+        k413PayloadTooLarge = 413,
+        k431RequestHeaderFieldsTooLarge = 431,
+        k500InternalServerError = 500,
+        k501NotImplemented = 501,
+        k505HttpVersionNotSupported = 505,
+    };
+
+    HttpResponse() { reset(true, false); }
+
+    // 状态描述默认按状态码取，一般不需要设置
+    void setStatusCode(int code) { statusCode_ = code; }
+    void setStatusMessage(const StringPiece &message) { statusMessage_.assign(message.data(), message.size()); }
+    int statusCode() const { return statusCode_; }
+
+    void setContentType(const StringPiece &contentType) { addHeader("Content-Type", contentType); }
+    // Content-Length 和 Connection 由 appendToBuffer 生成，不要自己添加
+    void addHeader(const StringPiece &name, const StringPiece &value) {
+        headers_.append(name.data(), name.size());
+        headers_.append(": ", 2);
+        headers_.append(value.data(), value.size());
+        headers_.append("\r\n", 2);
+    }
+
+    void setBody(const StringPiece &body) { body_.assign(body.data(), body.size()); }
+    std::string *mutableBody() { return &body_; }
+
+    void setCloseConnection(bool on) { closeConnection_ = on; }
+    bool closeConnection() const { return closeConnection_; }
+
+    void appendToBuffer(Buffer *output) const;
+
+    static const char *reasonPhrase(int code);
+
+  private:
+    friend class HttpServer;
+
+    // HttpServer 在每个请求的回调之前调用
+    void reset(bool keepAlive, bool headRequest) {
+        statusCode_ = kUnknown;
+        statusMessage_.clear();
+        headers_.retrieveAll();
+        body_.clear();
+        closeConnection_ = !keepAlive;
+        headRequest_ = headRequest;
+    }
+
+    int statusCode_;
+    std::string statusMessage_;
+    Buffer headers_;
+    std::string body_;
+    bool closeConnection_;
+    bool headRequest_;  // HEAD 的响应带 Content-Length 但是没有 body
+};
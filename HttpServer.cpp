@@ -0,0 +1,84 @@
+#define MUDUO_LOG_MODULE kLogModuleTcp
+
+#include "HttpServer.h"
+
+#include "HttpContext.h"
+#include "Logger.h"
+
+#include <memory>
+
+// 每个连接的 HTTP 状态，放在 TcpConnection 的 context 里
+struct HttpServer::Session {
+    HttpContext context;
+    HttpResponse response;
+    Buffer output;  // 这一次 onMessage 产生的所有响应
+    bool closing = false;
+};
+
+static void defaultHttpCallback(const HttpRequest &, HttpResponse *resp) {
+    resp->setStatusCode(HttpResponse::k404NotFound);
+    resp->setCloseConnection(true);
+}
+
+HttpServer::HttpServer(EventLoop *loop, const InetAddress &listenAddr, const std::string &name, TcpServer::Option option)
+    : server_(loop, listenAddr, name, option)
+    , httpCallback_(defaultHttpCallback) {
+    server_.setConnectionCallback(std::bind(&HttpServer::onConnection, this, std::placeholders::_1));
+    server_.setMessageCallback(std::bind(&HttpServer::onMessage,
+                                         this,
+                                         std::placeholders::_1,
+                                         std::placeholders::_2,
+                                         std::placeholders::_3));
+}
+
+void HttpServer::onConnection(const TcpConnectionPtr &conn) {
+    if (conn->connected()) {
+        conn->setContext(std::make_shared<Session>());
+    } else {
+        conn->setContext(nullptr);
+    }
+}
+
+void HttpServer::onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp) {
+    Session *session = static_cast<Session *>(conn->getContext().get());
+    if (session == nullptr || session->closing) {
+        buf->retrieveAll();  // 已经决定关闭的连接，之后的请求不再处理
+        return;
+    }
+
+    while (buf->readableBytes() > 0) {
+        HttpContext::ParseResult result = session->context.parse(buf);
+        if (result == HttpContext::kNeedMore) {
+            break;
+        }
+        if (result == HttpContext::kError) {
+            LOG_DEBUG("%s bad request, status %d", conn->name().c_str(), session->context.errorStatus());
+            session->response.reset(false, false);
+            session->response.setStatusCode(session->context.errorStatus());
+            session->response.appendToBuffer(&session->output);
+            session->closing = true;
+            break;
+        }
+
+        const HttpRequest &request = session->context.request();
+        session->response.reset(request.keepAlive(), request.method() == HttpRequest::kHead);
+        httpCallback_(request, &session->response);
+        session->response.appendToBuffer(&session->output);
+
+        //!NOTE: request 指向 buf 里的数据，回调返回之后才能 retrieve
+        buf->retrieve(session->context.requestLength());
+        session->context.reset();
+        if (session->response.closeConnection()) {
+            session->closing = true;
+            break;
+        }
+    }
+
+    if (session->output.readableBytes() > 0) {
+        conn->send(&session->output);
+    }
+    if (session->closing) {
+        buf->retrieveAll();
+        conn->shutdown();  // 等输出缓冲区发完再关闭写端
+    }
+}
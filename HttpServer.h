@@ -0,0 +1,43 @@
+#pragma once
+
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "TcpServer.h"
+#include "noncopyable.h"
+
+#include <functional>
+#include <string>
+
+/**
+ * 基于 TcpServer 的 HTTP/1.1 服务器
+ * - 每个连接一个 HttpContext 增量解析 inputBuffer_，半包时等下一次 onMessage，不拷贝请求
+ * - 长连接：HTTP/1.1 默认保持，HTTP/1.0 需要 Connection: keep-alive，响应里 Connection: close 之后关闭写端
+ * - 流水线：一次 onMessage 里的多个请求依次调用回调，响应按请求的顺序拼到同一个输出 Buffer，最后只 send 一次
+ * - 回调是同步的，在连接所在的 loop 线程里调用，不能阻塞
+ */
+class HttpServer : noncopyable {
+  public:
+    using HttpCallback = std::function<void(const HttpRequest &, HttpResponse *)>;
+
+    HttpServer(EventLoop *loop,
+               const InetAddress &listenAddr,
+               const std::string &name,
+               TcpServer::Option option = TcpServer::kNoReusePort);
+
+    void setHttpCallback(const HttpCallback &cb) { httpCallback_ = cb; }
+    void setThreadNum(int numThreads) { server_.setThreadNum(numThreads); }
+
+    // 其余的设置（边缘触发、空闲超时等）直接通过 TcpServer，必须在 start 之前
+    TcpServer &tcpServer() { return server_; }
+
+    void start() { server_.start(); }
+
+  private:
+    struct Session;
+
+    void onConnection(const TcpConnectionPtr &conn);
+    void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp receiveTime);
+
+    TcpServer server_;
+    HttpCallback httpCallback_;
+};
@@ -0,0 +1,94 @@
+#define MUDUO_LOG_MODULE kLogModuleLoop
+
+#include "IdleWheel.h"
+
+#include "EventLoop.h"
+#include "Logger.h"
+
+IdleWheel::IdleWheel(EventLoop *loop, double idleSeconds)
+    : loop_(loop)
+    , idleSeconds_(idleSeconds)
+    , buckets_(kNumTicks + 1)
+    , current_(0)
+    , size_(0) {}
+
+IdleWheel::~IdleWheel() { loop_->cancel(tickTimer_); }
+
+void IdleWheel::start() {
+    //!NOTE: 定时器只持有 weak_ptr，wheel 析构之后定时器回调什么都不做
+    tickTimer_ = loop_->runEvery(idleSeconds_ / kNumTicks,
+                                 std::bind(&IdleWheel::onTick, std::weak_ptr<IdleWheel>(shared_from_this())));
+}
+
+void IdleWheel::onTick(const std::weak_ptr<IdleWheel> &weakWheel) {
+    std::shared_ptr<IdleWheel> wheel(weakWheel.lock());
+    if (wheel) {
+        wheel->advance();
+    }
+}
+
+void IdleWheel::touch(IdleEntry *entry) {
+    if (entry->bucket_ == current_) {
+        return;  // 同一个 tick 内的重复刷新
+    }
+    if (entry->linked()) {
+        unlink(entry);
+    }
+    link(entry, current_);
+}
+
+void IdleWheel::remove(IdleEntry *entry) {
+    if (entry->linked()) {
+        unlink(entry);
+    }
+}
+
+void IdleWheel::advance() {
+    // 下一个桶里的 entry 已经空闲了 kNumTicks 个 tick，先摘到局部链表上，回调里 remove 也是安全的
+    current_ = (current_ + 1) % static_cast<int>(buckets_.size());
+    IdleEntry &head = buckets_[current_];
+    if (head.next_ == &head) {
+        return;
+    }
+
+    IdleEntry expired;
+    expired.next_ = head.next_;
+    expired.prev_ = head.prev_;
+    expired.next_->prev_ = &expired;
+    expired.prev_->next_ = &expired;
+    head.next_ = &head;
+    head.prev_ = &head;
+    for (IdleEntry *entry = expired.next_; entry != &expired; entry = entry->next_) {
+        entry->bucket_ = kNumTicks + 1;  // 不属于任何桶，但仍然是 linked 状态
+    }
+
+    int count = 0;
+    while (expired.next_ != &expired) {
+        IdleEntry *entry = expired.next_;
+        unlink(entry);
+        ++count;
+        if (entry->expireCallback_) {
+            entry->expireCallback_(entry);
+        }
+    }
+    LOG_DEBUG("IdleWheel::advance - %d entries expired, %lu left", count, size_);
+}
+
+void IdleWheel::link(IdleEntry *entry, int bucket) {
+    IdleEntry &head = buckets_[bucket];
+    entry->prev_ = head.prev_;
+    entry->next_ = &head;
+    head.prev_->next_ = entry;
+    head.prev_ = entry;
+    entry->bucket_ = bucket;
+    ++size_;
+}
+
+void IdleWheel::unlink(IdleEntry *entry) {
+    entry->prev_->next_ = entry->next_;
+    entry->next_->prev_ = entry->prev_;
+    entry->prev_ = entry;
+    entry->next_ = entry;
+    entry->bucket_ = -1;
+    --size_;
+}
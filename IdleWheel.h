@@ -0,0 +1,75 @@
+#pragma once
+
+#include "TimerId.h"
+#include "noncopyable.h"
+
+#include <memory>
+#include <vector>
+
+class EventLoop;
+
+/**
+ * 挂在 IdleWheel 上的节点，内嵌在需要做空闲超时的对象里（例如 TcpConnection）
+ * 只能在所属 loop 线程中操作
+ */
+class IdleEntry : noncopyable {
+  public:
+    using ExpireCallback = void (*)(IdleEntry *);
+
+    IdleEntry() : prev_(this), next_(this), bucket_(-1), owner_(nullptr), expireCallback_(nullptr) {}
+
+    void setOwner(void *owner, ExpireCallback cb) {
+        owner_ = owner;
+        expireCallback_ = cb;
+    }
+    void *owner() const { return owner_; }
+
+    bool linked() const { return bucket_ >= 0; }
+
+  private:
+    friend class IdleWheel;
+
+    IdleEntry *prev_;
+    IdleEntry *next_;
+    int bucket_;  // 所在的桶，-1 表示不在 wheel 上
+    void *owner_;
+    ExpireCallback expireCallback_;
+};
+
+/**
+ * 每个 loop 一个的空闲超时时间轮，桶是 IdleEntry 的双向循环链表
+ * - touch: 把 entry 移到当前桶，已经在当前桶时只有一次比较，不分配内存
+ * - 内部定时器每 tick 前进一格，最老的桶整体到期，批量回调 expireCallback
+ *
+ * 空闲超时 idleSeconds 被分成 kNumTicks 个 tick，实际关闭时间在 [idleSeconds, idleSeconds * (1 + 1/kNumTicks)] 之间
+ */
+class IdleWheel : noncopyable, public std::enable_shared_from_this<IdleWheel> {
+  public:
+    static const int kNumTicks = 8;
+
+    IdleWheel(EventLoop *loop, double idleSeconds);
+    ~IdleWheel();
+
+    void start();  // 启动内部定时器，可以跨线程调用
+
+    void touch(IdleEntry *entry);   // 有读写活动，刷新 entry
+    void remove(IdleEntry *entry);  // 从 wheel 上摘掉 entry
+    void advance();                 // 前进一格，批量回调到期的 entry，一般由内部定时器调用
+
+    EventLoop *getLoop() const { return loop_; }
+    double idleSeconds() const { return idleSeconds_; }
+    size_t size() const { return size_; }
+
+  private:
+    static void onTick(const std::weak_ptr<IdleWheel> &weakWheel);
+
+    void link(IdleEntry *entry, int bucket);
+    void unlink(IdleEntry *entry);
+
+    EventLoop *loop_;
+    const double idleSeconds_;
+    std::vector<IdleEntry> buckets_;  // 哨兵节点
+    int current_;                     // 新刷新的 entry 放在这个桶
+    size_t size_;
+    TimerId tickTimer_;
+};
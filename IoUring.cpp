@@ -0,0 +1,221 @@
+#define MUDUO_LOG_MODULE kLogModuleLoop
+
+#include "IoUring.h"
+
+#include "Logger.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+static int ioUringSetup(unsigned entries, io_uring_params *params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+// 依次尝试新内核上的优化参数，老内核返回 EINVAL 时去掉再试
+static int setupRing(unsigned entries, io_uring_params *params) {
+    const unsigned kFlags[] = {
+        IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_SINGLE_ISSUER |
+            IORING_SETUP_DEFER_TASKRUN,
+        IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN,
+        IORING_SETUP_CQSIZE,
+    };
+    int fd = -1;
+    for (size_t i = 0; i < sizeof(kFlags) / sizeof(kFlags[0]); ++i) {
+        memset(params, 0, sizeof(*params));
+        params->flags = kFlags[i];
+        params->cq_entries = entries * 4;  // 一个 channel 可能有多个完成事件，CQ 比 SQ 大
+        fd = ioUringSetup(entries, params);
+        if (fd >= 0 || errno != EINVAL) {
+            break;
+        }
+    }
+    return fd;
+}
+
+IoUring::IoUring(unsigned entries)
+    : ringFd_(-1)
+    , setupErrno_(0)
+    , features_(0)
+    , sqRing_(MAP_FAILED)
+    , sqRingSize_(0)
+    , cqRing_(MAP_FAILED)
+    , cqRingSize_(0)
+    , sqes_(static_cast<io_uring_sqe *>(MAP_FAILED))
+    , sqesSize_(0)
+    , sqHead_(nullptr)
+    , sqTail_(nullptr)
+    , sqMask_(0)
+    , sqEntries_(0)
+    , sqTailLocal_(0)
+    , cqHead_(nullptr)
+    , cqTail_(nullptr)
+    , cqMask_(0)
+    , cqes_(nullptr)
+    , numEnters_(0) {
+    io_uring_params params;
+    int fd = setupRing(entries, &params);
+    if (fd < 0) {
+        setupErrno_ = errno;
+        return;
+    }
+    // 超时依赖 IORING_ENTER_EXT_ARG（5.11），完成事件不能丢（NODROP）
+    if (!(params.features & IORING_FEAT_EXT_ARG) || !(params.features & IORING_FEAT_NODROP)) {
+        ::close(fd);
+        setupErrno_ = ENOSYS;
+        return;
+    }
+    features_ = params.features;
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (features_ & IORING_FEAT_SINGLE_MMAP) {
+        sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    }
+    sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sqRing_ == MAP_FAILED) {
+        setupErrno_ = errno;
+        ::close(fd);
+        return;
+    }
+    if (features_ & IORING_FEAT_SINGLE_MMAP) {
+        cqRing_ = sqRing_;
+    } else {
+        cqRing_ = ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    }
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(
+        ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    if (cqRing_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+        setupErrno_ = errno;
+        unmapRings();
+        ::close(fd);
+        return;
+    }
+
+    char *sq = static_cast<char *>(sqRing_);
+    sqHead_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sqMask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sqEntries_ = params.sq_entries;
+    sqTailLocal_ = *sqTail_;
+    // SQ 下标数组固定为 i => i，SQE 按顺序使用
+    unsigned *array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < sqEntries_; ++i) {
+        array[i] = i;
+    }
+
+    char *cq = static_cast<char *>(cqRing_);
+    cqHead_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cqMask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    ringFd_ = fd;
+}
+
+IoUring::~IoUring() {
+    unmapRings();
+    if (ringFd_ >= 0) {
+        ::close(ringFd_);
+    }
+}
+
+void IoUring::unmapRings() {
+    if (sqes_ != MAP_FAILED) {
+        ::munmap(sqes_, sqesSize_);
+        sqes_ = static_cast<io_uring_sqe *>(MAP_FAILED);
+    }
+    if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_) {
+        ::munmap(cqRing_, cqRingSize_);
+    }
+    cqRing_ = MAP_FAILED;
+    if (sqRing_ != MAP_FAILED) {
+        ::munmap(sqRing_, sqRingSize_);
+        sqRing_ = MAP_FAILED;
+    }
+}
+
+unsigned IoUring::pendingSqes() const { return sqTailLocal_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE); }
+
+io_uring_sqe *IoUring::getSqe() {
+    if (pendingSqes() >= sqEntries_) {
+        submit();  // SQ 满了，先交给内核
+        if (pendingSqes() >= sqEntries_) {
+            return nullptr;
+        }
+    }
+    io_uring_sqe *sqe = &sqes_[sqTailLocal_ & sqMask_];
+    ++sqTailLocal_;
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+int IoUring::enter(unsigned toSubmit, unsigned minComplete, unsigned flags, const void *arg, size_t argSize) {
+    // 发布新的 tail，内核从 SQ 里取走 toSubmit 个 SQE
+    __atomic_store_n(sqTail_, sqTailLocal_, __ATOMIC_RELEASE);
+    ++numEnters_;
+    int ret = static_cast<int>(::syscall(__NR_io_uring_enter, ringFd_, toSubmit, minComplete, flags, arg, argSize));
+    return ret < 0 ? -errno : ret;
+}
+
+int IoUring::submit() {
+    unsigned toSubmit = pendingSqes();
+    if (toSubmit == 0) {
+        return 0;
+    }
+    int ret = enter(toSubmit, 0, 0, nullptr, 0);
+    if (ret < 0 && ret != -EINTR) {
+        LOG_ERROR("IoUring::submit - io_uring_enter error: %d", -ret);
+    }
+    return ret;
+}
+
+/**
+ * 提交和等待合并成一次 io_uring_enter
+ *!NOTE: 即使不等待也要带上 GETEVENTS，DEFER_TASKRUN 模式下完成事件只在这时候处理
+ */
+int IoUring::submitAndWait(int timeoutMs) {
+    unsigned toSubmit = pendingSqes();
+    unsigned minComplete = 0;
+    unsigned flags = IORING_ENTER_GETEVENTS;
+    io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    const void *argp = nullptr;
+    size_t argSize = 0;
+
+    if (timeoutMs != 0 && cqReady() == 0) {
+        minComplete = 1;
+        if (timeoutMs > 0) {
+            ts.tv_sec = timeoutMs / 1000;
+            ts.tv_nsec = (timeoutMs % 1000) * 1000000LL;
+            memset(&arg, 0, sizeof(arg));
+            arg.sigmask_sz = _NSIG / 8;
+            arg.ts = reinterpret_cast<uint64_t>(&ts);
+            flags |= IORING_ENTER_EXT_ARG;
+            argp = &arg;
+            argSize = sizeof(arg);
+        }
+    }
+    return enter(toSubmit, minComplete, flags, argp, argSize);
+}
+
+unsigned IoUring::cqReady() const { return __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE) - *cqHead_; }
+
+void IoUring::cqAdvance(unsigned n) { __atomic_store_n(cqHead_, *cqHead_ + n, __ATOMIC_RELEASE); }
+
+int IoUring::registerBufferRing(void *ring, unsigned entries, unsigned short groupId) {
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = entries;
+    reg.bgid = groupId;
+    int ret = static_cast<int>(::syscall(__NR_io_uring_register, ringFd_, IORING_REGISTER_PBUF_RING, &reg, 1));
+    return ret < 0 ? -errno : ret;
+}
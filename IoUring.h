@@ -0,0 +1,70 @@
+#pragma once
+
+#include "noncopyable.h"
+
+#include <linux/io_uring.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * io_uring 的最小封装，直接使用 io_uring_setup / io_uring_enter 系统调用，不依赖 liburing
+ * 只能在一个线程里使用（EventLoop 所在的线程）
+ *
+ * - getSqe: 取一个空闲的 SQE，SQ 满了先提交一次
+ * - submitAndWait: 提交所有 SQE 并等待完成事件，一次 io_uring_enter
+ * - cqReady / cqeAt / cqAdvance: 遍历并消费 CQ 里的完成事件
+ * - registerBufferRing: 注册 provided buffer ring，recv 时由内核从里面选一块缓冲区
+ */
+class IoUring : noncopyable {
+  public:
+    explicit IoUring(unsigned entries);
+    ~IoUring();
+
+    bool valid() const { return ringFd_ >= 0; }
+    int setupErrno() const { return setupErrno_; }  // io_uring_setup 失败的 errno
+
+    io_uring_sqe *getSqe();  // 返回的 SQE 已经清零
+
+    // 提交所有 SQE，CQ 为空时最多等待 timeoutMs 毫秒（< 0 一直等待，0 不等待），返回 io_uring_enter 的结果（-errno）
+    int submitAndWait(int timeoutMs);
+    int submit();  // 只提交，不等待
+
+    unsigned cqReady() const;
+    io_uring_cqe *cqeAt(unsigned i) const { return &cqes_[(cqHeadLocal() + i) & cqMask_]; }
+    void cqAdvance(unsigned n);
+
+    // 注册 provided buffer ring（IORING_REGISTER_PBUF_RING，5.19），失败返回 -errno
+    int registerBufferRing(void *ring, unsigned entries, unsigned short groupId);
+
+    uint64_t numEnters() const { return numEnters_; }  // io_uring_enter 的调用次数
+
+  private:
+    unsigned cqHeadLocal() const { return *cqHead_; }
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags, const void *arg, size_t argSize);
+    unsigned pendingSqes() const;
+    void unmapRings();
+
+    int ringFd_;
+    int setupErrno_;
+    unsigned features_;
+
+    void *sqRing_;
+    size_t sqRingSize_;
+    void *cqRing_;
+    size_t cqRingSize_;
+    io_uring_sqe *sqes_;
+    size_t sqesSize_;
+
+    unsigned *sqHead_;  // 内核更新
+    unsigned *sqTail_;  // 我们更新
+    unsigned sqMask_;
+    unsigned sqEntries_;
+    unsigned sqTailLocal_;  // 还没有发布给内核的 tail
+
+    unsigned *cqHead_;  // 我们更新
+    unsigned *cqTail_;  // 内核更新
+    unsigned cqMask_;
+    io_uring_cqe *cqes_;
+
+    uint64_t numEnters_;
+};
@@ -0,0 +1,384 @@
+#define MUDUO_LOG_MODULE kLogModuleLoop
+
+#include "IoUringPoller.h"
+
+#include "Channel.h"
+#include "EventLoop.h"
+#include "Logger.h"
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+
+const int kNew = -1;    // channel 未添加到 poller 中
+const int kAdded = 1;   // channel 已添加到 poller 中
+
+static uint64_t makeUserData(int fd, uint32_t generation) {
+    return (static_cast<uint64_t>(generation & 0x7fffffff) << 32) | static_cast<uint32_t>(fd);
+}
+
+IoUringPoller::IoUringPoller(EventLoop *loop)
+    : Poller(loop)
+    , ring_(kRingEntries)
+    , bufRing_(nullptr)
+    , buffers_(nullptr)
+    , bufTail_(0)
+    , completionChannel_(loop, -1) {
+    completionChannel_.setReadCallback(std::bind(&IoUringPoller::dispatchCompletions, this));
+}
+
+IoUringPoller::~IoUringPoller() {
+    if (bufRing_ != nullptr) {
+        ::munmap(bufRing_, kBufferCount * sizeof(io_uring_buf));
+        ::munmap(buffers_, kBufferCount * kBufferSize);
+    }
+}
+
+IoUringPoller::FdState &IoUringPoller::stateOf(int fd) {
+    if (static_cast<size_t>(fd) >= states_.size()) {
+        FdState empty = {nullptr, 0, 0, false, false, 0, false};
+        states_.resize(std::max(static_cast<size_t>(fd) + 1, states_.size() * 2), empty);
+    }
+    return states_[fd];
+}
+
+// 提交 POLL_ADD，ET 的 channel 是 multishot，LT 的 channel 是 oneshot
+void IoUringPoller::arm(int fd, FdState &state) {
+    Channel *channel = state.channel;
+    int events = channel->pollEvents() & ~EPOLLET;  // io_uring 自己决定触发方式
+    if (events == 0) {
+        return;
+    }
+    io_uring_sqe *sqe = ring_.getSqe();
+    if (sqe == nullptr) {
+        // 放回 rearmFds_，下一次 poll 再提交，否则 channel 的事件不变就再也不会提交
+        LOG_ERROR("IoUringPoller::arm - submission queue full, fd = %d, retry later", fd);
+        if (!state.needRearm) {
+            state.needRearm = true;
+            rearmFds_.push_back(fd);
+        }
+        return;
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = static_cast<uint32_t>(events);
+    sqe->len = channel->edgeTriggered() ? IORING_POLL_ADD_MULTI : 0;
+    sqe->user_data = makeUserData(fd, state.generation);
+
+    ++numUpdates_;
+    state.armed = true;
+    state.armedEvents = events;
+    channel->set_registeredEvents(channel->pollEvents());
+}
+
+// 取消还有效的 POLL_ADD，generation 加一之后旧请求的完成事件都会被丢弃
+void IoUringPoller::disarm(int fd, FdState &state) {
+    if (!state.armed) {
+        return;
+    }
+    io_uring_sqe *sqe = ring_.getSqe();
+    if (sqe == nullptr) {
+        LOG_ERROR("IoUringPoller::disarm - submission queue full, fd = %d", fd);
+    } else {
+        sqe->opcode = IORING_OP_POLL_REMOVE;
+        sqe->fd = -1;
+        sqe->addr = makeUserData(fd, state.generation);
+        sqe->user_data = kInternalTag;
+        ++numUpdates_;
+    }
+    ++state.generation;
+    state.armed = false;
+    state.channel->set_registeredEvents(0);
+}
+
+// 上一次 poll 完成的 oneshot 请求，事件处理完之后重新提交
+void IoUringPoller::rearmPending() {
+    // arm 失败时会追加到 rearmFds_，留到下一次
+    size_t count = rearmFds_.size();
+    for (size_t i = 0; i < count; ++i) {
+        int fd = rearmFds_[i];
+        FdState &state = states_[fd];
+        if (!state.needRearm) {
+            continue;
+        }
+        state.needRearm = false;
+        if (state.channel != nullptr && !state.armed) {
+            arm(fd, state);
+        }
+    }
+    rearmFds_.erase(rearmFds_.begin(), rearmFds_.begin() + count);
+}
+
+Timestamp IoUringPoller::poll(int timeoutMs, ChannelList *activeChannels) {
+    rearmPending();
+    if (!completions_.empty() || !rearmFds_.empty()) {
+        timeoutMs = 0;  // 提交失败的请求已经有完成事件了，或者还有没有提交成功的 POLL_ADD
+    }
+
+    // 本次迭代积累的 POLL_ADD / POLL_REMOVE 和等待合并成一次 io_uring_enter
+    ++numPolls_;
+    int ret = ring_.submitAndWait(timeoutMs);
+    Timestamp now(Timestamp::now());
+    if (ret < 0 && ret != -ETIME && ret != -EINTR && ret != -EBUSY) {
+        LOG_ERROR("IoUringPoller::poll - io_uring_enter error: %d", -ret);
+    }
+
+    size_t first = activeChannels->size();
+    unsigned n = ring_.cqReady();
+    for (unsigned i = 0; i < n; ++i) {
+        handleCqe(ring_.cqeAt(i), activeChannels);
+    }
+    ring_.cqAdvance(n);
+
+    // multishot 的 channel 一次可能有多个完成事件，合并之后只上报一次
+    for (size_t i = first; i < activeChannels->size(); ++i) {
+        Channel *channel = (*activeChannels)[i];
+        FdState &state = states_[channel->fd()];
+        channel->set_revents(state.revents);
+        state.revents = 0;
+        state.active = false;
+    }
+    //!NOTE: 完成模式的回调不在这里执行，回调里会修改 states_ 和提交新的请求，和普通 channel 一样交给 loop 分发
+    if (!completions_.empty()) {
+        completionChannel_.set_revents(EPOLLIN);
+        activeChannels->push_back(&completionChannel_);
+    }
+    return now;
+}
+
+void IoUringPoller::handleCqe(const io_uring_cqe *cqe, ChannelList *activeChannels) {
+    if (cqe->user_data & kInternalTag) {
+        return;  // POLL_REMOVE 的结果，请求可能已经结束了，失败也没有关系
+    }
+    if (cqe->user_data & kOpTag) {
+        Completion completion = {reinterpret_cast<IoUringOp *>(cqe->user_data & ~kOpTag), cqe->res, cqe->flags};
+        completions_.push_back(completion);
+        return;
+    }
+    int fd = static_cast<int>(static_cast<uint32_t>(cqe->user_data));
+    uint32_t generation = static_cast<uint32_t>(cqe->user_data >> 32);
+    if (static_cast<size_t>(fd) >= states_.size()) {
+        return;
+    }
+    FdState &state = states_[fd];
+    if (state.channel == nullptr || (state.generation & 0x7fffffff) != generation) {
+        return;  // channel 已经删除或者修改过事件，这是旧请求的完成事件
+    }
+
+    if (!(cqe->flags & IORING_CQE_F_MORE)) {
+        // oneshot 完成了，或者 multishot 被内核终止了，事件处理完之后重新提交
+        state.armed = false;
+        if (cqe->res >= 0 && !state.needRearm) {
+            state.needRearm = true;
+            rearmFds_.push_back(fd);
+        }
+    }
+    if (cqe->res < 0) {
+        if (cqe->res != -ECANCELED) {
+            LOG_ERROR("IoUringPoller::handleCqe - fd = %d, poll error: %d", fd, -cqe->res);
+        }
+        return;
+    }
+
+    state.revents |= cqe->res;
+    if (!state.active) {
+        state.active = true;
+        activeChannels->push_back(state.channel);
+    }
+}
+
+/**
+ * 只修改 SQ，不调用系统调用，下一次 poll 时一起提交
+ * 注册的事件没有变化时什么都不做，oneshot 还没有重新提交的 channel 在 rearmPending 时使用最新的事件
+ */
+void IoUringPoller::updateChannel(Channel *channel) {
+    int fd = channel->fd();
+    FdState &state = stateOf(fd);
+    checkChannel(channel, channel->index() != kNew);
+    if (channel->index() == kNew) {
+        addChannel(channel);
+        channel->set_index(kAdded);
+        state.channel = channel;
+        state.armed = false;
+        ++state.generation;
+    }
+
+    int events = channel->pollEvents() & ~EPOLLET;
+    if (state.armed && events == state.armedEvents) {
+        return;
+    }
+    disarm(fd, state);
+    if (!state.needRearm) {
+        arm(fd, state);
+    }
+}
+
+void IoUringPoller::removeChannel(Channel *channel) {
+    int fd = channel->fd();
+    if (channel->index() != kNew) {
+        checkChannel(channel, true);
+    }
+    eraseChannel(channel);
+
+    FdState &state = stateOf(fd);
+    if (state.channel == channel) {
+        disarm(fd, state);
+        ++state.generation;
+        state.channel = nullptr;
+    }
+    channel->set_index(kNew);
+}
+
+uint64_t IoUringPoller::numSyscalls() const { return ring_.numEnters(); }
+
+bool IoUringPoller::enableCompletion() {
+    if (bufRing_ != nullptr) {
+        return true;
+    }
+    if (!ring_.valid()) {
+        return false;
+    }
+    size_t ringBytes = kBufferCount * sizeof(io_uring_buf);
+    size_t bufferBytes = kBufferCount * kBufferSize;
+    // MAP_SHARED: fork 之后子进程不会触发 COW，内核和 loop 看到的一直是同一份内存
+    void *ring = ::mmap(nullptr, ringBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    void *buffers = ::mmap(nullptr, bufferBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    int ret = -ENOMEM;
+    if (ring != MAP_FAILED && buffers != MAP_FAILED) {
+        ret = ring_.registerBufferRing(ring, kBufferCount, kBufferGroup);
+    }
+    if (ret < 0) {
+        LOG_ERROR("IoUringPoller::enableCompletion - register buffer ring error: %d", -ret);
+        if (ring != MAP_FAILED) {
+            ::munmap(ring, ringBytes);
+        }
+        if (buffers != MAP_FAILED) {
+            ::munmap(buffers, bufferBytes);
+        }
+        return false;
+    }
+
+    bufRing_ = static_cast<io_uring_buf *>(ring);
+    buffers_ = static_cast<char *>(buffers);
+    for (unsigned i = 0; i < kBufferCount; ++i) {
+        recycleBuffer(static_cast<unsigned short>(i));
+    }
+    __atomic_store_n(&bufRing_[0].resv, bufTail_, __ATOMIC_RELEASE);
+    return true;
+}
+
+//!NOTE: 不能修改 resv，bufRing_[0].resv 就是 tail，dispatchCompletions 最后统一发布
+void IoUringPoller::recycleBuffer(unsigned short bid) {
+    io_uring_buf *buf = &bufRing_[bufTail_ & (kBufferCount - 1)];
+    buf->addr = reinterpret_cast<uint64_t>(buffers_ + static_cast<size_t>(bid) * kBufferSize);
+    buf->len = kBufferSize;
+    buf->bid = bid;
+    ++bufTail_;
+}
+
+io_uring_sqe *IoUringPoller::prepareOp(int fd, const IoUringOpPtr &op) {
+    op->self = op;
+    io_uring_sqe *sqe = ring_.getSqe();
+    if (sqe == nullptr) {
+        // 和真正的完成事件一样在 loop 里回调，调用者不用单独处理
+        LOG_ERROR("IoUringPoller::prepareOp - submission queue full, fd = %d", fd);
+        Completion completion = {op.get(), -EBUSY, 0};
+        completions_.push_back(completion);
+        return nullptr;
+    }
+    sqe->fd = fd;
+    sqe->user_data = reinterpret_cast<uint64_t>(op.get()) | kOpTag;
+    return sqe;
+}
+
+void IoUringPoller::submitRecv(int fd, const IoUringOpPtr &op) {
+    io_uring_sqe *sqe = prepareOp(fd, op);
+    if (sqe != nullptr) {
+        sqe->opcode = IORING_OP_RECV;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufferGroup;
+    }
+}
+
+void IoUringPoller::submitSendmsg(int fd, const struct msghdr *msg, const IoUringOpPtr &op) {
+    io_uring_sqe *sqe = prepareOp(fd, op);
+    if (sqe != nullptr) {
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->addr = reinterpret_cast<uint64_t>(msg);
+        sqe->len = 1;
+        sqe->msg_flags = MSG_NOSIGNAL;
+    }
+}
+
+void IoUringPoller::submitPoll(int fd, int events, const IoUringOpPtr &op) {
+    io_uring_sqe *sqe = prepareOp(fd, op);
+    if (sqe != nullptr) {
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->poll32_events = static_cast<uint32_t>(events);
+    }
+}
+
+void IoUringPoller::submitAccept(int fd, const IoUringOpPtr &op) {
+    io_uring_sqe *sqe = prepareOp(fd, op);
+    if (sqe != nullptr) {
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    }
+}
+
+void IoUringPoller::cancel(const IoUringOpPtr &op) {
+    if (!op || !op->inFlight()) {
+        return;
+    }
+    io_uring_sqe *sqe = ring_.getSqe();
+    if (sqe == nullptr) {
+        // 不取消的话 op 的 keepAlive 一直持有连接，下一次迭代 SQ 提交之后再试
+        LOG_ERROR("IoUringPoller::cancel - submission queue full, retry later");
+        completionChannel_.ownerLoop()->queueInLoop(std::bind(&IoUringPoller::cancel, this, op));
+        return;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(op.get()) | kOpTag;
+    sqe->user_data = kInternalTag;
+}
+
+/**
+ * 分发本次 poll 收集到的完成事件
+ * 最后一个完成事件（没有 IORING_CQE_F_MORE）之后请求结束，释放 self 和 keepAlive，回调里可以马上重新提交
+ */
+void IoUringPoller::dispatchCompletions() {
+    dispatching_.swap(completions_);
+    for (const Completion &completion : dispatching_) {
+        IoUringOp *op = completion.op;
+        const char *data = nullptr;
+        int bid = -1;
+        if (completion.flags & IORING_CQE_F_BUFFER) {
+            bid = static_cast<int>(completion.flags >> IORING_CQE_BUFFER_SHIFT);
+            data = buffers_ + static_cast<size_t>(bid) * kBufferSize;
+        }
+
+        if (completion.flags & IORING_CQE_F_MORE) {
+            op->callback(completion.res, data, completion.flags);
+        } else {
+            IoUringOpPtr self;
+            self.swap(op->self);
+            std::shared_ptr<void> keepAlive;
+            keepAlive.swap(op->keepAlive);
+            op->callback(completion.res, data, completion.flags);
+        }
+
+        if (bid >= 0) {
+            recycleBuffer(static_cast<unsigned short>(bid));  // 数据已经拷贝到 inputBuffer_ 了
+        }
+    }
+    dispatching_.clear();
+    if (bufRing_ != nullptr) {
+        __atomic_store_n(&bufRing_[0].resv, bufTail_, __ATOMIC_RELEASE);
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Channel.h"
+#include "IoUring.h"
+#include "Poller.h"
+#include "Timestamp.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct msghdr;
+
+/**
+ * 完成模式下的一个异步请求（recv / sendmsg / poll / accept），同一时间最多只有一个请求在进行
+ * callback(res, data, flags): res 是 cqe->res，data 是 recv 时内核选中的 provided buffer（否则为 nullptr），
+ * flags 是 cqe->flags，IORING_CQE_F_MORE 表示 multishot 请求还会有后续的完成事件
+ * loop 退出时还在进行的请求不会再有完成事件，它们持有的对象也不会释放
+ */
+struct IoUringOp {
+    using Callback = std::function<void(int res, const char *data, uint32_t flags)>;
+
+    Callback callback;
+    std::shared_ptr<void> keepAlive;   // 请求进行中持有所属的对象（例如 TcpConnection），最后一个完成事件之后释放
+    std::shared_ptr<IoUringOp> self;   // 请求进行中 op 自己也不能析构，由 poller 设置和释放
+
+    bool inFlight() const { return self != nullptr; }
+};
+using IoUringOpPtr = std::shared_ptr<IoUringOp>;
+
+/**
+ * 基于 io_uring 的就绪通知（IORING_OP_POLL_ADD），接口和 EPollPoller 一样
+ *
+ * - Channel::update 不再是一次 epoll_ctl，而是往 SQ 里放一个 POLL_ADD / POLL_REMOVE，
+ *   和下一次 poll 的等待合并成一次 io_uring_enter
+ * - 边缘触发的 channel（Channel::setEdgeTriggered）使用 multishot POLL_ADD，注册一次之后一直有效
+ * - 水平触发的 channel 使用 oneshot POLL_ADD，事件处理完之后下一次 poll 重新提交，
+ *   提交时 fd 仍然就绪会马上完成，和 epoll 的 LT 语义一样
+ *
+ * user_data 是 {generation:31, fd:32}，channel 修改事件或者删除时 generation 加一，旧的完成事件直接丢弃
+ *
+ * 完成模式（enableCompletion 之后，TcpConnection::setCompletionMode 使用）:
+ * - 每个 loop 一个 provided buffer ring，multishot RECV 由内核选缓冲区，空闲连接不占用读缓冲区
+ * - SENDMSG 直接引用 outputBuffer_ 里的分段，multishot ACCEPT 一次提交持续接受新连接
+ * - 完成事件先收集起来，由内部的 completionChannel_ 和普通 channel 一样在 loop 里分发
+ */
+class IoUringPoller : public Poller {
+  public:
+    IoUringPoller(EventLoop *loop);
+    ~IoUringPoller() override;
+
+    // io_uring 不可用时（内核太老、被 seccomp 禁止）返回 false，由 newDefaultPoller 退回 EPollPoller
+    bool valid() const { return ring_.valid(); }
+    int setupErrno() const { return ring_.setupErrno(); }
+
+    Timestamp poll(int timeoutMs, ChannelList *activeChannels) override;
+    void updateChannel(Channel *channel) override;
+    void removeChannel(Channel *channel) override;
+    uint64_t numSyscalls() const override;  // io_uring_enter 的次数
+
+    // 完成模式，第一次调用时注册 provided buffer ring（5.19），失败返回 false，只能在 loop 线程调用
+    bool enableCompletion();
+    bool completionEnabled() const { return bufRing_ != nullptr; }
+
+    void submitRecv(int fd, const IoUringOpPtr &op);                     // multishot RECV，数据在 provided buffer 里
+    void submitSendmsg(int fd, const struct msghdr *msg, const IoUringOpPtr &op);  // msg 在完成之前必须有效
+    void submitPoll(int fd, int events, const IoUringOpPtr &op);         // oneshot POLL_ADD
+    void submitAccept(int fd, const IoUringOpPtr &op);                   // multishot ACCEPT，res 是新连接的 fd
+    void cancel(const IoUringOpPtr &op);  // 取消进行中的请求，之后会收到 -ECANCELED（或者正常结果）的最后一个完成事件
+
+  private:
+    static const unsigned kRingEntries = 1024;
+    static const uint64_t kInternalTag = 1ULL << 63;  // POLL_REMOVE 等内部请求，完成事件忽略
+    static const uint64_t kOpTag = 1ULL << 62;        // 完成模式的请求，低位是 IoUringOp 的地址
+    static const unsigned kBufferCount = 1024;        // provided buffer 的数量，必须是 2 的幂
+    static const unsigned kBufferSize = 16384;
+    static const unsigned short kBufferGroup = 0;
+
+    struct Completion {
+        IoUringOp *op;
+        int res;
+        uint32_t flags;
+    };
+
+    struct FdState {
+        Channel *channel;
+        uint32_t generation;
+        int armedEvents;   // 已经提交的 POLL_ADD 关注的事件
+        bool armed;        // POLL_ADD 是否还有效
+        bool needRearm;    // 在 rearmFds_ 中，下一次 poll 重新提交
+        int revents;       // 本次 poll 收集到的事件
+        bool active;       // 已经在本次的 activeChannels 中
+    };
+
+    FdState &stateOf(int fd);
+    void arm(int fd, FdState &state);
+    void disarm(int fd, FdState &state);
+    void rearmPending();
+    void handleCqe(const io_uring_cqe *cqe, ChannelList *activeChannels);
+
+    io_uring_sqe *prepareOp(int fd, const IoUringOpPtr &op);
+    void dispatchCompletions();
+    void recycleBuffer(unsigned short bid);
+
+    IoUring ring_;
+    std::vector<FdState> states_;  // 以 fd 为下标
+    std::vector<int> rearmFds_;    // oneshot 已经完成（或者 SQ 满了没有提交成功），需要重新提交的 fd
+
+    //!NOTE: 不用 io_uring_buf_ring::bufs，C++ 下 __DECLARE_FLEX_ARRAY 的空结构体占 1 字节，bufs 的偏移变成了 8
+    io_uring_buf *bufRing_;       // 和内核共享的 provided buffer ring，tail 和 bufRing_[0].resv 重叠
+    char *buffers_;               // kBufferCount * kBufferSize
+    unsigned short bufTail_;      // 还没有发布给内核的 tail
+    std::vector<Completion> completions_;  // 本次 poll 收集到的完成事件
+    std::vector<Completion> dispatching_;
+    Channel completionChannel_;   // fd 为 -1，不注册到 poller，有完成事件时放进 activeChannels
+};
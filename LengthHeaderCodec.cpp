@@ -0,0 +1,87 @@
+#define MUDUO_LOG_MODULE kLogModuleTcp
+
+#include "LengthHeaderCodec.h"
+
+#include "Crc32c.h"
+#include "Logger.h"
+#include "TcpConnection.h"
+
+#include <endian.h>
+#include <string.h>
+#include <sys/uio.h>
+
+const size_t LengthHeaderCodec::kDefaultMaxMessageBytes;
+
+LengthHeaderCodec::LengthHeaderCodec(const FrameCallback &cb, bool checksum, size_t maxMessageBytes)
+    : callback_(cb)
+    , checksum_(checksum)
+    , maxMessageBytes_(maxMessageBytes) {}
+
+size_t LengthHeaderCodec::encodeHeader(const char *data, size_t len, char *header) const {
+    uint32_t be = htobe32(static_cast<uint32_t>(len));
+    ::memcpy(header, &be, sizeof be);
+    if (!checksum_) {
+        return sizeof be;
+    }
+    uint32_t crc = htobe32(Crc32c::extend(Crc32c::value(header, sizeof be), data, len));
+    ::memcpy(header + sizeof be, &crc, sizeof crc);
+    return sizeof be + sizeof crc;
+}
+
+void LengthHeaderCodec::onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp receiveTime) {
+    const size_t headerLen = headerBytes();
+    while (buf->readableBytes() >= headerLen) {
+        int32_t len = buf->peekInt32();
+        if (len < 0 || static_cast<size_t>(len) > maxMessageBytes_) {
+            LOG_ERROR("LengthHeaderCodec::onMessage %s - invalid length %d", conn->name().c_str(), len);
+            buf->retrieveAll();
+            conn->forceClose();
+            break;
+        }
+        if (buf->readableBytes() < headerLen + len) {
+            break;  // 半包，等下一次
+        }
+
+        const char *body = buf->peek() + headerLen;
+        if (checksum_) {
+            uint32_t expected;
+            ::memcpy(&expected, buf->peek() + sizeof(int32_t), sizeof expected);
+            uint32_t actual = Crc32c::extend(Crc32c::value(buf->peek(), sizeof(int32_t)), body, len);
+            if (be32toh(expected) != actual) {
+                LOG_ERROR("LengthHeaderCodec::onMessage %s - checksum mismatch, length %d", conn->name().c_str(), len);
+                buf->retrieveAll();
+                conn->forceClose();
+                break;
+            }
+        }
+        callback_(conn, StringPiece(body, len), receiveTime);
+        buf->retrieve(headerLen + len);
+    }
+}
+
+void LengthHeaderCodec::frame(Buffer *message) const {
+    char header[2 * sizeof(int32_t)];
+    size_t headerLen = encodeHeader(message->peek(), message->readableBytes(), header);
+    message->prepend(header, headerLen);
+}
+
+void LengthHeaderCodec::send(const TcpConnectionPtr &conn, Buffer *message) const {
+    frame(message);
+    conn->send(message);
+}
+
+void LengthHeaderCodec::send(const TcpConnectionPtr &conn, const StringPiece &message) const {
+    char header[2 * sizeof(int32_t)];
+    struct iovec iov[2];
+    iov[0].iov_base = header;
+    iov[0].iov_len = encodeHeader(message.data(), message.size(), header);
+    iov[1].iov_base = const_cast<char *>(message.data());
+    iov[1].iov_len = message.size();
+    conn->send(iov, 2);
+}
+
+void LengthHeaderCodec::append(Buffer *output, const StringPiece &message) const {
+    char header[2 * sizeof(int32_t)];
+    output->append(header, encodeHeader(message.data(), message.size(), header));
+    output->append(message.data(), message.size());
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Buffer.h"
+#include "Callbacks.h"
+#include "StringPiece.h"
+#include "Timestamp.h"
+#include "noncopyable.h"
+
+#include <functional>
+
+/**
+ * 长度前缀的分帧：[长度 int32][CRC32C uint32，可选][消息体]，整数都是网络字节序，长度不包括头部
+ * - onMessage 作为 TcpServer / TcpClient 的 MessageCallback，半包留在 inputBuffer_ 里，
+ *   只把完整的消息交给 FrameCallback，消息直接指向 inputBuffer_，不拷贝，只在回调期间有效
+ * - send(conn, Buffer*) 在消息体前面 prepend 头部，用的是 Buffer 的 kCheapPrepend，不用再拼接一个新的 string
+ * - 校验和覆盖长度和消息体，硬件支持时用 SSE4.2 的 crc32 指令，参考 Crc32c
+ * - 长度超过 maxMessageBytes 或者校验和不对时 LOG_ERROR 并 forceClose，数据流已经没法重新对齐
+ * - 除了构造以外没有可变状态，send / frame / append 可以在任意线程调用
+ */
+class LengthHeaderCodec : noncopyable {
+  public:
+    using FrameCallback = std::function<void(const TcpConnectionPtr &, const StringPiece &, Timestamp)>;
+
+    static const size_t kDefaultMaxMessageBytes = 64 * 1024 * 1024;
+
+    explicit LengthHeaderCodec(const FrameCallback &cb,
+                               bool checksum = false,
+                               size_t maxMessageBytes = kDefaultMaxMessageBytes);
+
+    void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp receiveTime);
+
+    // message 里只有消息体，原地 prepend 头部之后整个发送，send 之后 message 为空
+    void send(const TcpConnectionPtr &conn, Buffer *message) const;
+    // 头部放在栈上，和 message 一起 writev，不拷贝 message
+    void send(const TcpConnectionPtr &conn, const StringPiece &message) const;
+
+    // 给 message 原地加上头部，message 的可读数据就是整个消息体
+    void frame(Buffer *message) const;
+    // 把一个完整的帧追加到 output 后面，攒一批消息再一次发送时用
+    void append(Buffer *output, const StringPiece &message) const;
+
+    size_t headerBytes() const { return checksum_ ? 2 * sizeof(int32_t) : sizeof(int32_t); }
+
+  private:
+    // 头部写到 header（至少 8 字节），返回头部的长度
+    size_t encodeHeader(const char *data, size_t len, char *header) const;
+
+    FrameCallback callback_;
+    const bool checksum_;
+    const size_t maxMessageBytes_;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "noncopyable.h"
+
+#include <stdint.h>
+
+#include <atomic>
+
+/**
+ * 固定容量的无锁对象池，任意线程都可以 alloc / free
+ *
+ * 空闲链表是 Treiber 栈，栈顶是 64 位的 {tag:32, index:32}，每次修改 tag 加一，避免 ABA 问题
+ * 池子里的对象只在构造池子时构造一次，alloc / free 不会调用构造和析构函数，调用者自己重置对象的状态
+ * 池子空了就从堆上 new，free 时根据地址判断是不是池子里的对象
+ */
+template <typename T>
+class LockFreePool : noncopyable {
+  public:
+    explicit LockFreePool(uint32_t capacity)
+        : slots_(new Slot[capacity]), capacity_(capacity), top_(pack(0, kNil)), heapAllocs_(0) {
+        for (uint32_t i = capacity; i > 0; --i) {
+            push(i - 1);
+        }
+    }
+
+    ~LockFreePool() { delete[] slots_; }
+
+    T *alloc() {
+        uint64_t top = top_.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t index = indexOf(top);
+            if (index == kNil) {
+                heapAllocs_.fetch_add(1, std::memory_order_relaxed);
+                return new T();
+            }
+            //!NOTE: 这里读到的 next 可能已经过期（其他线程同时 pop 又 push 了），tag 不一样 CAS 会失败
+            uint32_t next = slots_[index].next.load(std::memory_order_relaxed);
+            if (top_.compare_exchange_weak(
+                    top, pack(tagOf(top) + 1, next), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return &slots_[index].obj;
+            }
+        }
+    }
+
+    void free(T *obj) {
+        const char *p = reinterpret_cast<const char *>(obj);
+        const char *begin = reinterpret_cast<const char *>(slots_);
+        const char *end = reinterpret_cast<const char *>(slots_ + capacity_);
+        if (p < begin || p >= end) {
+            delete obj;
+            return;
+        }
+        push(static_cast<uint32_t>((p - begin) / sizeof(Slot)));
+    }
+
+    uint32_t capacity() const { return capacity_; }
+    // 池子空了之后从堆上分配的次数
+    uint64_t heapAllocs() const { return heapAllocs_.load(std::memory_order_relaxed); }
+
+  private:
+    static const uint32_t kNil = 0xffffffff;
+
+    struct Slot {
+        T obj;  // 必须是第一个成员，free 时通过地址算出下标
+        std::atomic<uint32_t> next;
+    };
+
+    static uint64_t pack(uint32_t tag, uint32_t index) { return (static_cast<uint64_t>(tag) << 32) | index; }
+    static uint32_t tagOf(uint64_t top) { return static_cast<uint32_t>(top >> 32); }
+    static uint32_t indexOf(uint64_t top) { return static_cast<uint32_t>(top); }
+
+    void push(uint32_t index) {
+        uint64_t top = top_.load(std::memory_order_relaxed);
+        while (true) {
+            slots_[index].next.store(indexOf(top), std::memory_order_relaxed);
+            if (top_.compare_exchange_weak(
+                    top, pack(tagOf(top) + 1, index), std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    Slot *const slots_;
+    const uint32_t capacity_;
+    std::atomic<uint64_t> top_;
+    std::atomic<uint64_t> heapAllocs_;
+};
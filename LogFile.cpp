@@ -0,0 +1,107 @@
+#include "LogFile.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+LogFile::LogFile(const std::string &basename, off_t rollSize, int flushInterval, int checkEveryN)
+    : basename_(basename)
+    , rollSize_(rollSize)
+    , flushInterval_(flushInterval)
+    , checkEveryN_(checkEveryN)
+    , count_(0)
+    , fp_(nullptr)
+    , writtenBytes_(0)
+    , startOfPeriod_(0)
+    , lastRoll_(0)
+    , lastFlush_(0) {
+    rollFile();
+}
+
+LogFile::~LogFile() {
+    if (fp_ != nullptr) {
+        ::fclose(fp_);
+    }
+}
+
+void LogFile::append(const char *logline, size_t len) {
+    if (fp_ == nullptr) {
+        return;
+    }
+
+    //!NOTE: 只有后台线程写文件，使用不加锁的 fwrite_unlocked
+    size_t written = 0;
+    while (written != len) {
+        size_t n = ::fwrite_unlocked(logline + written, 1, len - written, fp_);
+        if (n == 0) {
+            int err = ferror(fp_);
+            if (err) {
+                fprintf(stderr, "LogFile::append() failed %s\n", strerror(err));
+            }
+            break;
+        }
+        written += n;
+    }
+    writtenBytes_ += written;
+
+    if (writtenBytes_ > rollSize_) {
+        rollFile();
+    } else if (++count_ >= checkEveryN_) {
+        count_ = 0;
+        time_t now = ::time(NULL);
+        time_t thisPeriod = now / kRollPerSeconds * kRollPerSeconds;
+        if (thisPeriod != startOfPeriod_) {
+            rollFile();
+        } else if (now - lastFlush_ > flushInterval_) {
+            lastFlush_ = now;
+            ::fflush(fp_);
+        }
+    }
+}
+
+void LogFile::flush() {
+    if (fp_ != nullptr) {
+        ::fflush(fp_);
+    }
+}
+
+bool LogFile::rollFile() {
+    // 同一秒内不重复滚动，否则文件名会重复
+    time_t now = ::time(NULL);
+    if (now > lastRoll_) {
+        std::string filename = getLogFileName(basename_, now);
+        time_t start = now / kRollPerSeconds * kRollPerSeconds;
+
+        lastRoll_ = now;
+        lastFlush_ = now;
+        startOfPeriod_ = start;
+
+        if (fp_ != nullptr) {
+            ::fclose(fp_);
+        }
+        fp_ = ::fopen(filename.c_str(), "ae");  // 'e' for O_CLOEXEC
+        if (fp_ == nullptr) {
+            fprintf(stderr, "LogFile::rollFile() open %s failed: %d\n", filename.c_str(), errno);
+            return false;
+        }
+        ::setbuffer(fp_, buffer_, sizeof(buffer_));
+        writtenBytes_ = 0;
+        return true;
+    }
+    return false;
+}
+
+std::string LogFile::getLogFileName(const std::string &basename, time_t now) {
+    std::string filename(basename);
+
+    char timebuf[32];
+    struct tm tm;
+    localtime_r(&now, &tm);
+    strftime(timebuf, sizeof(timebuf), ".%Y%m%d-%H%M%S", &tm);
+    filename += timebuf;
+
+    char pidbuf[32];
+    snprintf(pidbuf, sizeof(pidbuf), ".%d.log", ::getpid());
+    filename += pidbuf;
+    return filename;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "noncopyable.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#include <string>
+
+/**
+ * 滚动日志文件，不是线程安全的，只在 AsyncLogging 的后台线程中使用
+ * - 文件大小超过 rollSize 时滚动
+ * - 跨天时滚动
+ * 文件名: basename.YYYYmmdd-HHMMSS.pid.log
+ */
+class LogFile : noncopyable {
+  public:
+    LogFile(const std::string &basename, off_t rollSize, int flushInterval = 3, int checkEveryN = 1024);
+    ~LogFile();
+
+    void append(const char *logline, size_t len);
+    void flush();
+    bool rollFile();
+
+  private:
+    static std::string getLogFileName(const std::string &basename, time_t now);
+
+    const std::string basename_;
+    const off_t rollSize_;
+    const int flushInterval_;
+    const int checkEveryN_;
+
+    int count_;
+    FILE *fp_;
+    off_t writtenBytes_;
+
+    time_t startOfPeriod_;  // 当前文件所在的那一天的 0 点
+    time_t lastRoll_;
+    time_t lastFlush_;
+
+    char buffer_[64 * 1024];  // stdio 缓冲区
+
+    static const int kRollPerSeconds = 60 * 60 * 24;
+};
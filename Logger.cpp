@@ -2,18 +2,60 @@
 
 #include "Timestamp.h"
 
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
 #include <iostream>
 
+namespace {
+
+void defaultOutput(const char *msg, size_t len) {
+    //!NOTE: 一行日志只写一次，避免并发时打印错位
+    std::cout.write(msg, len);
+    std::cout.flush();
+}
+
+void defaultFlush() { std::cout.flush(); }
+
+Logger::OutputFunc g_output = defaultOutput;
+Logger::FlushFunc g_flush = defaultFlush;
+
+// 同一秒内的日志复用格式化好的时间，避免每行都 localtime_r + snprintf
+__thread time_t t_lastSecond = 0;
+__thread char t_time[32];
+__thread size_t t_timeLen = 0;
+
+}  // namespace
+
+std::atomic_int Logger::s_moduleLevels_[kNumLogModules] = {
+    {MUDUO_MIN_LOG_LEVEL},
+    {MUDUO_MIN_LOG_LEVEL},
+    {MUDUO_MIN_LOG_LEVEL},
+};
+
 Logger &Logger::instance() {
     static Logger logger;
     return logger;
 }
 
-void Logger::setLogLevel(int level) { logLevel_ = level; }
+void Logger::setLogLevel(int level) {
+    for (int i = 0; i < kNumLogModules; ++i) {
+        s_moduleLevels_[i].store(level, std::memory_order_relaxed);
+    }
+}
+
+void Logger::setModuleLogLevel(LogModule module, int level) {
+    s_moduleLevels_[module].store(level, std::memory_order_relaxed);
+}
 
-void Logger::log(std::string msg) {
-    std::string pre = "";
-    switch (logLevel_) {
+void Logger::setOutput(OutputFunc out) { g_output = out; }
+
+void Logger::setFlush(FlushFunc flush) { g_flush = flush; }
+
+void Logger::log(int level, const char *fmt, ...) {
+    const char *pre = "";
+    switch (level) {
         case INFO:
             pre = "[INFO] ";
             break;
@@ -29,6 +71,41 @@ void Logger::log(std::string msg) {
         default:
             break;
     }
-    //!NOTE: 将日志打印由两次改为一次，避免并发时打印错位
-    std::cout << pre + Timestamp::now().toString() << ": " << msg << std::endl;
+
+    Timestamp now(Timestamp::now());
+    if (now.secondsSinceEpoch() != t_lastSecond || t_timeLen == 0) {
+        t_lastSecond = now.secondsSinceEpoch();
+        std::string time = now.toString();
+        t_timeLen = time.copy(t_time, sizeof(t_time) - 1);
+    }
+
+    // 前缀 + 时间 + 消息 + 换行拼成一行，直接格式化到一个栈上的 buffer，交给 output 一次写出
+    char line[1152];
+    const size_t kMaxLen = sizeof(line) - 1;  // 留一个字节给换行
+    size_t len = snprintf(line, kMaxLen, "%s%.*s: ", pre, static_cast<int>(t_timeLen), t_time);
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(line + len, kMaxLen - len, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        len += static_cast<size_t>(n) < kMaxLen - len ? n : kMaxLen - len - 1;
+    }
+    line[len++] = '\n';
+    g_output(line, len);
+
+    if (level == FATAL) {
+        g_flush();
+    }
+}
+
+bool LogRateLimiter::allow(int *suppressed) {
+    int64_t now = Timestamp::now().microSecondsSinceEpoch();
+    int64_t next = nextAllowed_.load(std::memory_order_relaxed);
+    if (now >= next && nextAllowed_.compare_exchange_strong(next, now + Timestamp::kMicroSecondsPerSecond)) {
+        *suppressed = suppressed_.exchange(0);
+        return true;
+    }
+    ++suppressed_;
+    return false;
 }
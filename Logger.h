@@ -2,67 +2,118 @@
 
 #include "noncopyable.h"
 
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <atomic>
 #include <string>
 
-// 定义日志级别
+// 定义日志级别，数值越大越重要
 enum LogLevel {
+    DEBUG,  // 调试信息
     INFO,   // 普通信息
     ERROR,  // 错误信息
     FATAL,  // core 信息
-    DEBUG,  // 调试信息
 };
 
+/**
+ * 日志模块，可以按模块单独设置日志级别
+ * .cpp 文件在 include Logger.h 之前 #define MUDUO_LOG_MODULE 指定所属模块，默认是 kLogModuleDefault
+ */
+enum LogModule {
+    kLogModuleDefault,  // 用户代码
+    kLogModuleLoop,     // EventLoop、Channel、Poller、定时器
+    kLogModuleTcp,      // Acceptor、TcpServer、TcpConnection、Socket、Buffer
+    kNumLogModules,
+};
+
+#ifndef MUDUO_LOG_MODULE
+#define MUDUO_LOG_MODULE kLogModuleDefault
+#endif
+
+// 编译期的最低日志级别，低于它的 LOG_* 直接被编译器删掉，默认只有 MUDEBUG 时保留 LOG_DEBUG
+#ifndef MUDUO_MIN_LOG_LEVEL
+#ifdef MUDEBUG
+#define MUDUO_MIN_LOG_LEVEL DEBUG
+#else
+#define MUDUO_MIN_LOG_LEVEL INFO
+#endif
+#endif
+
 // 单例: 输出一个日志类, 默认是 private 继承 noncopyable
 class Logger : noncopyable {
   private:
     Logger(/* args */) {}
-    int logLevel_;
+
+    static std::atomic_int s_moduleLevels_[kNumLogModules];
 
   public:
+    // 日志输出的目的地，默认输出到 std::cout，可以替换成 AsyncLogging::append
+    using OutputFunc = void (*)(const char *msg, size_t len);
+    using FlushFunc = void (*)();
+
     static Logger &instance();  // 获取日志唯一实例对象
 
-    void setLogLevel(int level);  // 设置日志级别
+    // 运行期的最低日志级别，setLogLevel 设置所有模块，setModuleLogLevel 只设置一个模块
+    static void setLogLevel(int level);
+    static void setModuleLogLevel(LogModule module, int level);
+    static int logLevel(LogModule module = kLogModuleDefault) {
+        return s_moduleLevels_[module].load(std::memory_order_relaxed);
+    }
 
-    void log(std::string msg);  // 写日志
+    // LOG_* 在格式化和参数求值之前先检查级别，关闭的日志只有这一次比较
+    static bool isEnabled(int level, LogModule module) {
+        return level >= s_moduleLevels_[module].load(std::memory_order_relaxed);
+    }
+
+    void log(int level, const char *fmt, ...) __attribute__((format(printf, 3, 4)));  // 写日志
+
+    static void setOutput(OutputFunc out);
+    static void setFlush(FlushFunc flush);
 };
 
-#define LOG_INFO(logmsgFormat, ...)                                                                                    \
-    do {                                                                                                               \
-        Logger &logger = Logger::instance();                                                                           \
-        logger.setLogLevel(INFO);                                                                                      \
-        char buf[1024];                                                                                                \
-        snprintf(buf, 1024, logmsgFormat, ##__VA_ARGS__);                                                              \
-        logger.log(buf);\
-    } while (0)
+/**
+ * 调用点级别的限速，热路径上可能刷屏的日志（例如 accept 失败）使用
+ * 每个调用点每秒最多输出一次，期间被抑制的条数附在下一次输出里
+ */
+class LogRateLimiter : noncopyable {
+  public:
+    LogRateLimiter() : nextAllowed_(0), suppressed_(0) {}
+
+    bool allow(int *suppressed);
 
-#define LOG_ERROR(logmsgFormat, ...)                                                                                   \
+  private:
+    std::atomic<int64_t> nextAllowed_;  // 微秒
+    std::atomic_int suppressed_;
+};
+
+#define MUDUO_LOG_IMPL(level, logmsgFormat, ...)                                                                       \
     do {                                                                                                               \
-        Logger &logger = Logger::instance();                                                                           \
-        logger.setLogLevel(ERROR);                                                                                     \
-        char buf[1024];                                                                                                \
-        snprintf(buf, 1024, logmsgFormat, ##__VA_ARGS__);                                                              \
-        logger.log(buf);\
+        if (level >= MUDUO_MIN_LOG_LEVEL && __builtin_expect(Logger::isEnabled(level, MUDUO_LOG_MODULE), 0)) {         \
+            Logger::instance().log(level, logmsgFormat, ##__VA_ARGS__);                                                \
+        }                                                                                                              \
     } while (0)
 
+#define LOG_DEBUG(logmsgFormat, ...) MUDUO_LOG_IMPL(DEBUG, logmsgFormat, ##__VA_ARGS__)
+#define LOG_INFO(logmsgFormat, ...) MUDUO_LOG_IMPL(INFO, logmsgFormat, ##__VA_ARGS__)
+#define LOG_ERROR(logmsgFormat, ...) MUDUO_LOG_IMPL(ERROR, logmsgFormat, ##__VA_ARGS__)
+
+// FATAL 不受级别控制，输出之后直接退出
 #define LOG_FATAL(logmsgFormat, ...)                                                                                   \
     do {                                                                                                               \
-        Logger &logger = Logger::instance();                                                                           \
-        logger.setLogLevel(FATAL);                                                                                     \
-        char buf[1024];                                                                                                \
-        snprintf(buf, 1024, logmsgFormat, ##__VA_ARGS__);                                                              \
-        logger.log(buf);\
+        Logger::instance().log(FATAL, logmsgFormat, ##__VA_ARGS__);                                                    \
         exit(-1);                                                                                                      \
     } while (0)
 
-#ifdef MUDEBUG
-#define LOG_DEBUG(logmsgFormat, ...)                                                                                   \
+// 限速版本，logmsgFormat 必须是字符串字面量
+#define LOG_RATELIMIT(level, logmsgFormat, ...)                                                                        \
     do {                                                                                                               \
-        Logger &logger = Logger::instance();                                                                           \
-        logger.setLogLevel(DEBUG);                                                                                     \
-        char buf[1024];                                                                                                \
-        snprintf(buf, 1024, logmsgFormat, ##__VA_ARGS__);                                                              \
-        logger.log(buf);\
+        if (level >= MUDUO_MIN_LOG_LEVEL && __builtin_expect(Logger::isEnabled(level, MUDUO_LOG_MODULE), 0)) {         \
+            static LogRateLimiter muduoLogRateLimiter;                                                                 \
+            int muduoLogSuppressed = 0;                                                                                \
+            if (muduoLogRateLimiter.allow(&muduoLogSuppressed)) {                                                      \
+                Logger::instance().log(                                                                                \
+                    level, logmsgFormat " (%d suppressed)", ##__VA_ARGS__, muduoLogSuppressed);                        \
+            }                                                                                                          \
+        }                                                                                                              \
     } while (0)
-#else
-#define LOG_DEBUG(logmsgFormat, ...)
-#endif
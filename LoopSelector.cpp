@@ -0,0 +1,118 @@
+#include "LoopSelector.h"
+
+#include "EventLoop.h"
+#include "InetAddress.h"
+
+namespace {
+
+class RoundRobinSelector : public LoopSelector {
+  public:
+    RoundRobinSelector() : next_(0) {}
+
+    EventLoop *select(const std::vector<EventLoop *> &loops, const InetAddress &) override {
+        if (next_ >= loops.size()) {
+            next_ = 0;
+        }
+        return loops[next_++];
+    }
+
+  private:
+    size_t next_;
+};
+
+class LeastConnectionsSelector : public LoopSelector {
+  public:
+    LeastConnectionsSelector() : next_(0) {}
+
+    // 从上一次的下一个开始找，连接数相同时轮询，否则短连接场景下总是选中第一个 loop
+    EventLoop *select(const std::vector<EventLoop *> &loops, const InetAddress &) override {
+        size_t n = loops.size();
+        size_t best = next_ % n;
+        int bestConnections = loops[best]->load().connections;
+        for (size_t i = 1; i < n && bestConnections > 0; ++i) {
+            size_t index = (next_ + i) % n;
+            int connections = loops[index]->load().connections;
+            if (connections < bestConnections) {
+                best = index;
+                bestConnections = connections;
+            }
+        }
+        next_ = best + 1;
+        return loops[best];
+    }
+
+  private:
+    size_t next_;
+};
+
+/**
+ * 综合负载 = 连接数 + 排队的字节数 / kBytesPerConnection + busyRatio * kBusyWeight
+ * 一个忙满的 loop 相当于多了 kBusyWeight 个连接，少数重连接占住一个 loop 时新连接会避开它
+ */
+class PowerOfTwoChoicesSelector : public LoopSelector {
+  public:
+    PowerOfTwoChoicesSelector() : seed_(0x9E3779B97F4A7C15ULL) {}
+
+    EventLoop *select(const std::vector<EventLoop *> &loops, const InetAddress &) override {
+        size_t n = loops.size();
+        if (n == 1) {
+            return loops[0];
+        }
+        size_t first = next() % n;
+        size_t second = (first + 1 + next() % (n - 1)) % n;  // 和 first 不同
+        return cost(loops[second]) < cost(loops[first]) ? loops[second] : loops[first];
+    }
+
+  private:
+    static constexpr double kBytesPerConnection = 64 * 1024;
+    static constexpr double kBusyWeight = 10;
+
+    static double cost(EventLoop *loop) {
+        EventLoop::Load load = loop->load();
+        return load.connections + load.queuedBytes / kBytesPerConnection + load.busyRatio * kBusyWeight;
+    }
+
+    // xorshift64，只在 baseLoop 线程调用
+    uint64_t next() {
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 7;
+        seed_ ^= seed_ << 17;
+        return seed_;
+    }
+
+    uint64_t seed_;
+};
+
+constexpr double PowerOfTwoChoicesSelector::kBytesPerConnection;
+constexpr double PowerOfTwoChoicesSelector::kBusyWeight;
+
+// 只哈希 IP 不哈希端口，同一个客户端的多个连接落在同一个 loop
+class PeerHashSelector : public LoopSelector {
+  public:
+    EventLoop *select(const std::vector<EventLoop *> &loops, const InetAddress &peerAddr) override {
+        // murmur3 的 fmix64，相邻的 IP 也能打散
+        uint64_t hash = peerAddr.getSockAddr()->sin_addr.s_addr;
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 33;
+        hash *= 0xC4CEB9FE1A85EC53ULL;
+        hash ^= hash >> 33;
+        return loops[hash % loops.size()];
+    }
+};
+
+}  // namespace
+
+LoopSelector *LoopSelector::newSelector(Policy policy) {
+    switch (policy) {
+    case kLeastConnections:
+        return new LeastConnectionsSelector;
+    case kPowerOfTwoChoices:
+        return new PowerOfTwoChoicesSelector;
+    case kPeerHash:
+        return new PeerHashSelector;
+    case kRoundRobin:
+    default:
+        return new RoundRobinSelector;
+    }
+}
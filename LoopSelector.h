@@ -0,0 +1,27 @@
+#pragma once
+
+#include "noncopyable.h"
+
+#include <vector>
+
+class EventLoop;
+class InetAddress;
+
+/**
+ * EventLoopThreadPool 给新连接选择 subLoop 的策略，只在 baseLoop 线程调用（Acceptor 的回调）
+ * - kRoundRobin: 轮询，和原来的 getNextLoop 一样
+ * - kLeastConnections: 连接数最少的 loop，连接数相同时轮询
+ * - kPowerOfTwoChoices: 随机取两个 loop，选 EventLoop::Load 综合负载小的，不需要扫描所有 loop
+ * - kPeerHash: 按对端 IP 哈希，同一个客户端的连接总在同一个 loop，缓存亲和，但是不看负载
+ */
+class LoopSelector : noncopyable {
+  public:
+    enum Policy { kRoundRobin, kLeastConnections, kPowerOfTwoChoices, kPeerHash };
+
+    virtual ~LoopSelector() = default;
+
+    // loops 不为空
+    virtual EventLoop *select(const std::vector<EventLoop *> &loops, const InetAddress &peerAddr) = 0;
+
+    static LoopSelector *newSelector(Policy policy);
+};
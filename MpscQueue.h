@@ -0,0 +1,65 @@
+#pragma once
+
+#include "noncopyable.h"
+
+#include <atomic>
+
+/**
+ * 侵入式的无锁多生产者单消费者队列（Dmitry Vyukov 的 MPSC node-based queue）
+ * Node 需要有一个 std::atomic<Node *> next_ 成员，队列本身不分配内存
+ *
+ * - push: 任意线程调用，一次 exchange + 一次 store，不会阻塞
+ * - pop: 只能由一个消费者线程调用，队列为空时返回 nullptr
+ *
+ *!NOTE: 生产者在 exchange 和 store 之间被打断时，消费者可能暂时看到空队列（pop 返回 nullptr），
+ * 调用者需要保证生产者 push 之后会再次唤醒消费者（EventLoop::wakeup）
+ */
+template <typename Node>
+class MpscQueue : noncopyable {
+  public:
+    MpscQueue() : head_(&stub_), tail_(&stub_) { stub_.next_.store(nullptr, std::memory_order_relaxed); }
+
+    void push(Node *node) {
+        node->next_.store(nullptr, std::memory_order_relaxed);
+        Node *prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next_.store(node, std::memory_order_release);
+    }
+
+    Node *pop() {
+        Node *tail = tail_;
+        Node *next = tail->next_.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->next_.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            tail_ = next;
+            return tail;
+        }
+        if (tail != head_.load(std::memory_order_acquire)) {
+            return nullptr;  // 有生产者正在 push
+        }
+        push(&stub_);  // tail 是最后一个节点，放回 stub 之后才能把它取出来
+        next = tail->next_.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            tail_ = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    // 只能在消费者线程调用，可能把正在 push 的节点当成空
+    bool empty() const {
+        return tail_ == &stub_ && stub_.next_.load(std::memory_order_acquire) == nullptr;
+    }
+
+  private:
+    std::atomic<Node *> head_;  // 生产者写入的位置
+    char pad_[64 - sizeof(std::atomic<Node *>)];  // head_ 和 tail_ 分开在不同的 cache line
+    Node *tail_;                // 消费者读取的位置
+    Node stub_;
+};
@@ -2,11 +2,40 @@
 
 #include "Channel.h"
 
-Poller::Poller(EventLoop *loop) : ownerLoop_(loop) {}
+#include <assert.h>
+
+#include <algorithm>
+
+Poller::Poller(EventLoop *loop) : numPolls_(0), numUpdates_(0), ownerLoop_(loop) {}
 
 bool Poller::hasChannel(Channel *channel) const {
-    auto it = channels_.find(channel->fd());
-    return it != channels_.end() && it->second == channel;
+    int fd = channel->fd();
+    return fd >= 0 && static_cast<size_t>(fd) < channels_.size() && channels_[fd] == channel;
+}
+
+void Poller::addChannel(Channel *channel) {
+    size_t fd = static_cast<size_t>(channel->fd());
+    if (fd >= channels_.size()) {
+        channels_.resize(std::max(fd + 1, channels_.size() * 2), nullptr);
+    }
+    channels_[fd] = channel;
+}
+
+void Poller::eraseChannel(Channel *channel) {
+    int fd = channel->fd();
+    if (hasChannel(channel)) {
+        channels_[fd] = nullptr;
+    }
+}
+
+void Poller::checkChannel(Channel *channel, bool added) const {
+#ifndef NDEBUG
+    assert(channel->fd() >= 0);
+    assert(hasChannel(channel) == added);
+#else
+    (void)channel;
+    (void)added;
+#endif
 }
 
 Poller::~Poller() = default;
@@ -3,7 +3,8 @@
 #include "Timestamp.h"
 #include "noncopyable.h"
 
-#include <unordered_map>
+#include <stdint.h>
+
 #include <vector>
 
 class Channel;
@@ -22,17 +23,32 @@ class Poller : noncopyable {
     virtual void updateChannel(Channel *channel) = 0;
     virtual void removeChannel(Channel *channel) = 0;
 
-    // 判断参数 channel 是否在当前的 Poller 当中
+    // 判断参数 channel 是否在当前的 Poller 当中，O(1)
     bool hasChannel(Channel *channel) const;
 
+    // 统计: poll 的次数（epoll_wait）和修改注册事件的次数（epoll_ctl / SQE），只能在 loop 线程读取
+    uint64_t numPolls() const { return numPolls_; }
+    uint64_t numUpdates() const { return numUpdates_; }
+    // poller 自己的系统调用次数，epoll 是 epoll_wait + epoll_ctl
+    virtual uint64_t numSyscalls() const { return numPolls_ + numUpdates_; }
+
     // EventLoop 可以通过该接口获取默认的 IO 复用的具体实现
     //!NOTE: 这里最好不要在 Poller.cpp 中实现，因为这个需要 include EPollPoller，基类包含派生类头文件不太好
-    static Poller *newDefaultPoller(EventLoop *loop);
+    // type 是 EventLoop::PollerType，kDefaultPoller 时由环境变量 MUDUO_USE_IO_URING 决定
+    static Poller *newDefaultPoller(EventLoop *loop, int type);
 
   protected:
-    //!NOTE: int 是 sockfd，Channel* 是 sockfd 所属的通道
-    using ChannelMap = std::unordered_map<int, Channel *>;
-    ChannelMap channels_;
+    void addChannel(Channel *channel);    // channels_[fd] = channel，按需扩容
+    void eraseChannel(Channel *channel);  // channels_[fd] = nullptr
+    // 调试版本检查 channel 的 index 和 channels_ 是否一致，added 是 channel 是否应该在 channels_ 里
+    void checkChannel(Channel *channel, bool added) const;
+
+    //!NOTE: 以 fd 为下标，内核总是分配最小的可用 fd，数组是稠密的，比 unordered_map 少一次哈希和节点分配
+    using ChannelTable = std::vector<Channel *>;
+    ChannelTable channels_;
+
+    uint64_t numPolls_;
+    uint64_t numUpdates_;
 
   private:
     EventLoop *ownerLoop_;  // 定义 Poller 所属的事件循环 EventLoop
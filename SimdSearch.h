@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * 文本协议常用的字节查找，Buffer::findCRLF / findEOL / findByte / splitLines 的实现
+ * - x86 上按 CPU 支持的指令集在运行时选择 AVX2（一次 32 字节）或者 SSE2（一次 16 字节）的实现，其余平台用逐字节的实现
+ * - 每 16/32 字节比较一次，movemask 得到命中的位置，findCRLF 把 '\r' 和错开一个字节的 '\n' 的比较结果相与，
+ *   不像 std::search 那样逐字节回退；findAll 一个块里的所有命中一次取出，行很短时比逐行调用 memchr 省掉大部分调用开销
+ * - findByte 在 x86 上就是 memchr，glibc 自己按 CPU 选择了向量化的实现
+ * - 返回 nullptr 表示没有找到
+ */
+namespace SimdSearch {
+
+enum Level { kScalar, kSse2, kAvx2 };
+
+Level level();  // 当前使用的实现
+// 限制使用的指令集（例如性能测试对比），超过 CPU 支持的按支持的最高级别，返回实际使用的级别，不是线程安全的，在使用之前设置
+Level setLevel(Level level);
+const char *levelName(Level level);
+
+const char *findByte(const char *begin, const char *end, char c);
+const char *findCRLF(const char *begin, const char *end);  // 返回 '\r' 的位置
+
+// [begin, end) 里依次出现的 c 的位置写进 positions，最多 maxPositions 个，返回个数；
+// 返回 maxPositions 时可能还有，从最后一个位置之后继续找
+size_t findAll(const char *begin, const char *end, char c, const char **positions, size_t maxPositions);
+
+}  // namespace SimdSearch
@@ -1,3 +1,5 @@
+#define MUDUO_LOG_MODULE kLogModuleTcp
+
 #include "Socket.h"
 
 #include "InetAddress.h"
@@ -69,4 +71,12 @@ void Socket::setReusePort(bool on) {
 void Socket::setKeepAlive(bool on) {
     int optval = on ? 1 : 0;
     ::setsockopt(sockfd_, SOL_SOCKET, SO_KEEPALIVE, &optval, sizeof(optval));
-}
\ No newline at end of file
+}
+
+void Socket::setSendBufferSize(int bytes) {
+    ::setsockopt(sockfd_, SOL_SOCKET, SO_SNDBUF, &bytes, sizeof(bytes));
+}
+
+bool Socket::setBusyPoll(int usec) {
+    return ::setsockopt(sockfd_, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec)) == 0;
+}
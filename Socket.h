@@ -23,6 +23,8 @@ class Socket : noncopyable {
     void setReuseAddr(bool on);
     void setReusePort(bool on);
     void setKeepAlive(bool on);
+    void setSendBufferSize(int bytes);  // SO_SNDBUF，关闭内核的自动调整
+    bool setBusyPoll(int usec);         // SO_BUSY_POLL，超过 net.core.busy_read 需要 CAP_NET_ADMIN，失败返回 false
 
   private:
     const int sockfd_;
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string.h>
+#include <strings.h>
+
+#include <string>
+
+/**
+ * 指向一段外部字符串的只读视图，不拥有数据，不分配内存（C++11 没有 std::string_view）
+ * 例如 HttpRequest 的 path、header 直接指向 Buffer 里的数据，只在回调期间有效
+ */
+class StringPiece {
+  public:
+    StringPiece() : data_(nullptr), size_(0) {}
+    StringPiece(const char *data, size_t size) : data_(data), size_(size) {}
+    StringPiece(const char *str) : data_(str), size_(str ? ::strlen(str) : 0) {}
+    StringPiece(const std::string &str) : data_(str.data()), size_(str.size()) {}
+
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const char *begin() const { return data_; }
+    const char *end() const { return data_ + size_; }
+    char operator[](size_t i) const { return data_[i]; }
+
+    std::string asString() const { return std::string(data_, size_); }
+
+    bool operator==(const StringPiece &other) const {
+        return size_ == other.size_ && ::memcmp(data_, other.data_, size_) == 0;
+    }
+    bool operator!=(const StringPiece &other) const { return !(*this == other); }
+
+    // HTTP 的 header 名字、Connection 之类的值不区分大小写
+    bool equalsIgnoreCase(const StringPiece &other) const {
+        return size_ == other.size_ && ::strncasecmp(data_, other.data_, size_) == 0;
+    }
+
+  private:
+    const char *data_;
+    size_t size_;
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * 只能移动的 void() 任务，代替 EventLoop 里的 std::function<void()>
+ *
+ * std::function 只有 16 字节的内联空间，std::bind(&TcpConnection::xxx, shared_from_this(), ...) 这类
+ * 成员函数指针 + shared_ptr 的组合基本都会在堆上分配。Task 内联 kInlineSize 字节，库里 runInLoop / queueInLoop
+ * 的调用点都放得下，超过的才在堆上分配。只能移动，所以也不要求被绑定的对象可以拷贝
+ *!NOTE: 和 std::function 不兼容的地方: 不能拷贝，EventLoop::Functor 的左值要 std::move 之后才能传给 runInLoop / queueInLoop，
+ * 也不能再拷贝一份保存起来
+ */
+class Task {
+  public:
+    static const size_t kInlineSize = 64;
+
+    Task() : ops_(nullptr) {}
+    Task(std::nullptr_t) : ops_(nullptr) {}
+
+    template <typename F,
+              typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Task>::value>::type>
+    Task(F &&f) : ops_(nullptr) {
+        typedef typename std::decay<F>::type Fn;
+        init<Fn>(std::forward<F>(f), std::integral_constant<bool, fitsInline<Fn>()>());
+    }
+
+    Task(Task &&other) noexcept : ops_(other.ops_) {
+        if (ops_) {
+            ops_->move(&storage_, &other.storage_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.ops_) {
+                other.ops_->move(&storage_, &other.storage_);
+                ops_ = other.ops_;
+                other.ops_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    ~Task() { reset(); }
+
+    void reset() {
+        if (ops_) {
+            ops_->destroy(&storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    // 和 std::function 一样，空的（或者已经被移走的）Task 调用时抛出 std::bad_function_call
+    void operator()() {
+        if (ops_ == nullptr) {
+            throw std::bad_function_call();
+        }
+        ops_->invoke(&storage_);
+    }
+
+    explicit operator bool() const { return ops_ != nullptr; }
+
+    // 可调用对象是否放在内联空间里，没有堆分配
+    bool isInline() const { return ops_ != nullptr && ops_->isInline; }
+
+  private:
+    typedef std::aligned_storage<kInlineSize, alignof(std::max_align_t)>::type Storage;
+
+    struct Ops {
+        void (*invoke)(void *);
+        void (*move)(void *dst, void *src);  // 移动到 dst 并析构 src
+        void (*destroy)(void *);
+        bool isInline;
+    };
+
+    template <typename Fn>
+    static constexpr bool fitsInline() {
+        return sizeof(Fn) <= kInlineSize && alignof(Fn) <= alignof(Storage) &&
+               std::is_nothrow_move_constructible<Fn>::value;
+    }
+
+    template <typename Fn>
+    struct InlineOps {
+        static void invoke(void *p) { (*static_cast<Fn *>(p))(); }
+        static void move(void *dst, void *src) {
+            new (dst) Fn(std::move(*static_cast<Fn *>(src)));
+            static_cast<Fn *>(src)->~Fn();
+        }
+        static void destroy(void *p) { static_cast<Fn *>(p)->~Fn(); }
+        static const Ops ops;
+    };
+
+    template <typename Fn>
+    struct HeapOps {
+        static void invoke(void *p) { (**static_cast<Fn **>(p))(); }
+        static void move(void *dst, void *src) { *static_cast<Fn **>(dst) = *static_cast<Fn **>(src); }
+        static void destroy(void *p) { delete *static_cast<Fn **>(p); }
+        static const Ops ops;
+    };
+
+    template <typename Fn, typename F>
+    void init(F &&f, std::true_type /* inline */) {
+        new (&storage_) Fn(std::forward<F>(f));
+        ops_ = &InlineOps<Fn>::ops;
+    }
+
+    template <typename Fn, typename F>
+    void init(F &&f, std::false_type /* heap */) {
+        *reinterpret_cast<Fn **>(&storage_) = new Fn(std::forward<F>(f));
+        ops_ = &HeapOps<Fn>::ops;
+    }
+
+    Storage storage_;
+    const Ops *ops_;
+};
+
+template <typename Fn>
+const Task::Ops Task::InlineOps<Fn>::ops = {&InlineOps<Fn>::invoke, &InlineOps<Fn>::move, &InlineOps<Fn>::destroy, true};
+
+template <typename Fn>
+const Task::Ops Task::HeapOps<Fn>::ops = {&HeapOps<Fn>::invoke, &HeapOps<Fn>::move, &HeapOps<Fn>::destroy, false};
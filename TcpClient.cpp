@@ -0,0 +1,134 @@
+#define MUDUO_LOG_MODULE kLogModuleTcp
+
+#include "TcpClient.h"
+
+#include "Buffer.h"
+#include "Logger.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <strings.h>
+#include <sys/socket.h>
+
+static EventLoop *CheckLoopNotNull(EventLoop *loop) {
+    if (loop == nullptr) {
+        LOG_FATAL("TcpClient [static]CheckLoopNotNull - loop is null!");
+    }
+    return loop;
+}
+
+// TcpConnection 直接调用这两个回调，用户没有设置时使用默认的
+static void defaultConnectionCallback(const TcpConnectionPtr &) {}
+
+static void defaultMessageCallback(const TcpConnectionPtr &, Buffer *buf, Timestamp) { buf->retrieveAll(); }
+
+// TcpClient 析构之后连接才关闭，不能再回调 TcpClient::removeConnection
+static void removeDetachedConnection(EventLoop *loop, const TcpConnectionPtr &conn) {
+    loop->queueInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
+}
+
+TcpClient::TcpClient(EventLoop *loop, const InetAddress &serverAddr, const std::string &nameArg)
+    : loop_(CheckLoopNotNull(loop))
+    , connector_(new Connector(loop, serverAddr))
+    , name_(nameArg)
+    , connectionCallback_(defaultConnectionCallback)
+    , messageCallback_(defaultMessageCallback)
+    , retry_(false)
+    , connect_(false)
+    , nextConnId_(1) {
+    connector_->setNewConnectionCallback(std::bind(&TcpClient::newConnection, this, std::placeholders::_1));
+    LOG_INFO("TcpClient::TcpClient[%s] - connector %p", name_.c_str(), connector_.get());
+}
+
+/**
+ *!NOTE: 连接还在时把 closeCallback 换成不依赖 TcpClient 的版本，没有其他人持有连接就强制关闭，
+ * 否则等持有者关闭，连接的生命周期由 shared_ptr 管理
+ */
+TcpClient::~TcpClient() {
+    LOG_INFO("TcpClient::~TcpClient[%s] - connector %p", name_.c_str(), connector_.get());
+    TcpConnectionPtr conn;
+    bool unique = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        unique = connection_.use_count() == 1;
+        conn = connection_;
+    }
+    if (conn) {
+        CloseCallback cb = std::bind(removeDetachedConnection, loop_, std::placeholders::_1);
+        loop_->runInLoop(std::bind(&TcpConnection::setCloseCallback, conn, cb));
+        if (unique) {
+            conn->forceClose();
+        }
+    } else {
+        connector_->stop();
+    }
+}
+
+void TcpClient::connect() {
+    LOG_INFO("TcpClient::connect[%s] - connecting to %s",
+             name_.c_str(),
+             connector_->serverAddress().toIpPort().c_str());
+    connect_ = true;
+    connector_->start();
+}
+
+void TcpClient::disconnect() {
+    connect_ = false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (connection_) {
+        connection_->shutdown();
+    }
+}
+
+void TcpClient::stop() {
+    connect_ = false;
+    connector_->stop();
+}
+
+void TcpClient::newConnection(int sockfd) {
+    sockaddr_in local;
+    sockaddr_in peer;
+    ::bzero(&local, sizeof(local));
+    ::bzero(&peer, sizeof(peer));
+    socklen_t addrLen = sizeof(local);
+    if (::getsockname(sockfd, (sockaddr *)&local, &addrLen) < 0) {
+        LOG_ERROR("TcpClient::newConnection - getsockname error: %d", errno);
+    }
+    addrLen = sizeof(peer);
+    if (::getpeername(sockfd, (sockaddr *)&peer, &addrLen) < 0) {
+        LOG_ERROR("TcpClient::newConnection - getpeername error: %d", errno);
+    }
+    InetAddress localAddr(local);
+    InetAddress peerAddr(peer);
+
+    char buf[64] = {0};
+    snprintf(buf, sizeof(buf), ":%s#%d", peerAddr.toIpPort().c_str(), nextConnId_++);
+    std::string connName = name_ + buf;
+
+    TcpConnectionPtr conn(new TcpConnection(loop_, connName, sockfd, localAddr, peerAddr));
+    conn->setConnectionCallback(connectionCallback_);
+    conn->setMessageCallback(messageCallback_);
+    conn->setWriteCompleteCallback(writeCompleteCallback_);
+    conn->setCloseCallback(std::bind(&TcpClient::removeConnection, this, std::placeholders::_1));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connection_ = conn;
+    }
+    conn->connectEstablished();
+}
+
+// 连接断开，在 loop 线程中调用；开启重试并且用户没有 disconnect 时重新连接
+void TcpClient::removeConnection(const TcpConnectionPtr &conn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connection_.reset();
+    }
+
+    loop_->queueInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
+    if (retry_ && connect_) {
+        LOG_INFO("TcpClient::removeConnection[%s] - reconnecting to %s",
+                 name_.c_str(),
+                 connector_->serverAddress().toIpPort().c_str());
+        connector_->restart();
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+/**
+ * 用户使用 muduo 编写客户端程序，和 TcpServer 对应
+ */
+#include "Callbacks.h"
+#include "Connector.h"
+#include "EventLoop.h"
+#include "InetAddress.h"
+#include "TcpConnection.h"
+#include "noncopyable.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+/**
+ * 一个 TcpClient 最多一个连接，运行在构造时指定的 loop 上，可以是任意 EventLoop（包括 TcpServer 的 subLoop）
+ * - Connector 负责非阻塞 connect 以及失败之后的指数退避重试
+ * - enableRetry 之后连接断开会自动重新连接，否则断开之后需要再次 connect
+ * - 析构时如果连接还在会强制关闭，必须在 loop 线程析构，或者 loop 已经停止
+ */
+class TcpClient : noncopyable {
+  public:
+    TcpClient(EventLoop *loop, const InetAddress &serverAddr, const std::string &nameArg);
+    ~TcpClient();
+
+    void connect();     // 开始连接，可以在任意线程调用
+    void disconnect();  // 关闭已经建立的连接（等 outputBuffer 发送完）
+    void stop();        // 停止正在进行的连接和重试
+
+    EventLoop *getLoop() const { return loop_; }
+    const std::string &name() const { return name_; }
+
+    // 当前的连接，没有连接时为空，可以在任意线程调用
+    TcpConnectionPtr connection() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return connection_;
+    }
+
+    bool retry() const { return retry_; }
+    void enableRetry() { retry_ = true; }
+
+    // 连接失败重试的退避区间，参考 Connector::setRetryDelay，必须在 connect 之前设置
+    void setRetryDelay(int initMs, int maxMs) { connector_->setRetryDelay(initMs, maxMs); }
+
+    // 下面的回调都不是线程安全的，必须在 connect 之前设置
+    void setConnectionCallback(const ConnectionCallback &cb) { connectionCallback_ = cb; }
+    void setMessageCallback(const MessageCallback &cb) { messageCallback_ = cb; }
+    void setWriteCompleteCallback(const WriteCompleteCallback &cb) { writeCompleteCallback_ = cb; }
+
+  private:
+    void newConnection(int sockfd);  // Connector 连接成功的回调，在 loop 线程中调用
+    void removeConnection(const TcpConnectionPtr &conn);
+
+    EventLoop *loop_;
+    ConnectorPtr connector_;
+    const std::string name_;
+
+    ConnectionCallback connectionCallback_;
+    MessageCallback messageCallback_;
+    WriteCompleteCallback writeCompleteCallback_;
+
+    std::atomic_bool retry_;
+    std::atomic_bool connect_;
+    int nextConnId_;  // 只在 loop 线程中访问
+
+    mutable std::mutex mutex_;
+    TcpConnectionPtr connection_;  // 受 mutex_ 保护，其他线程可以通过 connection() 获取
+};
@@ -1,17 +1,76 @@
+#define MUDUO_LOG_MODULE kLogModuleTcp
+
 #include "TcpConnection.h"
 
 #include "Channel.h"
 #include "EventLoop.h"
+#include "IoUringPoller.h"
 #include "Logger.h"
 #include "Socket.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <netinet/tcp.h>
+#include <sys/epoll.h>
 #include <strings.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+
+const size_t TcpConnection::kEdgeTriggeredBudget;
+const size_t TcpConnection::kForwardHighWater;
+
+// 非阻塞的 pipe，容量调整到 kForwardHighWater（超过 /proc/sys/fs/pipe-max-size 时保持默认的 64K）
+struct TcpConnection::ForwardPipe {
+    int fds[2];
+    size_t capacity;
+
+    ForwardPipe() : capacity(0) {
+        if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0) {
+            fds[0] = fds[1] = -1;
+            return;
+        }
+        ::fcntl(fds[1], F_SETPIPE_SZ, static_cast<int>(kForwardHighWater));
+        int size = ::fcntl(fds[1], F_GETPIPE_SZ);
+        capacity = size > 0 ? static_cast<size_t>(size) : 64 * 1024;
+    }
+
+    // 丢掉 pipe 最前面的 len 个字节，peer 已经发不出去了，pipe 里的数据要和排队的 pipe 分段保持一致
+    void discard(size_t len) {
+        char buf[16 * 1024];
+        while (len > 0) {
+            ssize_t n = ::read(fds[0], buf, std::min(len, sizeof buf));
+            if (n <= 0) {
+                break;
+            }
+            len -= n;
+        }
+    }
+
+    ~ForwardPipe() {
+        if (fds[0] >= 0) {
+            ::close(fds[0]);
+            ::close(fds[1]);
+        }
+    }
+};
+
+struct TcpConnection::UringState {
+    static const int kMaxIov = 16;  // 一次 SENDMSG 最多的分段数，每个连接都有一份，不要太大
+
+    IoUringPoller *poller;
+    IoUringOpPtr recvOp;
+    IoUringOpPtr sendOp;
+    IoUringOpPtr writableOp;  // 文件分段 sendfile 写不动时等待可写，第一次用到时才创建
+    struct msghdr msg;
+    struct iovec iov[kMaxIov];
+    bool sending;
+};
+
 static EventLoop *CheckLoopNotNull(EventLoop *loop) {
     if (loop == nullptr) {
         LOG_FATAL("TcpConnection [static]CheckLoopNotNull - Loop is null!");
@@ -32,7 +91,14 @@ TcpConnection::TcpConnection(EventLoop *loop,
     , channel_(new Channel(loop, sockfd))
     , localAddr_(localAddr)
     , peerAddr_(peerAddr)
-    , highWaterMark_(64 * 1024 * 1024) {
+    , highWaterMark_(64 * 1024 * 1024)
+    , readBudget_(0)
+    , reportedQueued_(0)
+    , flushQueued_(false)
+    , completionMode_(false)
+    , forwarding_(false)
+    , forwardPaused_(false)
+    , forwardReadDone_(false) {
     //!NOTE: 和 acceptChannel 区分开，那个是 listenfd 只关心 setReadCallback，这个 channel 是 connfd 需要关心读写关闭以及错误
     // 下面给 channel_ 设置相应的回调函数，poller 给 channel 通知感兴趣的事件发生了，channel 会回调相应的操作函数
     channel_->setReadCallback(std::bind(&TcpConnection::handleRead, this, std::placeholders::_1));
@@ -40,6 +106,8 @@ TcpConnection::TcpConnection(EventLoop *loop,
     channel_->setCloseCallback(std::bind(&TcpConnection::handleClose, this));
     channel_->setErrorCallback(std::bind(&TcpConnection::handleClose, this));
 
+    idleEntry_.setOwner(this, &TcpConnection::onIdleExpired);
+
     LOG_INFO("TcpConnection::ctor[%s] at fd=%d", name_.c_str(), (int)state_);
     socket_->setKeepAlive(true);
 }
@@ -48,70 +116,365 @@ TcpConnection::~TcpConnection() {
     LOG_INFO("TcpConnection::dtor[%s] at fd=%d state=%d", name_.c_str(), channel_->fd(), (int)state_);
 }
 
-// 发送数据
-void TcpConnection::send(std::string &buf) {
+/**
+ * 发送数据，可以跨线程调用
+ * 跨线程时 loop 执行之前调用者的数据可能已经被释放了，payload 会被移动（或者拷贝一次）到 staged_ 里，
+ * 同一个 loop 迭代里 worker 的多次 send 只 queueInLoop 一次，由 flushStagedInLoop 合并成一次 writev
+ */
+void TcpConnection::send(const std::string &buf) { send(buf.data(), buf.size()); }
+
+void TcpConnection::send(std::string &&buf) {
+    if (state_ == kConnected) {
+        if (loop_->isInLoopThread()) {
+            sendOwnedInLoop(std::move(buf));
+        } else {
+            bool needFlush = false;
+            {
+                std::lock_guard<std::mutex> lock(stagedMutex_);
+                staged_.append(std::move(buf));  // 大块数据直接接管，不拷贝
+                needFlush = !flushQueued_;
+                flushQueued_ = true;
+            }
+            if (needFlush) {
+                queueFlush();
+            }
+        }
+    }
+}
+
+void TcpConnection::send(const void *data, size_t len) {
     if (state_ == kConnected) {
         if (loop_->isInLoopThread()) {
-            sendInLoop(buf.c_str(), buf.size());
+            sendInLoop(data, len);
         } else {
-            loop_->runInLoop(std::bind(&TcpConnection::sendInLoop, this, buf.c_str(), buf.size()));
+            bool needFlush = false;
+            {
+                std::lock_guard<std::mutex> lock(stagedMutex_);
+                staged_.append(static_cast<const char *>(data), len);
+                needFlush = !flushQueued_;
+                flushQueued_ = true;
+            }
+            if (needFlush) {
+                queueFlush();
+            }
         }
     }
 }
 
-/**
- * 发送数据，应用写的快，而内核发送数据慢，需要把发送数据写入缓冲区，而且设置了水位回调
- */
-void TcpConnection::sendInLoop(const void *data, size_t len) {
-    ssize_t nwrote = 0;
-    size_t remaining = len;
-    bool faultError = false;
+// 发送 buf 中所有可读的数据，并且 retrieve
+void TcpConnection::send(Buffer *buf) {
+    send(buf->peek(), buf->readableBytes());
+    buf->retrieveAll();
+}
 
-    // 之前调用过该 connection 的 shutdown，不能再进行发送了
-    if (state_ == kDisconnected) {
-        LOG_ERROR("TcpConnection::sendInLoop - disconnected, give up writing!");
+void TcpConnection::send(const struct iovec *iov, int iovcnt) {
+    if (state_ == kConnected) {
+        if (loop_->isInLoopThread()) {
+            sendvInLoop(iov, iovcnt);
+        } else {
+            bool needFlush = false;
+            {
+                std::lock_guard<std::mutex> lock(stagedMutex_);
+                for (int i = 0; i < iovcnt; ++i) {
+                    staged_.append(static_cast<const char *>(iov[i].iov_base), iov[i].iov_len);
+                }
+                needFlush = !flushQueued_;
+                flushQueued_ = true;
+            }
+            if (needFlush) {
+                queueFlush();
+            }
+        }
+    }
+}
+
+void TcpConnection::send(const std::shared_ptr<const std::string> &payload) {
+    if (state_ == kConnected) {
+        if (loop_->isInLoopThread()) {
+            sendSharedInLoop(payload);
+        } else {
+            bool needFlush = false;
+            {
+                std::lock_guard<std::mutex> lock(stagedMutex_);
+                staged_.append(payload);
+                needFlush = !flushQueued_;
+                flushQueued_ = true;
+            }
+            if (needFlush) {
+                queueFlush();
+            }
+        }
+    }
+}
+
+void TcpConnection::sendFile(int fd, off_t offset, size_t length) {
+    sendFile(fd, offset, length, std::shared_ptr<const void>());
+}
+
+void TcpConnection::sendFile(const CachedFilePtr &file, off_t offset, size_t length) {
+    if (!file) {
+        LOG_ERROR("TcpConnection::sendFile - null file, FileCache::open failed?");
         return;
     }
+    sendFile(file->fd(), offset, length, file);
+}
 
-    // 表示 channel 第一次开始写数据，而且缓冲区没有发送数据
-    if (!channel_->isWriting() && outputBuffer_.readableBytes() == 0) {
-        nwrote = ::write(channel_->fd(), data, len);
-        if (nwrote >= 0) {
-            remaining = len - nwrote;
-            if (remaining == 0 && writeCompleteCallback_) {
-                // 既然这里数据全部发送完成，就不用再给 channel 设置 epollout 事件
-                loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+void TcpConnection::sendFile(int fd, off_t offset, size_t length, const std::shared_ptr<const void> &owner) {
+    if (state_ == kConnected) {
+        if (loop_->isInLoopThread()) {
+            sendFileInLoop(fd, offset, length, owner);
+        } else {
+            //!NOTE: 文件也放到 staged_ 里，保证和前面跨线程 send 的数据的顺序
+            bool needFlush = false;
+            {
+                std::lock_guard<std::mutex> lock(stagedMutex_);
+                staged_.appendFile(fd, offset, length, owner);
+                needFlush = !flushQueued_;
+                flushQueued_ = true;
             }
-        } else {  // nwrote < 0
-            nwrote = 0;
-            if (errno != EWOULDBLOCK) {
-                LOG_ERROR("TcpConnection::sendInLoop - errno = %d", errno);
-                if (errno == EPIPE || errno == ECONNRESET)  // SIGPIPE | RESET
-                {
-                    faultError = true;
+            if (needFlush) {
+                queueFlush();
+            }
+        }
+    }
+}
+
+void TcpConnection::queueFlush() {
+    loop_->queueInLoop(std::bind(&TcpConnection::flushStagedInLoop, shared_from_this()));
+}
+
+// 把 worker 线程 staged 的所有数据接到 outputBuffer_ 后面，一次 writev（或 sendfile）发送
+void TcpConnection::flushStagedInLoop() {
+    BufferChain staged;
+    {
+        std::lock_guard<std::mutex> lock(stagedMutex_);
+        staged.swap(staged_);
+        flushQueued_ = false;
+    }
+
+    if (state_ == kDisconnected) {
+        LOG_ERROR("TcpConnection::flushStagedInLoop - disconnected, give up writing!");
+        return;
+    }
+
+    size_t oldLen = outputBuffer_.readableBytes();
+    outputBuffer_.append(std::move(staged));
+
+    int savedErrno = 0;
+    if (!uring_ && !channel_->isWriting() && oldLen == 0) {
+        ssize_t n = outputBuffer_.writeFd(channel_->fd(), &savedErrno);
+        if (n > 0) {
+            outputBuffer_.retrieve(n);
+            if (outputBuffer_.readableBytes() == 0) {
+                if (writeCompleteCallback_) {
+                    loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
                 }
+                return;
+            }
+        } else if (savedErrno == EIO) {
+            LOG_ERROR("TcpConnection::flushStagedInLoop - [%s] file truncated while sending", name_.c_str());
+            forceCloseInLoop();
+            return;
+        } else if (savedErrno != EWOULDBLOCK) {
+            LOG_ERROR("TcpConnection::flushStagedInLoop - errno = %d", savedErrno);
+            if (savedErrno == EPIPE || savedErrno == ECONNRESET) {
+                outputBuffer_.retrieveAll();
+                return;
             }
         }
     }
+    // writeFd 停在文件 / pipe 分段前面时没有 EAGAIN，socket 还是可写的
+    afterAppendOutput(oldLen, savedErrno == EAGAIN || savedErrno == EWOULDBLOCK);
+}
+
+void TcpConnection::sendInLoop(const void *data, size_t len) {
+    struct iovec vec;
+    vec.iov_base = const_cast<void *>(data);
+    vec.iov_len = len;
+    sendvInLoop(&vec, 1);
+}
+
+/**
+ * 发送数据，应用写的快，而内核发送数据慢，需要把发送数据写入缓冲区，而且设置了水位回调
+ */
+void TcpConnection::sendvInLoop(const struct iovec *iov, int iovcnt) {
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        total += iov[i].iov_len;
+    }
+
+    size_t nwrote = 0;
+    bool blocked = false;
+    if (!trySendDirectly(iov, iovcnt, total, &nwrote, &blocked)) {
+        return;
+    }
 
     /**
      * 说明当前这一次 write 并没有把数据全部发送出去，剩余的数据需要保存到缓冲区中，然后给 channel
      * 注册 epollout 事件，poller 发送 tcp 的发送缓冲区有空间，会通知相应的 sock-channel 调用 writeCallback
      * 也就是调用 TcpConnection::handleWrite 方法，把发送缓冲区的数据全部发送完成
      */
-    if (!faultError && remaining > 0) {
-        // 目前发送缓冲区剩余的待发送数据的长度
+    if (nwrote < total) {
         size_t oldLen = outputBuffer_.readableBytes();
-        if (oldLen + remaining >= highWaterMark_ && oldLen < highWaterMark_ && highWaterMarkCallback_) {
-            loop_->queueInLoop(std::bind(highWaterMarkCallback_, shared_from_this(), oldLen + remaining));
+        for (int i = 0; i < iovcnt; ++i) {
+            size_t len = iov[i].iov_len;
+            if (nwrote >= len) {  // 这一段已经直接发出去了
+                nwrote -= len;
+                continue;
+            }
+            outputBuffer_.append(static_cast<const char *>(iov[i].iov_base) + nwrote, len - nwrote);
+            nwrote = 0;
         }
-        outputBuffer_.append(static_cast<const char *>(data) + nwrote, remaining);
+        afterAppendOutput(oldLen, blocked);
+    }
+}
+
+// 调用者交出了 payload 的所有权，没有发送完的部分只引用，不拷贝
+void TcpConnection::sendSharedInLoop(const std::shared_ptr<const std::string> &payload) {
+    struct iovec vec;
+    vec.iov_base = const_cast<char *>(payload->data());
+    vec.iov_len = payload->size();
+
+    size_t nwrote = 0;
+    bool blocked = false;
+    if (!trySendDirectly(&vec, 1, vec.iov_len, &nwrote, &blocked)) {
+        return;
+    }
+
+    if (nwrote < vec.iov_len) {
+        size_t oldLen = outputBuffer_.readableBytes();
+        outputBuffer_.append(payload, nwrote);
+        afterAppendOutput(oldLen, blocked);
+    }
+}
+
+//!NOTE: outputBuffer_ 为空时直接 sendfile，剩下的部分作为文件分段排在 outputBuffer_ 后面，由 handleWrite 继续发送
+void TcpConnection::sendFileInLoop(int fd, off_t offset, size_t length, const std::shared_ptr<const void> &owner) {
+    if (state_ == kDisconnected) {
+        LOG_ERROR("TcpConnection::sendFileInLoop - disconnected, give up writing!");
+        return;
+    }
 
+    size_t nwrote = 0;
+    bool blocked = false;
+    if (!uring_ && !channel_->isWriting() && outputBuffer_.readableBytes() == 0) {
+        off_t fileOffset = offset;
+        ssize_t n = length > 0 ? ::sendfile(channel_->fd(), fd, &fileOffset, length) : 0;
+        if (n > 0 || length == 0) {
+            nwrote = n;
+            blocked = nwrote < length;
+            if (nwrote == length && writeCompleteCallback_) {
+                loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+            }
+        } else if (n == 0) {
+            LOG_ERROR("TcpConnection::sendFileInLoop - fd = %d shorter than offset + length", fd);
+            forceCloseInLoop();  // 和 handleWrite 一样，对端已经等不到完整的数据了
+            return;
+        } else if (errno != EWOULDBLOCK) {
+            LOG_ERROR("TcpConnection::sendFileInLoop - errno = %d", errno);
+            return;
+        } else {
+            blocked = true;
+        }
+    }
+
+    if (nwrote < length) {
+        size_t oldLen = outputBuffer_.readableBytes();
+        outputBuffer_.appendFile(fd, offset + static_cast<off_t>(nwrote), length - nwrote, owner);
+        afterAppendOutput(oldLen, blocked);
+    }
+}
+
+// 调用者把 payload 交给了 outputBuffer_，没有发送完的大块数据直接接管
+void TcpConnection::sendOwnedInLoop(std::string &&payload) {
+    struct iovec vec;
+    vec.iov_base = const_cast<char *>(payload.data());
+    vec.iov_len = payload.size();
+
+    size_t nwrote = 0;
+    bool blocked = false;
+    if (!trySendDirectly(&vec, 1, vec.iov_len, &nwrote, &blocked)) {
+        return;
+    }
+
+    if (nwrote < vec.iov_len) {
+        size_t oldLen = outputBuffer_.readableBytes();
+        outputBuffer_.append(std::move(payload), nwrote);
+        afterAppendOutput(oldLen, blocked);
+    }
+}
+
+bool TcpConnection::trySendDirectly(const struct iovec *iov, int iovcnt, size_t total, size_t *nwrote, bool *blocked) {
+    *nwrote = 0;
+    *blocked = false;
+
+    // 之前调用过该 connection 的 shutdown，不能再进行发送了
+    if (state_ == kDisconnected) {
+        LOG_ERROR("TcpConnection::sendInLoop - disconnected, give up writing!");
+        return false;
+    }
+
+    // 表示 channel 第一次开始写数据，而且缓冲区没有发送数据，完成模式下全部追加到 outputBuffer_ 由 SENDMSG 发送
+    if (!uring_ && !channel_->isWriting() && outputBuffer_.readableBytes() == 0) {
+        int count = std::min(iovcnt, IOV_MAX);
+        ssize_t n = ::writev(channel_->fd(), iov, count);
+        if (n >= 0) {
+            *nwrote = n;
+            size_t attempted = total;
+            if (count < iovcnt) {  // 超过 IOV_MAX 的部分这次没有写
+                attempted = 0;
+                for (int i = 0; i < count; ++i) {
+                    attempted += iov[i].iov_len;
+                }
+            }
+            *blocked = *nwrote < attempted;
+            if (*nwrote == total && writeCompleteCallback_) {
+                // 既然这里数据全部发送完成，就不用再给 channel 设置 epollout 事件
+                loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+            }
+        } else if (errno != EWOULDBLOCK) {
+            LOG_ERROR("TcpConnection::sendInLoop - errno = %d", errno);
+            if (errno == EPIPE || errno == ECONNRESET)  // SIGPIPE | RESET
+            {
+                return false;
+            }
+        } else {
+            *blocked = true;
+        }
+    }
+    return true;
+}
+
+void TcpConnection::afterAppendOutput(size_t oldLen, bool blocked) {
+    // 目前发送缓冲区剩余的待发送数据的长度
+    size_t newLen = outputBuffer_.readableBytes();
+    if (newLen >= highWaterMark_ && oldLen < highWaterMark_ && highWaterMarkCallback_) {
+        loop_->queueInLoop(std::bind(highWaterMarkCallback_, shared_from_this(), newLen));
+    }
+
+    if (uring_) {
+        if (!uring_->sending) {
+            startSend();
+        }
+    } else if (!channel_->isWriting()) {
         //!NOTE: 这里一定要注册 channel 的写事件，否则 poller 不会给 channel 通知 epollout
-        if (!channel_->isWriting()) {
-            channel_->enableWriting();
+        channel_->enableWriting();
+        // ET 模式一直注册着 EPOLLOUT，enableWriting 不调用 epoll_ctl，socket 没有写满就不会再有新的 EPOLLOUT 边沿，
+        // 和 handleWrite 一样下一次迭代直接调用 handleWrite
+        if (channel_->edgeTriggered() && !blocked) {
+            channel_->keepReady(EPOLLOUT);
         }
     }
+    syncQueuedBytes();
+}
+
+// 只在追加和发送之后同步，直接写完或者出错丢弃的数据等下一次同步或者 connectDestroyed 时修正
+void TcpConnection::syncQueuedBytes() {
+    int64_t queued = static_cast<int64_t>(outputBuffer_.readableBytes());
+    if (queued != reportedQueued_) {
+        loop_->addQueuedBytes(queued - reportedQueued_);
+        reportedQueued_ = queued;
+    }
 }
 
 // 关闭连接
@@ -124,18 +487,236 @@ void TcpConnection::shutdown() {
 
 //!NOTE: shutdown 过程有 channel_ 还没有写完，直到 readableBytes() == 0，和 handleWrite() 关联
 void TcpConnection::shutdownInLoop() {
-    if (!channel_->isWriting()) // 说明 outputBuffer 中的数据已经全部发送完成
+    if (!isSending()) // 说明 outputBuffer 中的数据已经全部发送完成
     { 
         socket_->shutdownWrite(); // 关闭写端，EPOLLHUP 自动注册
+        if (forwardReadDone_) {
+            handleClose();  // 代理模式两个方向都结束了
+        }
+    }
+}
+
+// 强制关闭连接，例如空闲超时
+void TcpConnection::forceClose() {
+    if (state_ == kConnected || state_ == kDisconnecting) {
+        setState(kDisconnecting);
+        loop_->queueInLoop(std::bind(&TcpConnection::forceCloseInLoop, shared_from_this()));
+    }
+}
+
+void TcpConnection::forceCloseInLoop() {
+    if (state_ == kConnected || state_ == kDisconnecting) {
+        handleClose();  // 和对端关闭一样处理
+    }
+}
+
+//!NOTE: 在 IdleWheel::advance 中批量调用，此时连接还被 TcpServer::connections_ 持有
+void TcpConnection::onIdleExpired(IdleEntry *entry) {
+    TcpConnection *conn = static_cast<TcpConnection *>(entry->owner());
+    LOG_INFO("TcpConnection::onIdleExpired - [%s] idle timeout, force close", conn->name().c_str());
+    conn->forceCloseInLoop();
+}
+
+void TcpConnection::setSendBufferSize(int bytes) { socket_->setSendBufferSize(bytes); }
+
+void TcpConnection::setEdgeTriggered(bool on) { channel_->setEdgeTriggered(on); }
+
+bool TcpConnection::forwardTo(const TcpConnectionPtr &peer, bool useSplice) {
+    if (peer->getLoop() != loop_) {
+        LOG_ERROR("TcpConnection::forwardTo - [%s] and [%s] are not in the same loop", name_.c_str(), peer->name().c_str());
+        return false;
+    }
+    if (uring_) {
+        LOG_ERROR("TcpConnection::forwardTo - [%s] completion mode is not supported", name_.c_str());
+        return false;
+    }
+    forwarding_ = true;
+    forwardTarget_ = peer;
+    peer->forwardSource_ = shared_from_this();
+    if (useSplice) {
+        std::shared_ptr<ForwardPipe> pipe(new ForwardPipe);
+        if (pipe->fds[0] >= 0) {
+            forwardPipe_ = pipe;
+        } else {
+            LOG_ERROR("TcpConnection::forwardTo - [%s] pipe2 error: %d, copy through inputBuffer_", name_.c_str(), errno);
+        }
+    }
+
+    if (inputBuffer_.readableBytes() > 0) {
+        peer->sendInLoop(inputBuffer_.peek(), inputBuffer_.readableBytes());
+        inputBuffer_.retrieveAll();
+    }
+    if (channel_->edgeTriggered() && state_ == kConnected) {
+        channel_->keepReady(EPOLLIN);  // socket 里可能还有没读完的数据，ET 模式不会再通知
+    }
+    return true;
+}
+
+size_t TcpConnection::forwardHighWater() const { return forwardPipe_ ? forwardPipe_->capacity : kForwardHighWater; }
+
+/**
+ * 代理模式的可读事件，每次最多转发 edgeTriggeredBudget 字节
+ *!NOTE: 每次 splice 不超过 pipe 的剩余容量，但 pipe 按页（slot）计数，小包也占一整页，pipe 可能先满；
+ * splice 返回 EAGAIN 时 target 还有没发完的数据就当作 pipe 满了，停止读，否则 LT 模式下 EPOLLIN 会一直触发
+ */
+void TcpConnection::handleForwardRead() {
+    if (forwardPaused_ || forwardReadDone_) {
+        return;  // 暂停或者 EOF 之前 keepReady 的事件
+    }
+    TcpConnectionPtr target = forwardTarget_.lock();
+    if (!target || target->state_ == kDisconnected) {
+        handleClose();  // 数据已经没有地方可以转发了
+        return;
+    }
+
+    size_t budget = edgeTriggeredBudget();
+    size_t total = 0;
+    int savedErrno = 0;
+    ssize_t n = 0;
+    while (total < budget) {
+        size_t queued = target->outputBuffer_.readableBytes();
+        if (queued >= forwardHighWater()) {
+            pauseForwardRead();
+            break;
+        }
+        if (forwardPipe_) {
+            n = ::splice(channel_->fd(),
+                         nullptr,
+                         forwardPipe_->fds[1],
+                         nullptr,
+                         forwardHighWater() - queued,
+                         SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (n > 0) {
+                target->sendPipedInLoop(forwardPipe_, n);
+            } else if (n < 0) {
+                savedErrno = errno;
+                if (savedErrno == EINVAL) {
+                    LOG_ERROR("TcpConnection::handleForwardRead - [%s] splice is not supported, copy through inputBuffer_",
+                              name_.c_str());
+                    forwardPipe_.reset();
+                    continue;
+                }
+            }
+        } else {
+            n = inputBuffer_.readFd(channel_->fd(), &savedErrno);
+            if (n > 0) {
+                target->sendInLoop(inputBuffer_.peek(), inputBuffer_.readableBytes());
+                inputBuffer_.retrieveAll();
+            }
+        }
+        if (n <= 0) {
+            break;
+        }
+        total += n;
+    }
+
+    if (total > 0 && idleWheel_) {
+        idleWheel_->touch(&idleEntry_);
+    }
+    if (forwardPaused_) {
+        return;  // 背压，等 target 发送之后再读
+    }
+    if (n == 0) {
+        // 对端关闭了写端（可能只是 shutdown(SHUT_WR)，还在等响应），半关闭传给 target，反方向继续转发
+        forwardReadDone_ = true;
+        channel_->disableReading();
+        target->shutdown();
+        TcpConnectionPtr source = forwardSource_.lock();
+        if (!source || (state_ == kDisconnecting && !isSending())) {
+            handleClose();  // 写方向也已经结束了
+        }
+    } else if (n < 0) {
+        if (savedErrno == EAGAIN) {
+            if (forwardPipe_ && target->outputBuffer_.readableBytes() > 0) {
+                pauseForwardRead();
+            }
+        } else if (savedErrno != EINTR) {
+            errno = savedErrno;
+            LOG_ERROR("TcpConnection::handleForwardRead - errno = %d", errno);
+            handleError();
+        }
+    } else if (!forwardPaused_ && channel_->edgeTriggered() && state_ != kDisconnected) {
+        channel_->keepReady(EPOLLIN);  // 预算用完，socket 里可能还有数据
+    }
+}
+
+// 和 trySendDirectly 一样，outputBuffer_ 为空时直接 splice 到 socket，剩下的作为 pipe 分段排队
+void TcpConnection::sendPipedInLoop(const std::shared_ptr<ForwardPipe> &pipe, size_t len) {
+    if (state_ == kDisconnected) {
+        LOG_ERROR("TcpConnection::sendPipedInLoop - disconnected, give up writing!");
+        pipe->discard(len);
+        return;
+    }
+
+    size_t nwrote = 0;
+    bool blocked = false;
+    if (!uring_ && !channel_->isWriting() && outputBuffer_.readableBytes() == 0) {
+        ssize_t n = ::splice(pipe->fds[0], nullptr, channel_->fd(), nullptr, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        blocked = n < 0 && errno == EAGAIN;
+        if (n > 0) {
+            nwrote = n;
+            blocked = nwrote < len;
+            if (nwrote == len && writeCompleteCallback_) {
+                loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+            }
+        } else if (n < 0 && errno != EAGAIN) {
+            LOG_ERROR("TcpConnection::sendPipedInLoop - errno = %d", errno);
+            if (errno == EPIPE || errno == ECONNRESET) {
+                pipe->discard(len);  // outputBuffer_ 为空，pipe 里只有这 len 个字节
+                return;
+            }
+        }
+    }
+
+    if (nwrote < len) {
+        size_t oldLen = outputBuffer_.readableBytes();
+        outputBuffer_.appendPipe(pipe->fds[0], len - nwrote, pipe);
+        afterAppendOutput(oldLen, blocked);
+    }
+}
+
+void TcpConnection::pauseForwardRead() {
+    if (!forwardPaused_) {
+        forwardPaused_ = true;
+        channel_->disableReading();
+    }
+}
+
+void TcpConnection::resumeForwardRead() {
+    if (forwardPaused_ && !forwardReadDone_ && state_ != kDisconnected) {
+        forwardPaused_ = false;
+        channel_->enableReading();
+        if (channel_->edgeTriggered()) {
+            channel_->keepReady(EPOLLIN);  // 暂停期间到达的数据 ET 模式不会再通知
+        }
+    }
+}
+
+void TcpConnection::resumeForwardSource() {
+    TcpConnectionPtr source = forwardSource_.lock();
+    if (source && source->forwardPaused_ && outputBuffer_.readableBytes() <= source->forwardHighWater() / 2) {
+        source->resumeForwardRead();
     }
 }
 
 // 连接建立，当 TcpServer 接受到一个新连接时被调用
 void TcpConnection::connectEstablished() {
     setState(kConnected);
+    loop_->addConnections(1);
+    if (loop_->socketBusyPollUs() > 0 && !socket_->setBusyPoll(loop_->socketBusyPollUs())) {
+        LOG_RATELIMIT(ERROR, "TcpConnection::connectEstablished - SO_BUSY_POLL error: %d", errno);
+    }
     //!NOTE: 防止上层将 TcpConnection 给 remove 掉而 callback 执行出错
     channel_->tie(shared_from_this());
-    channel_->enableReading();  // 向 poller 注册 channel 的 epollin 事件
+    if (completionMode_ && initCompletion()) {
+        startRecv();  // multishot RECV 代替 epollin 事件
+    } else {
+        channel_->enableReading();  // 向 poller 注册 channel 的 epollin 事件
+    }
+
+    if (idleWheel_) {
+        idleWheel_->touch(&idleEntry_);
+    }
 
     // 新连接建立，执行回调
     connectionCallback_(shared_from_this());
@@ -149,19 +730,47 @@ void TcpConnection::connectDestroyed() {
         connectionCallback_(shared_from_this());
     }
 
+    if (idleWheel_) {
+        idleWheel_->remove(&idleEntry_);
+    }
     channel_->remove();  // 把 channel 从 poller 中删除掉
+
+    loop_->addConnections(-1);
+    loop_->addQueuedBytes(-reportedQueued_);
+    reportedQueued_ = 0;
 }
 
 // 从 connfd 读取数据到 inputBuffer_ 并执行上层设置的 messageCallback_
 void TcpConnection::handleRead(Timestamp receiveTime) {
+    if (forwarding_) {
+        handleForwardRead();
+        return;
+    }
     int savedErrno = 0;
-    ssize_t n = inputBuffer_.readFd(channel_->fd(), &savedErrno);
+    ssize_t n = 0;
+    if (channel_->edgeTriggered()) {
+        // ET 模式必须读到 EAGAIN，否则不会再有可读事件
+        n = inputBuffer_.readFdUntilEAgain(channel_->fd(), &savedErrno, edgeTriggeredBudget());
+    } else if (readBudget_ > 0) {
+        n = inputBuffer_.readFdUntilEAgain(channel_->fd(), &savedErrno, readBudget_);
+    } else {
+        n = inputBuffer_.readFd(channel_->fd(), &savedErrno);
+    }
     if (n > 0) {
+        if (idleWheel_) {
+            idleWheel_->touch(&idleEntry_);
+        }
         // 已经建立连接的用户，有可读事件发生了，调用用户传入的回调操作 onMessage
         //!NOTE: shared_from_this() 返回当前对象的 shared_ptr
         messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
+        // 预算用完或者读到 EOF 停下来的，下一次迭代继续读（EOF 在下一次读到 0 时关闭）
+        if (channel_->edgeTriggered() && savedErrno != EAGAIN && state_ != kDisconnected) {
+            channel_->keepReady(EPOLLIN);
+        }
     } else if (n == 0) { // 断开连接
         handleClose();
+    } else if (savedErrno == EAGAIN || savedErrno == EINTR) {
+        // 没有数据可读，等下一次可读事件
     } else {
         errno = savedErrno;
         LOG_ERROR("TcpConnection::handleRead - errno = %d", errno);
@@ -174,8 +783,29 @@ void TcpConnection::handleWrite() {
     if (channel_->isWriting()) {
         int savedErrno = 0;
         ssize_t n = outputBuffer_.writeFd(channel_->fd(), &savedErrno);
-        if (n > 0) {
+        if (n > 0 && channel_->edgeTriggered()) {
+            // ET 模式写到 EAGAIN 或者预算用完，之后只有 socket 重新变成可写才会有 EPOLLOUT
+            size_t budget = edgeTriggeredBudget();
+            size_t total = 0;
+            while (n > 0) {
+                outputBuffer_.retrieve(n);
+                total += n;
+                if (outputBuffer_.readableBytes() == 0 || total >= budget || savedErrno == EAGAIN) {
+                    break;
+                }
+                n = outputBuffer_.writeFd(channel_->fd(), &savedErrno);
+            }
+            if (n > 0 && outputBuffer_.readableBytes() > 0 && savedErrno != EAGAIN) {
+                channel_->keepReady(EPOLLOUT);  // 预算用完，socket 还可写
+            }
+            n = static_cast<ssize_t>(total);
+        } else if (n > 0) {
             outputBuffer_.retrieve(n);
+        }
+        if (n > 0) {
+            if (idleWheel_) {
+                idleWheel_->touch(&idleEntry_);
+            }
             if (outputBuffer_.readableBytes() == 0) {
                 channel_->disableWriting();  // 写完了变成不可写
 
@@ -189,9 +819,16 @@ void TcpConnection::handleWrite() {
                     shutdownInLoop();
                 }
             }
-        } else {
-            LOG_ERROR("TcpConnection::handleWrite() - errno = %d", errno);
         }
+        if (savedErrno == EIO) {
+            // 文件分段被截断，剩下的数据永远发不完，只能关闭连接
+            LOG_ERROR("TcpConnection::handleWrite() - [%s] file truncated while sending", name_.c_str());
+            forceCloseInLoop();
+        } else if (n <= 0 && savedErrno != EAGAIN) {
+            LOG_ERROR("TcpConnection::handleWrite() - errno = %d", savedErrno);
+        }
+        syncQueuedBytes();
+        resumeForwardSource();
     } else {
         LOG_ERROR("TcpConnection::handleWrite() - fd = %d is down, no more writing", channel_->fd());
     }
@@ -202,6 +839,25 @@ void TcpConnection::handleClose() {
     LOG_INFO("TcpConnection::handleClose() - fd = %d, state = %d", channel_->fd(), (int)state_);
     setState(kDisconnected);
     channel_->disableAll();
+    if (uring_) {
+        // 请求持有连接的 shared_ptr，取消之后最后一个完成事件释放，然后连接才能析构
+        uring_->poller->cancel(uring_->recvOp);
+        uring_->poller->cancel(uring_->sendOp);
+        uring_->poller->cancel(uring_->writableOp);
+    }
+    if (idleWheel_) {
+        idleWheel_->remove(&idleEntry_);
+    }
+
+    // 代理模式: 被暂停的源继续读，发现这个连接断开之后关闭自己；转发目标把已经转发的数据发完再关闭写端
+    TcpConnectionPtr source = forwardSource_.lock();
+    if (source) {
+        source->resumeForwardRead();
+    }
+    TcpConnectionPtr target = forwardTarget_.lock();
+    if (target) {
+        target->shutdown();
+    }
 
     //!NOTE: 这里再次调用 connectionCallback_ 处理断开事件的 callback，实际上是给用户一个提示 disConnected，没有处理
     TcpConnectionPtr connPtr(shared_from_this());
@@ -221,3 +877,181 @@ void TcpConnection::handleError() {
 
     LOG_ERROR("TcpConnection::handleError() - name: %s, SO_ERROR: %d", name_.c_str(), err);
 }
+
+//!NOTE: 在 loop 线程中调用，SINGLE_ISSUER 的 ring 只能由 loop 线程注册 buffer ring
+bool TcpConnection::initCompletion() {
+    IoUringPoller *poller = loop_->ioUringPoller();
+    if (poller == nullptr || !poller->enableCompletion()) {
+        LOG_ERROR("TcpConnection::initCompletion - [%s] io_uring completion mode is not available, use readiness mode",
+                  name_.c_str());
+        return false;
+    }
+    uring_.reset(new UringState);
+    uring_->poller = poller;
+    uring_->recvOp = std::make_shared<IoUringOp>();
+    uring_->recvOp->callback = std::bind(&TcpConnection::onRecvComplete,
+                                         this,
+                                         std::placeholders::_1,
+                                         std::placeholders::_2,
+                                         std::placeholders::_3);
+    uring_->sendOp = std::make_shared<IoUringOp>();
+    uring_->sendOp->callback = std::bind(&TcpConnection::onSendComplete, this, std::placeholders::_1);
+    bzero(&uring_->msg, sizeof(uring_->msg));
+    uring_->sending = false;
+
+    inputBuffer_.shrink(0);  // 数据先到 provided buffer，inputBuffer_ 只在有数据时才分配
+    return true;
+}
+
+bool TcpConnection::isSending() const { return uring_ ? uring_->sending : channel_->isWriting(); }
+
+void TcpConnection::startRecv() {
+    uring_->recvOp->keepAlive = shared_from_this();
+    uring_->poller->submitRecv(channel_->fd(), uring_->recvOp);
+}
+
+// multishot RECV 的完成事件，data 是内核选中的 provided buffer，回调返回之后就还给内核
+void TcpConnection::onRecvComplete(int res, const char *data, uint32_t flags) {
+    bool more = (flags & IORING_CQE_F_MORE) != 0;
+    if (res > 0) {
+        inputBuffer_.append(data, res);
+        if (idleWheel_) {
+            idleWheel_->touch(&idleEntry_);
+        }
+        //!NOTE: socket 里还有数据时内核马上会投递下一个完成事件，攒起来再回调，和 readFd 一次读 64K 一样，
+        // 否则大消息被切成 kBufferSize 的小块，回复也变成小块，容易被 Nagle 延迟
+        if (more && (flags & IORING_CQE_F_SOCK_NONEMPTY)) {
+            return;
+        }
+        messageCallback_(shared_from_this(), &inputBuffer_, loop_->pollReturnTime());
+        // 大消息处理完之后把容量还回去，空闲连接只占一个 kCheapPrepend
+        if (inputBuffer_.readableBytes() == 0 && inputBuffer_.internalCapacity() > Buffer::kInitialSize) {
+            inputBuffer_.shrink(0);
+        }
+    } else if (res == 0) {  // 断开连接
+        if (state_ != kDisconnected) {
+            handleClose();
+        }
+        return;
+    } else if (res == -EBUSY) {
+        loop_->queueInLoop(std::bind(&TcpConnection::retryRecv, shared_from_this()));
+        return;
+    } else if (res != -ENOBUFS && res != -ECANCELED) {
+        // provided buffer 暂时用完（ENOBUFS）时重新提交，其他错误和 handleRead 一样关闭连接
+        LOG_ERROR("TcpConnection::onRecvComplete - [%s] errno = %d", name_.c_str(), -res);
+        if (state_ != kDisconnected) {
+            handleClose();
+        }
+        return;
+    }
+
+    // multishot 被内核终止了（provided buffer 用完、CQ 溢出等），连接还在就重新提交
+    if (!more && (state_ == kConnected || state_ == kDisconnecting)) {
+        startRecv();
+    }
+}
+
+void TcpConnection::startSend() {
+    UringState *uring = uring_.get();
+    // io_uring 没有 sendfile，文件分段在 loop 线程直接 sendfile，发送缓冲区满了用 POLL_ADD 等待可写
+    while (outputBuffer_.frontIsFile()) {
+        int savedErrno = 0;
+        ssize_t n = outputBuffer_.writeFd(channel_->fd(), &savedErrno);
+        if (n > 0) {
+            outputBuffer_.retrieve(n);
+        }
+        if (savedErrno == EAGAIN || savedErrno == EWOULDBLOCK) {
+            if (!uring->writableOp) {
+                uring->writableOp = std::make_shared<IoUringOp>();
+                uring->writableOp->callback = std::bind(&TcpConnection::onWritable, this, std::placeholders::_1);
+            }
+            uring->sending = true;
+            uring->writableOp->keepAlive = shared_from_this();
+            uring->poller->submitPoll(channel_->fd(), EPOLLOUT, uring->writableOp);
+            return;
+        }
+        if (savedErrno == EIO) {
+            LOG_ERROR("TcpConnection::startSend - [%s] file truncated while sending", name_.c_str());
+            forceCloseInLoop();
+            return;
+        } else if (n < 0) {
+            LOG_ERROR("TcpConnection::startSend - errno = %d", savedErrno);
+            return;
+        }
+    }
+
+    if (outputBuffer_.readableBytes() == 0) {
+        if (writeCompleteCallback_) {
+            loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+        }
+        if (state_ == kDisconnecting) {
+            shutdownInLoop();
+        }
+        return;
+    }
+
+    size_t total = 0;
+    uring->msg.msg_iov = uring->iov;
+    uring->msg.msg_iovlen = outputBuffer_.peekIov(uring->iov, UringState::kMaxIov, &total);
+    outputBuffer_.seal();  // SENDMSG 完成之前这些分段的地址不能变
+    uring->sending = true;
+    uring->sendOp->keepAlive = shared_from_this();
+    uring->poller->submitSendmsg(channel_->fd(), &uring->msg, uring->sendOp);
+}
+
+void TcpConnection::onSendComplete(int res) {
+    if (res == -EBUSY) {
+        // sending 保持为 true，期间追加的数据不会另外提交，shutdown 也等到重新发送完
+        loop_->queueInLoop(std::bind(&TcpConnection::retrySend, shared_from_this()));
+        return;
+    }
+    uring_->sending = false;
+    if (res < 0) {
+        // 对端关闭（EPIPE / ECONNRESET）时 RECV 也会出错，由 onRecvComplete 关闭连接
+        if (res != -ECANCELED) {
+            LOG_ERROR("TcpConnection::onSendComplete - [%s] errno = %d", name_.c_str(), -res);
+        }
+        return;
+    }
+    outputBuffer_.retrieve(res);
+    if (idleWheel_) {
+        idleWheel_->touch(&idleEntry_);
+    }
+    if (state_ != kDisconnected) {
+        startSend();  // 只写出去一部分或者发送过程中又追加了数据
+    }
+    syncQueuedBytes();
+    resumeForwardSource();
+}
+
+void TcpConnection::onWritable(int res) {
+    if (res == -EBUSY) {
+        loop_->queueInLoop(std::bind(&TcpConnection::retrySend, shared_from_this()));
+        return;
+    }
+    uring_->sending = false;
+    if (res < 0) {
+        if (res != -ECANCELED) {
+            LOG_ERROR("TcpConnection::onWritable - [%s] errno = %d", name_.c_str(), -res);
+        }
+        return;
+    }
+    if (state_ != kDisconnected) {
+        startSend();
+    }
+}
+
+//!NOTE: 在 pendingFunctors 里执行时 SQ 可能还没有提交，再次 -EBUSY 就再等一次迭代，poll 会把 SQ 交给内核
+void TcpConnection::retryRecv() {
+    if (state_ == kConnected || state_ == kDisconnecting) {
+        startRecv();
+    }
+}
+
+void TcpConnection::retrySend() {
+    uring_->sending = false;
+    if (state_ != kDisconnected) {
+        startSend();
+    }
+    syncQueuedBytes();
+}
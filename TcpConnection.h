@@ -1,17 +1,24 @@
 #pragma once
 
 #include "Buffer.h"
+#include "BufferChain.h"
 #include "Callbacks.h"
+#include "FileCache.h"
+#include "IdleWheel.h"
 #include "InetAddress.h"
 #include "Timestamp.h"
 #include "noncopyable.h"
 
+#include <sys/uio.h>
+
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 
 class Channel;
 class EventLoop;
+class IdleWheel;
 class Socket;
 
 /**
@@ -34,9 +41,30 @@ class TcpConnection : noncopyable, public std::enable_shared_from_this<TcpConnec
 
     bool connected() const { return state_ == kConnected; }
 
-    void send(std::string &buf);  // 发送数据
-
-    void shutdown();  // 关闭连接
+    // 内核发送缓冲区的大小，默认由内核自动调整
+    void setSendBufferSize(int bytes);
+
+    // 发送数据，可以跨线程调用，右值和 shared_ptr 的 payload 最多拷贝一次
+    void send(const std::string &buf);
+    void send(std::string &&buf);
+    void send(const void *data, size_t len);
+    void send(Buffer *buf);  // 发送之后 retrieveAll
+    // 一次发送多段数据（例如 header + body），不需要先拼接，loop 线程中直接 writev
+    void send(const struct iovec *iov, int iovcnt);
+    // 不可变的共享数据（例如缓存的大响应），没发送完的部分只引用不拷贝
+    void send(const std::shared_ptr<const std::string> &payload);
+
+    /**
+     * 通过 sendfile 发送文件的 [offset, offset + length)，和 send 的数据保持先后顺序
+     * 发送完成之后回调 writeCompleteCallback_
+     * 第一个版本调用者保证 fd 在发送完成之前一直有效，第二个版本 outputBuffer_ 持有 file 的引用，file 为空时什么也不发
+     * 文件比 offset + length 短时关闭连接
+     */
+    void sendFile(int fd, off_t offset, size_t length);
+    void sendFile(const CachedFilePtr &file, off_t offset, size_t length);
+
+    void shutdown();    // 关闭连接
+    void forceClose();  // 不等待 outputBuffer 发送完，直接关闭连接
 
     void setConnectionCallback(const ConnectionCallback &cb) { connectionCallback_ = cb; }
 
@@ -51,21 +79,100 @@ class TcpConnection : noncopyable, public std::enable_shared_from_this<TcpConnec
 
     void setCloseCallback(const CloseCallback &cb) { closeCallback_ = cb; }
 
+    // 每次可读事件循环读到 EAGAIN，最多读 bytes 字节，0 表示每次可读事件只 readv 一次（默认）
+    void setReadBudget(size_t bytes) { readBudget_ = bytes; }
+
+    /**
+     * 边缘触发（EPOLLET），必须在 connectEstablished 之前设置
+     * 可读 / 可写时一直读写到 EAGAIN，单次最多 readBudget（默认 kEdgeTriggeredBudget）字节，预算用完还没有
+     * 读完 / 写完的留到下一次 loop 迭代继续，EPOLLOUT 一直注册着，部分写不需要 epoll_ctl
+     */
+    void setEdgeTriggered(bool on);
+
+    /**
+     * io_uring 完成模式，必须在 connectEstablished 之前设置，loop 的 poller 不是 io_uring 时保持就绪模式
+     * - multishot RECV 从 loop 共享的 provided buffer 里取数据追加到 inputBuffer_，messageCallback_ 的语义不变，
+     *   空闲连接的 inputBuffer_ 不预留空间
+     * - send 的数据先追加到 outputBuffer_，分段直接交给 SENDMSG，发送完成之后回调 writeCompleteCallback_
+     */
+    void setCompletionMode(bool on) { completionMode_ = on; }
+    bool completionMode() const { return uring_ != nullptr; }
+
+    /**
+     * 代理模式: 之后从这个连接读到的数据不再回调 messageCallback_，直接转发给 peer，只能在 loop 线程调用
+     * - peer 必须属于同一个 loop，这个连接不能是 io_uring 完成模式；双向代理时两个连接各调用一次
+     * - useSplice: 数据经过这个连接自己的 pipe，splice(socket -> pipe) 之后作为 pipe 分段排在 peer 的 outputBuffer_ 里，
+     *   再 splice(pipe -> peer socket)，不经过用户空间；splice 不可用时退回 inputBuffer_ 拷贝
+     * - 背压: peer 的 outputBuffer_ 超过 pipe 容量（拷贝时 kForwardHighWater）或者 pipe 满了就停止读，peer 发送到一半以下再恢复
+     * - 读到 EOF 之后把半关闭传给 peer: peer 把已经转发的数据发完再 shutdown，这个连接停止读，但是反方向的数据照常发送，
+     *   两个方向都结束（或者没有连接转发给它）之后才关闭；出错时直接关闭
+     * - inputBuffer_ 里 messageCallback_ 没有取走的数据先转发
+     */
+    bool forwardTo(const TcpConnectionPtr &peer, bool useSplice = true);
+
+    // 上层协议（例如 HttpServer 的解析状态）保存在连接上的上下文，只在 loop 线程访问
+    void setContext(const std::shared_ptr<void> &context) { context_ = context; }
+    const std::shared_ptr<void> &getContext() const { return context_; }
+
+    // 空闲超时，必须在 connectEstablished 之前设置，wheel 必须属于同一个 loop
+    void setIdleWheel(const std::shared_ptr<IdleWheel> &wheel) { idleWheel_ = wheel; }
+
     void connectEstablished();  // 连接建立
     void connectDestroyed();    // 连接销毁
 
   private:
     enum StateE { kDisconnected, kConnecting, kConnected, kDisconnecting };  // 连接状态
 
+    static const size_t kEdgeTriggeredBudget = 256 * 1024;  // ET 模式每次读 / 写事件的默认预算
+    static const size_t kForwardHighWater = 256 * 1024;     // 转发时 peer 最多排队的字节数，也是 pipe 的容量
+
     void handleRead(Timestamp receiveTime);
     void handleWrite();
+    size_t edgeTriggeredBudget() const { return readBudget_ > 0 ? readBudget_ : kEdgeTriggeredBudget; }
     void handleClose();
     void handleError();
 
+    struct UringState;  // 完成模式的请求和 SENDMSG 的参数
+    bool initCompletion();
+    bool isSending() const;  // outputBuffer_ 正在发送: 注册了写事件，或者 SENDMSG / 等待可写的 POLL_ADD 进行中
+    void startRecv();
+    void startSend();        // 完成模式下发送 outputBuffer_，为空时回调 writeCompleteCallback_
+    void onRecvComplete(int res, const char *data, uint32_t flags);
+    void onSendComplete(int res);
+    void onWritable(int res);
+    // prepareOp 的 -EBUSY（SQ 满了）不是连接出错，下一次迭代重新提交
+    void retryRecv();
+    void retrySend();
+
     void setState(StateE s) { state_ = s; }
 
+    void sendFile(int fd, off_t offset, size_t length, const std::shared_ptr<const void> &owner);
+
+    struct ForwardPipe;  // forwardTo 的 pipe，peer 的 pipe 分段持有它直到发送完
+    void handleForwardRead();
+    void sendPipedInLoop(const std::shared_ptr<ForwardPipe> &pipe, size_t len);  // pipe 里的 len 个字节
+    size_t forwardHighWater() const;
+    void pauseForwardRead();
+    void resumeForwardRead();
+    void resumeForwardSource();  // outputBuffer_ 发送之后，恢复被背压暂停的源
+
+    void queueFlush();
+    void flushStagedInLoop();
+
     void sendInLoop(const void *message, size_t len);
+    void sendvInLoop(const struct iovec *iov, int iovcnt);
+    void sendSharedInLoop(const std::shared_ptr<const std::string> &payload);
+    void sendOwnedInLoop(std::string &&payload);
+    void sendFileInLoop(int fd, off_t offset, size_t length, const std::shared_ptr<const void> &owner);
+    // outputBuffer_ 为空时直接 writev，nwrote 返回写出去的字节数，连接不可写时返回 false
+    // blocked: 直接写的时候 socket 写满了（EAGAIN 或者内核只写了一部分）
+    bool trySendDirectly(const struct iovec *iov, int iovcnt, size_t total, size_t *nwrote, bool *blocked);
+    void afterAppendOutput(size_t oldLen, bool blocked);  // 追加到 outputBuffer_ 之后检查高水位并注册写事件
+    void syncQueuedBytes();  // 把 outputBuffer_ 的变化计入 EventLoop::Load::queuedBytes
     void shutdownInLoop();
+    void forceCloseInLoop();
+
+    static void onIdleExpired(IdleEntry *entry);  // IdleWheel 到期回调
 
     EventLoop *loop_;  // 这里绝对不是 baseLoop，因为 TcpConnection 都是在 subLoop 里面管理的
     const std::string name_;
@@ -87,7 +194,30 @@ class TcpConnection : noncopyable, public std::enable_shared_from_this<TcpConnec
     CloseCallback closeCallback_;
 
     size_t highWaterMark_;
+    size_t readBudget_;
 
     Buffer inputBuffer_;
-    Buffer outputBuffer_;
+    BufferChain outputBuffer_;  // 分段的发送缓冲区，大块数据只引用不拷贝
+    int64_t reportedQueued_;    // 上一次 syncQueuedBytes 时 outputBuffer_ 的长度
+
+    // 其他线程 send 的数据先放到 staged_，每个 loop 迭代只 queueInLoop 一次 flushStagedInLoop
+    std::mutex stagedMutex_;
+    BufferChain staged_;
+    bool flushQueued_;
+
+    std::shared_ptr<IdleWheel> idleWheel_;
+    IdleEntry idleEntry_;
+
+    std::shared_ptr<void> context_;
+
+    bool completionMode_;
+    std::unique_ptr<UringState> uring_;
+
+    // forwardTo 之后只在 loop 线程访问
+    bool forwarding_;
+    bool forwardPaused_;                          // 因为 forwardTarget_ 的背压停止了读
+    bool forwardReadDone_;                        // 读到了 EOF，半关闭已经传给 forwardTarget_
+    std::weak_ptr<TcpConnection> forwardTarget_;  // 读到的数据转发给谁
+    std::weak_ptr<TcpConnection> forwardSource_;  // 谁把数据转发给这个连接
+    std::shared_ptr<ForwardPipe> forwardPipe_;    // 为空表示拷贝转发
 };
@@ -1,3 +1,5 @@
+#define MUDUO_LOG_MODULE kLogModuleTcp
+
 #include "TcpServer.h"
 #include "Logger.h"
 
@@ -15,12 +17,20 @@ TcpServer::TcpServer(EventLoop *loop, const InetAddress &listenAddr, const std::
     : loop_(CheckLoopNotNull(loop))
     , ipPort_(listenAddr.toIpPort())
     , name_(nameArg)
-    , acceptor_(new Acceptor(loop, listenAddr, option == kReusePort))
+    , listenAddr_(listenAddr)
+    , option_(option)
+    , acceptor_(new Acceptor(loop, listenAddr, option != kNoReusePort))
     , threadPool_(new EventLoopThreadPool(loop, name_))
     , connectionCallback_()
     , messageCallback_()
     , nextConnId_(1) 
     , started_(0)
+    , readBudget_(0)
+    , edgeTriggered_(false)
+    , completionMode_(false)
+    , idleSeconds_(0.0)
+    , busyPollUs_(0)
+    , socketBusyPollUs_(0)
 {
     // 当有新用户连接时，会执行 TcpServer::newConnection 回调
     acceptor_->setNewConnectionCallback(
@@ -36,6 +46,7 @@ TcpServer::~TcpServer() {
         // 销毁链接
         conn->getLoop()->runInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
     }
+    stopLoopAcceptors();
 }
 
 // 设置底层 subLoop 的个数
@@ -46,18 +57,112 @@ void TcpServer::start() {
     if (started_++ == 0)  // 防止一个 TcpServer 对象被 start 多次
     {
         threadPool_->start(threadInitCallback_);                          // 启动底层的 loop 线程池
+
+        if (busyPollUs_ > 0) {
+            std::vector<EventLoop *> loops = threadPool_->getAllLoops();
+            if (loops.front() != loop_) {
+                loops.push_back(loop_);
+            }
+            for (EventLoop *ioLoop : loops) {
+                ioLoop->runInLoop(std::bind(&EventLoop::setBusyPoll, ioLoop, busyPollUs_, socketBusyPollUs_));
+            }
+        }
+        if (idleSeconds_ > 0.0) {
+            for (EventLoop *ioLoop : threadPool_->getAllLoops()) {
+                std::shared_ptr<IdleWheel> wheel(new IdleWheel(ioLoop, idleSeconds_));
+                wheel->start();
+                idleWheels_[ioLoop] = wheel;
+            }
+        }
+        if (option_ == kReusePortPerLoop && threadPool_->getAllLoops().front() != loop_) {
+            startLoopAcceptors();
+            return;
+        }
+        acceptor_->setEdgeTriggered(edgeTriggered_);
+        acceptor_->setCompletionMode(completionMode_);
         loop_->runInLoop(std::bind(&Acceptor::listen, acceptor_.get()));  // listen
     }
 }
 
+/**
+ * 每个 subLoop 一个 SO_REUSEPORT 的 listenfd，内核按四元组哈希把新连接分给它们
+ * accept、创建 TcpConnection、removeConnection 都在同一个 subLoop 线程里，baseLoop 不再参与
+ *!NOTE: listenfd 已经在 TcpServer 构造时 bind 了，这里先关掉它，否则 baseLoop 的 Acceptor 不 listen 也占着端口
+ */
+void TcpServer::startLoopAcceptors() {
+    acceptor_.reset();
+    for (EventLoop *ioLoop : threadPool_->getAllLoops()) {
+        std::unique_ptr<LoopAcceptor> shard(new LoopAcceptor);
+        shard->acceptor.reset(new Acceptor(ioLoop, listenAddr_, true));
+        shard->acceptor->setNewConnectionCallback(std::bind(
+            &TcpServer::createConnection, this, ioLoop, std::placeholders::_1, std::placeholders::_2));
+        shard->acceptor->setEdgeTriggered(edgeTriggered_);
+        shard->acceptor->setCompletionMode(completionMode_);
+        loopAcceptors_[ioLoop] = std::move(shard);
+    }
+    //!NOTE: 所有 shard 都放进 loopAcceptors_ 之后再 listen，subLoop 里的 createConnection 会读这个 map
+    for (auto &item : loopAcceptors_) {
+        item.first->runInLoop(std::bind(&Acceptor::listen, item.second->acceptor.get()));
+    }
+}
+
+// Acceptor 和连接都要在所属的 subLoop 线程里销毁，等所有 subLoop 处理完再返回
+void TcpServer::stopLoopAcceptors() {
+    if (loopAcceptors_.empty()) {
+        return;
+    }
+    sem_t sem;
+    sem_init(&sem, false, 0);
+    for (auto &item : loopAcceptors_) {
+        item.first->runInLoop(std::bind(&TcpServer::stopLoopAcceptor, item.second.get(), &sem));
+    }
+    for (size_t i = 0; i < loopAcceptors_.size(); ++i) {
+        sem_wait(&sem);
+    }
+    sem_destroy(&sem);
+}
+
+void TcpServer::stopLoopAcceptor(LoopAcceptor *shard, sem_t *done) {
+    shard->acceptor.reset();
+    for (auto &item : shard->connections) {
+        item.second->connectDestroyed();
+    }
+    shard->connections.clear();
+    sem_post(done);
+}
+
+uint64_t TcpServer::acceptedCount() const {
+    uint64_t count = acceptor_ ? acceptor_->acceptedCount() : 0;
+    for (auto &item : loopAcceptors_) {
+        count += item.second->acceptor->acceptedCount();
+    }
+    return count;
+}
+
+uint64_t TcpServer::droppedCount() const {
+    uint64_t count = acceptor_ ? acceptor_->droppedCount() : 0;
+    for (auto &item : loopAcceptors_) {
+        count += item.second->acceptor->droppedCount();
+    }
+    return count;
+}
+
+TcpServer::ConnectionMap &TcpServer::connectionsOf(EventLoop *ioLoop) {
+    if (loopAcceptors_.empty()) {
+        return connections_;
+    }
+    return loopAcceptors_.at(ioLoop)->connections;  // 不能用 operator[]，它会插入元素
+}
+
 // 有一个新的客户端的连接，acceptor 会执行这个回调, sockfd 就是 connfd
 void TcpServer::newConnection(int sockfd, const InetAddress &peerAddr) {
-    // 轮询算法，选择一个 subLoop 来管理 channel
-    EventLoop *ioLoop = threadPool_->getNextLoop();
+    // 按 LoopSelector 的策略（默认轮询），选择一个 subLoop 来管理 channel
+    createConnection(threadPool_->getNextLoop(peerAddr), sockfd, peerAddr);
+}
 
+void TcpServer::createConnection(EventLoop *ioLoop, int sockfd, const InetAddress &peerAddr) {
     char buf[64] = {0};
-    snprintf(buf, sizeof(buf), "-%s#%d", ipPort_.c_str(), nextConnId_);
-    ++nextConnId_;  // 这个不涉及线程安全问题
+    snprintf(buf, sizeof(buf), "-%s#%d", ipPort_.c_str(), nextConnId_++);  // kReusePortPerLoop 时多个线程同时分配
 
     std::string connName = name_ + buf;
     LOG_INFO("TcpServer::newConnection [%s] - new connection [%s] from %s",
@@ -76,12 +181,18 @@ void TcpServer::newConnection(int sockfd, const InetAddress &peerAddr) {
 
     // 根据连接成功的 sockfd，创建 TcpConnection 连接对象
     TcpConnectionPtr conn(new TcpConnection(ioLoop, connName, sockfd, localAddr, peerAddr));
-    connections_[connName] = conn;
+    connectionsOf(ioLoop)[connName] = conn;
 
     // 下面的回调都是用户设置给 TcpServer => TcpConnection => Channel => Poller => notify channel 调用回调
     conn->setConnectionCallback(connectionCallback_);
     conn->setMessageCallback(messageCallback_);
     conn->setWriteCompleteCallback(writeCompleteCallback_);
+    conn->setReadBudget(readBudget_);
+    conn->setEdgeTriggered(edgeTriggered_);
+    conn->setCompletionMode(completionMode_);
+    if (!idleWheels_.empty()) {
+        conn->setIdleWheel(idleWheels_[ioLoop]);
+    }
 
     // 设置了如何关闭连接的回调
     conn->setCloseCallback(
@@ -90,19 +201,21 @@ void TcpServer::newConnection(int sockfd, const InetAddress &peerAddr) {
 
     // 直接调用 TcpConnection::connectEstablished
     // 1. 设置了 threadNum 就会进入 queueInLoop <-- subLoop
-    // 2. 没有设置 threadNum 就直接进入 runInLoop 的 cb() <-- baseLoop
+    // 2. 没有设置 threadNum 或者 kReusePortPerLoop 就直接进入 runInLoop 的 cb() <-- 当前 loop
     ioLoop->runInLoop(std::bind(&TcpConnection::connectEstablished, conn));
 }
 
 //!NOTE: 这里 TcpConnectionPtr 别写错成了 TcpConnection
+// kReusePortPerLoop 时连接保存在所属 subLoop 的 map 里，不需要回到 baseLoop
 void TcpServer::removeConnection(const TcpConnectionPtr &conn) {
-    loop_->runInLoop(std::bind(&TcpServer::removeConnectionInLoop, this, conn));
+    EventLoop *loop = loopAcceptors_.empty() ? loop_ : conn->getLoop();
+    loop->runInLoop(std::bind(&TcpServer::removeConnectionInLoop, this, conn));
 }
 
 void TcpServer::removeConnectionInLoop(const TcpConnectionPtr &conn) {
     LOG_INFO("TcpServer::removeConnectionInLoop - name [%s], connection [%s]", name_.c_str(), conn->name().c_str());
 
-    connections_.erase(conn->name());
+    connectionsOf(conn->getLoop()).erase(conn->name());
 
     EventLoop *ioLoop = conn->getLoop();
     ioLoop->queueInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
@@ -9,8 +9,11 @@
 #include "noncopyable.h"
 #include "EventLoopThreadPool.h"
 #include "Callbacks.h"
+#include "IdleWheel.h"
 #include "TcpConnection.h"
 
+#include <semaphore.h>
+
 #include <functional>
 #include <memory>
 #include <string>
@@ -22,7 +25,9 @@ class TcpServer : noncopyable {
     using ThreadInitCallback = std::function<void(EventLoop *)>;
 
     // 是否重用端口
-    enum Option { kNoReusePort, kReusePort };
+    // kReusePortPerLoop: 每个 subLoop 有自己的 SO_REUSEPORT Acceptor，由内核分发新连接，
+    // 连接留在 accept 它的 loop 里，不经过 baseLoop，也没有跨线程唤醒；没有 subLoop 时和 kReusePort 一样
+    enum Option { kNoReusePort, kReusePort, kReusePortPerLoop };
 
     TcpServer(EventLoop *loop, const InetAddress &listenAddr, const std::string &nameArg, Option option = kNoReusePort);
     ~TcpServer();
@@ -34,21 +39,70 @@ class TcpServer : noncopyable {
 
     void setThreadNum(int numThreads);  // 设置底层 subLoop 的个数
 
+    // 新连接的读预算，参考 TcpConnection::setReadBudget
+    void setReadBudget(size_t bytes) { readBudget_ = bytes; }
+
+    // listenfd 和新连接都使用边缘触发（EPOLLET），必须在 start 之前设置，参考 TcpConnection::setEdgeTriggered
+    void setEdgeTriggered(bool on) { edgeTriggered_ = on; }
+
+    // listenfd 和新连接都使用 io_uring 完成模式，必须在 start 之前设置，需要 setPollerType(kIoUringPoller)
+    // 参考 TcpConnection::setCompletionMode，loop 不是 io_uring 时使用原来的就绪模式
+    void setCompletionMode(bool on) { completionMode_ = on; }
+
+    // subLoop 的 IO 复用实现，必须在 start 之前设置，baseLoop 由用户构造 EventLoop 时指定
+    void setPollerType(EventLoop::PollerType type) { threadPool_->setPollerType(type); }
+
+    // 所有 loop（包括 baseLoop）使用忙轮询，参考 EventLoop::setBusyPoll，必须在 start 之前设置
+    void setBusyPoll(int64_t budgetUs, int socketBusyPollUs = 0) {
+        busyPollUs_ = budgetUs;
+        socketBusyPollUs_ = socketBusyPollUs;
+    }
+
+    // subLoop 的 CPU 绑定，参考 EventLoopThreadPool::setCpuAffinity，必须在 start 之前设置
+    void setCpuAffinity(const std::vector<std::vector<int>> &cpuSets) { threadPool_->setCpuAffinity(cpuSets); }
+    void setCpuAffinityPerPhysicalCore() { threadPool_->setCpuAffinityPerPhysicalCore(); }
+
+    // 新连接选择 subLoop 的策略，参考 LoopSelector，必须在 start 之前设置；kReusePortPerLoop 时由内核分发，不使用
+    void setLoopSelectPolicy(LoopSelector::Policy policy) { threadPool_->setLoopSelectPolicy(policy); }
+    void setLoopSelector(std::unique_ptr<LoopSelector> selector) { threadPool_->setLoopSelector(std::move(selector)); }
+
+    // 连接超过 seconds 秒没有读写就强制关闭，每个 loop 一个 IdleWheel，必须在 start 之前设置，<= 0 表示关闭
+    void setIdleTimeout(double seconds) { idleSeconds_ = seconds; }
+
     void start();  // 开启服务器监听
 
+    // 所有 Acceptor 累计 accept 的连接数和 fd 用完时丢弃的连接数，可以在任意线程调用
+    uint64_t acceptedCount() const;
+    uint64_t droppedCount() const;
+
   private:
+    using ConnectionMap = std::unordered_map<std::string, TcpConnectionPtr>;
+
+    // kReusePortPerLoop 时每个 subLoop 一份，只在所属的 loop 线程中访问
+    struct LoopAcceptor {
+        std::unique_ptr<Acceptor> acceptor;
+        ConnectionMap connections;
+    };
+
     void newConnection(int sockfd, const InetAddress &peerAddr);
+    // 在 ioLoop 上创建 TcpConnection，kReusePortPerLoop 时由 ioLoop 自己的 Acceptor 在 ioLoop 线程里调用
+    void createConnection(EventLoop *ioLoop, int sockfd, const InetAddress &peerAddr);
     void removeConnection(const TcpConnectionPtr &conn);
     void removeConnectionInLoop(const TcpConnectionPtr &conn);
 
-    using ConnectionMap = std::unordered_map<std::string, TcpConnectionPtr>;
+    void startLoopAcceptors();
+    void stopLoopAcceptors();
+    static void stopLoopAcceptor(LoopAcceptor *shard, sem_t *done);
+    ConnectionMap &connectionsOf(EventLoop *ioLoop);  // ioLoop 上的连接保存在哪个 map 里
 
     EventLoop *loop_;  // baseLoop 用户定义的 loop
 
     const std::string ipPort_;
     const std::string name_;
+    const InetAddress listenAddr_;
+    const Option option_;
 
-    std::unique_ptr<Acceptor> acceptor_;  // 运行在 mainLoop，任务就是监听新连接事件
+    std::unique_ptr<Acceptor> acceptor_;  // 运行在 mainLoop，任务就是监听新连接事件，kReusePortPerLoop 时 start 之后为空
 
     std::shared_ptr<EventLoopThreadPool> threadPool_;  // one loop per thread
 
@@ -59,6 +113,15 @@ class TcpServer : noncopyable {
     ThreadInitCallback threadInitCallback_;  // loop 线程初始化的回调
     std::atomic_int started_;
 
-    int nextConnId_;
+    std::atomic_int nextConnId_;  // kReusePortPerLoop 时多个 loop 线程同时分配
     ConnectionMap connections_;  // 保存所有连接
+    std::unordered_map<EventLoop *, std::unique_ptr<LoopAcceptor>> loopAcceptors_;  // start 之后不再修改
+
+    size_t readBudget_;
+    bool edgeTriggered_;
+    bool completionMode_;
+    double idleSeconds_;
+    int64_t busyPollUs_;
+    int socketBusyPollUs_;
+    std::unordered_map<EventLoop *, std::shared_ptr<IdleWheel>> idleWheels_;  // 声明在 threadPool_ 之后，先于 loop 线程析构
 };
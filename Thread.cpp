@@ -1,13 +1,17 @@
 #include "Thread.h"
 
+#include "CpuAffinity.h"
 #include "CurrentThread.h"
+#include "Logger.h"
 
+#include <errno.h>
+#include <pthread.h>
 #include <semaphore.h>
 
 std::atomic_int Thread::numCreated_(0);  // 静态成员类外初始化
 
 Thread::Thread(ThreadFunc func, const std::string &name)
-    : started_(false), joined_(false), tid_(0), func_(std::move(func)), name_(name) {
+    : started_(false), joined_(false), tid_(0), func_(std::move(func)), name_(name), localMemory_(false) {
     setDefaultName();
 }
 
@@ -27,6 +31,7 @@ void Thread::start() {
     // 开启线程
     thread_ = std::shared_ptr<std::thread>(new std::thread([&]() {
         tid_ = CurrentThread::tid();  // 获取线程的 tid 值
+        initInThread();
         sem_post(&sem);
         func_();  // 开启一个新线程，专门执行该线程函数
     }));
@@ -35,6 +40,21 @@ void Thread::start() {
     sem_wait(&sem);
 }
 
+/**
+ *!NOTE: 绑定要在 func_ 之前完成，EventLoop 在 func_ 里构造，poller、缓冲区这些第一次写入的内存才会落在绑定的 CPU 所在的 NUMA 节点
+ */
+void Thread::initInThread() {
+    // 线程名最长 15 个字节，top -H / perf 里可以看到
+    ::pthread_setname_np(::pthread_self(), name_.substr(0, 15).c_str());
+
+    if (!cpus_.empty() && !CpuAffinity::pinCurrentThread(cpus_)) {
+        LOG_ERROR("Thread::initInThread - [%s] sched_setaffinity error: %d", name_.c_str(), errno);
+    }
+    if (localMemory_ && !CpuAffinity::useLocalMemory()) {
+        LOG_ERROR("Thread::initInThread - [%s] set_mempolicy error: %d", name_.c_str(), errno);
+    }
+}
+
 void Thread::join() {
     joined_ = true;
     thread_->join();
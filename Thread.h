@@ -8,6 +8,7 @@
 #include <string>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 class Thread : noncopyable {
   public:
@@ -16,6 +17,12 @@ class Thread : noncopyable {
     explicit Thread(ThreadFunc func, const std::string &name = std::string());
     ~Thread();
 
+    // 新线程执行 func 之前先绑定到 cpus（为空不绑定），localMemory 时再设置 MPOL_LOCAL，必须在 start 之前设置
+    void setCpuAffinity(const std::vector<int> &cpus, bool localMemory) {
+        cpus_ = cpus;
+        localMemory_ = localMemory;
+    }
+
     void start();
     void join();
 
@@ -27,6 +34,7 @@ class Thread : noncopyable {
 
   private:
     void setDefaultName();
+    void initInThread();  // 在新线程里设置线程名、CPU 绑定和内存策略
 
     bool started_;
     bool joined_;
@@ -34,5 +42,7 @@ class Thread : noncopyable {
     pid_t tid_;
     ThreadFunc func_;
     std::string name_;
+    std::vector<int> cpus_;
+    bool localMemory_;
     static std::atomic_int numCreated_;
 };
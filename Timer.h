@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Callbacks.h"
+#include "Timestamp.h"
+#include "noncopyable.h"
+
+// 时间轮槽位上的双向循环链表节点，槽位本身是一个哨兵节点
+struct TimerListNode {
+    TimerListNode *prev;
+    TimerListNode *next;
+
+    TimerListNode() : prev(this), next(this) {}
+
+    bool empty() const { return next == this; }
+};
+
+/**
+ * 定时器节点，由 TimerQueue 的对象池分配和回收，不要直接 new
+ * 通过继承 TimerListNode 挂在时间轮槽位上，插入和删除都是 O(1)
+ */
+class Timer : public TimerListNode, noncopyable {
+  public:
+    Timer() : interval_(0.0), repeat_(false), sequence_(0), expirationTick_(0), level_(-1), slot_(-1) {}
+
+    void run() const { callback_(); }
+
+    Timestamp expiration() const { return expiration_; }
+    bool repeat() const { return repeat_; }
+    int64_t sequence() const { return sequence_; }
+
+  private:
+    friend class TimerQueue;
+
+    TimerCallback callback_;
+    Timestamp expiration_;
+    double interval_;  // 周期定时器的间隔，单位秒
+    bool repeat_;
+    int64_t sequence_;  // 节点被复用时递增，TimerId 用它判断节点是否还是原来的定时器
+
+    int64_t expirationTick_;  // 到期的 tick
+    int level_;               // 所在时间轮层级，-1 表示不在时间轮上
+    int slot_;                // 所在层级的槽位
+};
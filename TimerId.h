@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+
+class Timer;
+
+/**
+ * 定时器句柄，只用于 EventLoop::cancel
+ * Timer 节点会被对象池复用，通过 sequence 区分，过期的 TimerId 取消时会被忽略
+ */
+class TimerId {
+  public:
+    TimerId() : timer_(nullptr), sequence_(0) {}
+    TimerId(Timer *timer, int64_t seq) : timer_(timer), sequence_(seq) {}
+
+    // default copy-ctor, dtor and assignment are okay
+
+    friend class TimerQueue;
+
+  private:
+    Timer *timer_;
+    int64_t sequence_;
+};
@@ -0,0 +1,359 @@
+#define MUDUO_LOG_MODULE kLogModuleLoop
+
+#include "TimerQueue.h"
+
+#include "EventLoop.h"
+#include "Logger.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t kTimerChunkSize = 1024;  // 对象池每次分配的节点数
+
+int createTimerfd() {
+    int timerfd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerfd < 0) {
+        LOG_FATAL("TimerQueue createTimerfd() - timerfd_create error: %d", errno);
+    }
+    return timerfd;
+}
+
+// 向上取整，保证定时器不会提前触发
+int64_t ceilTick(Timestamp when, int tickMicroSeconds) {
+    return (when.microSecondsSinceEpoch() + tickMicroSeconds - 1) / tickMicroSeconds;
+}
+
+void listPushBack(TimerListNode *head, TimerListNode *node) {
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+void listRemove(TimerListNode *node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node;
+    node->next = node;
+}
+
+// 把 from 整条链表摘到 to 上，from 置空
+void listSplice(TimerListNode *from, TimerListNode *to) {
+    if (from->empty()) {
+        return;
+    }
+    to->next = from->next;
+    to->prev = from->prev;
+    to->next->prev = to;
+    to->prev->next = to;
+    from->next = from;
+    from->prev = from;
+}
+
+}  // namespace
+
+TimerQueue::TimerQueue(EventLoop *loop)
+    : loop_(loop)
+    , timerfd_(createTimerfd())
+    , timerfdChannel_(loop, timerfd_)
+    , currentTick_(Timestamp::now().microSecondsSinceEpoch() / kTickMicroSeconds)
+    , armedTick_(-1)
+    , size_(0)
+    , runningTimer_(nullptr)
+    , runningTimerCanceled_(false)
+    , freeList_(nullptr)
+    , nextSequence_(0) {
+    memset(level0Bitmap_, 0, sizeof(level0Bitmap_));
+    memset(levelCount_, 0, sizeof(levelCount_));
+
+    timerfdChannel_.setReadCallback(std::bind(&TimerQueue::handleRead, this));
+    timerfdChannel_.enableReading();
+}
+
+TimerQueue::~TimerQueue() {
+    timerfdChannel_.disableAll();
+    timerfdChannel_.remove();
+    ::close(timerfd_);
+    // Timer 节点都在 chunks_ 中，随 chunks_ 一起释放
+}
+
+TimerId TimerQueue::addTimer(TimerCallback cb, Timestamp when, double interval) {
+    Timer *timer = allocTimer();
+    timer->callback_ = std::move(cb);
+    timer->expiration_ = when;
+    timer->interval_ = interval;
+    timer->repeat_ = interval > 0.0;
+
+    //!NOTE: sequence 要在 runInLoop 之前取出来，否则 loop 线程可能已经触发并复用了这个节点
+    TimerId timerId(timer, timer->sequence_);
+    loop_->runInLoop(std::bind(&TimerQueue::addTimerInLoop, this, timer));
+    return timerId;
+}
+
+void TimerQueue::cancel(TimerId timerId) { loop_->runInLoop(std::bind(&TimerQueue::cancelInLoop, this, timerId)); }
+
+void TimerQueue::addTimerInLoop(Timer *timer) {
+    // 时间轮为空时直接对齐到当前时间，避免 loop 长时间阻塞后 currentTick_ 过旧
+    if (size_ == 0 && runningTimer_ == nullptr) {
+        int64_t nowTick = Timestamp::now().microSecondsSinceEpoch() / kTickMicroSeconds;
+        if (nowTick > currentTick_) {
+            currentTick_ = nowTick;
+        }
+    }
+
+    timer->expirationTick_ = ceilTick(timer->expiration_, kTickMicroSeconds);
+    insert(timer, currentTick_ + 1);
+
+    int64_t next = nextEventTick();
+    if (armedTick_ < 0 || next < armedTick_) {
+        resetTimerfd(next);
+    }
+}
+
+void TimerQueue::cancelInLoop(TimerId timerId) {
+    Timer *timer = timerId.timer_;
+    if (timer == nullptr || timer->sequence_ != timerId.sequence_) {
+        return;  // 已经触发或者已经取消，节点可能被复用了
+    }
+
+    if (timer == runningTimer_) {
+        // 在自己的回调里取消周期定时器，回调结束后不再重新插入
+        runningTimerCanceled_ = true;
+    } else if (timer->next != timer) {
+        unlink(timer);
+        freeTimer(timer);
+    }
+}
+
+void TimerQueue::handleRead() {
+    uint64_t howmany = 0;
+    ssize_t n = ::read(timerfd_, &howmany, sizeof(howmany));
+    if (n != sizeof(howmany)) {
+        LOG_ERROR("TimerQueue::handleRead() - reads %ld bytes instead of 8", n);
+    }
+
+    Timestamp now(Timestamp::now());
+    armedTick_ = -1;
+    advanceTo(now.microSecondsSinceEpoch() / kTickMicroSeconds, now);
+
+    int64_t next = nextEventTick();
+    if (next >= 0) {
+        resetTimerfd(next);
+    }
+}
+
+/**
+ * 根据到期 tick 和 currentTick_ 的距离选择层级，槽位下标用绝对 tick 计算
+ * earliest 是允许放入的最早 tick：正常插入是 currentTick_ + 1（当前 tick 已经处理过了），
+ * cascade 时是正在处理的 tick，刚好到期的定时器放回 level 0 当前槽位，紧接着就会被处理
+ */
+void TimerQueue::insert(Timer *timer, int64_t earliest) {
+    int64_t when = timer->expirationTick_ < earliest ? earliest : timer->expirationTick_;
+    int64_t delta = when - currentTick_;
+    if (delta >= kMaxTicks) {  // 超出时间轮范围，先放在最高层最远的槽位，cascade 时重新计算
+        when = currentTick_ + kMaxTicks - 1;
+        delta = kMaxTicks - 1;
+    }
+
+    int level = 0;
+    int idx = 0;
+    if (delta < kLevel0Slots) {
+        idx = static_cast<int>(when & (kLevel0Slots - 1));
+        level0Bitmap_[idx >> 6] |= 1ULL << (idx & 63);
+    } else {
+        int shift = kLevel0Bits;
+        level = 1;
+        while (delta >= (1LL << (shift + kLevelBits))) {
+            shift += kLevelBits;
+            ++level;
+        }
+        idx = static_cast<int>((when >> shift) & (kLevelSlots - 1));
+    }
+
+    timer->level_ = level;
+    timer->slot_ = idx;
+    listPushBack(&slot(level, idx), timer);
+    ++levelCount_[level];
+    ++size_;
+}
+
+void TimerQueue::unlink(Timer *timer) {
+    listRemove(timer);
+    if (timer->level_ >= 0) {
+        --levelCount_[timer->level_];
+        if (timer->level_ == 0 && level0_[timer->slot_].empty()) {
+            level0Bitmap_[timer->slot_ >> 6] &= ~(1ULL << (timer->slot_ & 63));
+        }
+    }
+    timer->level_ = -1;
+    timer->slot_ = -1;
+    --size_;
+}
+
+// 低层转完一圈，把上层对应槽位的定时器重新插入（向下一层或者直接到 level 0）
+void TimerQueue::cascade(int64_t tick) {
+    int shift = kLevel0Bits;
+    for (int level = 1; level < kLevels; ++level, shift += kLevelBits) {
+        if ((tick & ((1LL << shift) - 1)) != 0) {
+            break;
+        }
+        int idx = static_cast<int>((tick >> shift) & (kLevelSlots - 1));
+        TimerListNode pending;
+        listSplice(&slot(level, idx), &pending);
+        while (!pending.empty()) {
+            Timer *timer = static_cast<Timer *>(pending.next);
+            listRemove(timer);
+            --levelCount_[level];
+            --size_;
+            insert(timer, tick);
+        }
+    }
+}
+
+void TimerQueue::processTick(int64_t tick, Timestamp now) {
+    currentTick_ = tick;
+    cascade(tick);
+
+    int idx = static_cast<int>(tick & (kLevel0Slots - 1));
+    level0Bitmap_[idx >> 6] &= ~(1ULL << (idx & 63));
+
+    // 先摘到局部链表上再执行回调，回调里 cancel 同一批的定时器也是安全的
+    TimerListNode expired;
+    listSplice(&level0_[idx], &expired);
+    for (TimerListNode *node = expired.next; node != &expired; node = node->next) {
+        static_cast<Timer *>(node)->level_ = -1;
+        --levelCount_[0];
+    }
+
+    while (!expired.empty()) {
+        Timer *timer = static_cast<Timer *>(expired.next);
+        unlink(timer);
+
+        runningTimer_ = timer;
+        runningTimerCanceled_ = false;
+        timer->run();
+        runningTimer_ = nullptr;
+
+        if (timer->repeat_ && !runningTimerCanceled_) {
+            timer->expiration_ = addTime(now, timer->interval_);
+            timer->expirationTick_ = ceilTick(timer->expiration_, kTickMicroSeconds);
+            insert(timer, currentTick_ + 1);
+        } else {
+            freeTimer(timer);
+        }
+    }
+}
+
+// 逐个处理有事件的 tick，中间没有定时器也没有 cascade 的 tick 直接跳过
+void TimerQueue::advanceTo(int64_t targetTick, Timestamp now) {
+    while (currentTick_ < targetTick) {
+        int64_t next = nextEventTick();
+        if (next < 0 || next > targetTick) {
+            currentTick_ = targetTick;
+            break;
+        }
+        processTick(next, now);
+    }
+}
+
+/**
+ * 下一个需要处理的 tick:
+ * 1. level 0 中 currentTick_ 之后第一个非空槽位
+ * 2. 上层非空时，还要在 level 0 转完一圈（低 8 位为 0）的 tick 做 cascade
+ */
+int64_t TimerQueue::nextEventTick() const {
+    if (size_ == 0) {
+        return -1;
+    }
+
+    int64_t first = currentTick_ + 1;
+    int start = static_cast<int>(first & (kLevel0Slots - 1));
+    int64_t next = -1;
+
+    int idx = findLevel0Slot(start);
+    if (idx >= 0) {
+        next = first + (idx - start);
+    }
+
+    bool upperLevelsEmpty = true;
+    for (int level = 1; level < kLevels; ++level) {
+        if (levelCount_[level] != 0) {
+            upperLevelsEmpty = false;
+            break;
+        }
+    }
+
+    if (idx < 0 || !upperLevelsEmpty) {
+        int64_t boundary = (start == 0) ? first : ((first >> kLevel0Bits) + 1) << kLevel0Bits;
+        if (next < 0 || boundary < next) {
+            next = boundary;
+        }
+    }
+    return next;
+}
+
+// 在位图中查找下标 >= start 的第一个非空槽位
+int TimerQueue::findLevel0Slot(int start) const {
+    int word = start >> 6;
+    uint64_t bits = level0Bitmap_[word] & (~0ULL << (start & 63));
+    while (true) {
+        if (bits != 0) {
+            return (word << 6) + __builtin_ctzll(bits);
+        }
+        if (++word == kLevel0Slots / 64) {
+            return -1;
+        }
+        bits = level0Bitmap_[word];
+    }
+}
+
+// timerfd 使用相对时间，设置到 tick 对应的时间点
+void TimerQueue::resetTimerfd(int64_t tick) {
+    armedTick_ = tick;
+
+    int64_t microseconds = tick * kTickMicroSeconds - Timestamp::now().microSecondsSinceEpoch();
+    if (microseconds < 100) {
+        microseconds = 100;
+    }
+
+    struct itimerspec newValue;
+    memset(&newValue, 0, sizeof(newValue));
+    newValue.it_value.tv_sec = static_cast<time_t>(microseconds / Timestamp::kMicroSecondsPerSecond);
+    newValue.it_value.tv_nsec = static_cast<long>((microseconds % Timestamp::kMicroSecondsPerSecond) * 1000);
+    if (::timerfd_settime(timerfd_, 0, &newValue, NULL) < 0) {
+        LOG_ERROR("TimerQueue::resetTimerfd() - timerfd_settime error: %d", errno);
+    }
+}
+
+Timer *TimerQueue::allocTimer() {
+    std::unique_lock<std::mutex> lock(poolMutex_);
+    if (freeList_ == nullptr) {
+        Timer *chunk = new Timer[kTimerChunkSize];
+        chunks_.push_back(std::unique_ptr<Timer[]>(chunk));
+        for (size_t i = 0; i < kTimerChunkSize; ++i) {
+            chunk[i].next = freeList_;
+            freeList_ = &chunk[i];
+        }
+    }
+
+    Timer *timer = freeList_;
+    freeList_ = static_cast<Timer *>(timer->next);
+    timer->next = timer;
+    timer->prev = timer;
+    timer->sequence_ = ++nextSequence_;
+    return timer;
+}
+
+void TimerQueue::freeTimer(Timer *timer) {
+    TimerCallback cb;
+    cb.swap(timer->callback_);  // 在锁外析构回调，回调里可能捕获了 shared_ptr
+
+    std::unique_lock<std::mutex> lock(poolMutex_);
+    timer->sequence_ = 0;
+    timer->next = freeList_;
+    freeList_ = timer;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Callbacks.h"
+#include "Channel.h"
+#include "Timer.h"
+#include "TimerId.h"
+#include "Timestamp.h"
+#include "noncopyable.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class EventLoop;
+
+/**
+ * 每个 EventLoop 一个 TimerQueue，底层一个 timerfd，和 wakeupChannel 一样注册到 Poller 上
+ *
+ * 定时器存放在分层时间轮里（tick = 1ms）:
+ *   level 0: 256 个槽位，覆盖 [0, 2^8) 个 tick
+ *   level 1~4: 每层 64 个槽位，依次覆盖到 2^14, 2^20, 2^26, 2^32 个 tick（约 49 天）
+ * 插入和取消都是链表操作 O(1)，上层槽位在低层转完一圈时向下 cascade
+ * timerfd 只设置到下一个有事件的 tick，没有定时器时不会唤醒 loop
+ */
+class TimerQueue : noncopyable {
+  public:
+    explicit TimerQueue(EventLoop *loop);
+    ~TimerQueue();
+
+    // 可以跨线程调用
+    TimerId addTimer(TimerCallback cb, Timestamp when, double interval);
+    void cancel(TimerId timerId);
+
+    // 当前挂在时间轮上的定时器数量，只能在 loop 线程调用
+    size_t size() const { return size_; }
+
+  private:
+    static const int kTickMicroSeconds = 1000;
+    static const int kLevels = 5;
+    static const int kLevel0Bits = 8;
+    static const int kLevelBits = 6;
+    static const int kLevel0Slots = 1 << kLevel0Bits;
+    static const int kLevelSlots = 1 << kLevelBits;
+    static const int64_t kMaxTicks = 1LL << (kLevel0Bits + (kLevels - 1) * kLevelBits);
+
+    void addTimerInLoop(Timer *timer);
+    void cancelInLoop(TimerId timerId);
+
+    void handleRead();  // timerfd 可读，推进时间轮
+
+    // 时间轮操作
+    void insert(Timer *timer, int64_t earliest);
+    void unlink(Timer *timer);
+    void cascade(int64_t tick);
+    void processTick(int64_t tick, Timestamp now);
+    void advanceTo(int64_t targetTick, Timestamp now);
+    int64_t nextEventTick() const;  // 下一个需要处理的 tick，-1 表示没有定时器
+    int findLevel0Slot(int start) const;
+
+    TimerListNode &slot(int level, int idx) {
+        return level == 0 ? level0_[idx] : levels_[level - 1][idx];
+    }
+
+    void resetTimerfd(int64_t tick);
+
+    // 对象池，跨线程 addTimer 时在调用线程分配，所以需要加锁
+    Timer *allocTimer();
+    void freeTimer(Timer *timer);
+
+    EventLoop *loop_;
+    const int timerfd_;
+    Channel timerfdChannel_;
+
+    TimerListNode level0_[kLevel0Slots];
+    TimerListNode levels_[kLevels - 1][kLevelSlots];
+    uint64_t level0Bitmap_[kLevel0Slots / 64];  // level 0 非空槽位的位图
+    size_t levelCount_[kLevels];                // 每层的定时器数量
+
+    int64_t currentTick_;  // 已经处理到的 tick
+    int64_t armedTick_;    // timerfd 设置的 tick，-1 表示没有设置
+    size_t size_;
+
+    Timer *runningTimer_;  // 正在执行回调的定时器
+    bool runningTimerCanceled_;
+
+    std::mutex poolMutex_;
+    std::vector<std::unique_ptr<Timer[]>> chunks_;
+    Timer *freeList_;
+    int64_t nextSequence_;
+};
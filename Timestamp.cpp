@@ -1,31 +1,61 @@
 #include "Timestamp.h"
 
-#include <time.h>
+#include <stdio.h>
+#include <sys/time.h>
 
-Timestamp::Timestamp() : secondsSinceEpoch_(0) {}
-
-Timestamp::Timestamp(int64_t microSecondsSinceEpoch) : secondsSinceEpoch_(microSecondsSinceEpoch) {}
-
-Timestamp Timestamp::now() { return Timestamp(time(NULL)); }
+//!NOTE: gettimeofday 走 vdso，不会陷入内核，精度为微秒
+Timestamp Timestamp::now() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    int64_t seconds = tv.tv_sec;
+    return Timestamp(seconds * kMicroSecondsPerSecond + tv.tv_usec);
+}
 
 std::string Timestamp::toString() const {
     char buf[128] = {0};
-    //!NOTE: localtime 参数是秒数，time(NULL) 返回的也是秒数
-    tm *tm_time = localtime(&secondsSinceEpoch_);
+    time_t seconds = secondsSinceEpoch();
+    struct tm tm_time;
+    localtime_r(&seconds, &tm_time);  // localtime 不是线程安全的
     snprintf(buf,
              128,
              "%4d/%02d/%02d %02d:%02d:%02d",
-             tm_time->tm_year + 1900,
-             tm_time->tm_mon + 1,
-             tm_time->tm_mday,
-             tm_time->tm_hour,
-             tm_time->tm_min,
-             tm_time->tm_sec);
+             tm_time.tm_year + 1900,
+             tm_time.tm_mon + 1,
+             tm_time.tm_mday,
+             tm_time.tm_hour,
+             tm_time.tm_min,
+             tm_time.tm_sec);
     return buf;
 }
 
-// int main()
-// {
-//     std::cout << Timestamp::now().toString() << std::endl;
-//     return 0;
-// }
+std::string Timestamp::toFormattedString(bool showMicroseconds) const {
+    char buf[64] = {0};
+    time_t seconds = secondsSinceEpoch();
+    struct tm tm_time;
+    gmtime_r(&seconds, &tm_time);
+
+    if (showMicroseconds) {
+        int microseconds = static_cast<int>(microSecondsSinceEpoch_ % kMicroSecondsPerSecond);
+        snprintf(buf,
+                 sizeof(buf),
+                 "%4d%02d%02d %02d:%02d:%02d.%06d",
+                 tm_time.tm_year + 1900,
+                 tm_time.tm_mon + 1,
+                 tm_time.tm_mday,
+                 tm_time.tm_hour,
+                 tm_time.tm_min,
+                 tm_time.tm_sec,
+                 microseconds);
+    } else {
+        snprintf(buf,
+                 sizeof(buf),
+                 "%4d%02d%02d %02d:%02d:%02d",
+                 tm_time.tm_year + 1900,
+                 tm_time.tm_mon + 1,
+                 tm_time.tm_mday,
+                 tm_time.tm_hour,
+                 tm_time.tm_min,
+                 tm_time.tm_sec);
+    }
+    return buf;
+}
@@ -1,17 +1,55 @@
 #pragma once
 
+#include <stdint.h>
+#include <time.h>
+
 #include <iostream>
 #include <string>
 
-// 时间类
+/**
+ * 时间类，微秒精度（UTC 起始的微秒数）
+ * 对象不可变，只有一个 int64_t 成员，建议按值传递
+ */
 class Timestamp {
   private:
-    int64_t secondsSinceEpoch_;
+    int64_t microSecondsSinceEpoch_;
 
   public:
-    Timestamp();
-    explicit Timestamp(int64_t secondsSinceEpoch);
+    Timestamp() : microSecondsSinceEpoch_(0) {}
+    explicit Timestamp(int64_t microSecondsSinceEpoch) : microSecondsSinceEpoch_(microSecondsSinceEpoch) {}
 
     static Timestamp now();
+    static Timestamp invalid() { return Timestamp(); }
+
+    // 本地时间 "YYYY/MM/DD hh:mm:ss"，日志使用
     std::string toString() const;
+    // UTC 时间 "YYYYMMDD hh:mm:ss.uuuuuu"
+    std::string toFormattedString(bool showMicroseconds = true) const;
+
+    bool valid() const { return microSecondsSinceEpoch_ > 0; }
+
+    int64_t microSecondsSinceEpoch() const { return microSecondsSinceEpoch_; }
+    time_t secondsSinceEpoch() const { return static_cast<time_t>(microSecondsSinceEpoch_ / kMicroSecondsPerSecond); }
+
+    static const int kMicroSecondsPerSecond = 1000 * 1000;
 };
+
+inline bool operator<(Timestamp lhs, Timestamp rhs) {
+    return lhs.microSecondsSinceEpoch() < rhs.microSecondsSinceEpoch();
+}
+
+inline bool operator==(Timestamp lhs, Timestamp rhs) {
+    return lhs.microSecondsSinceEpoch() == rhs.microSecondsSinceEpoch();
+}
+
+// 两个时间点的差值，单位秒
+inline double timeDifference(Timestamp high, Timestamp low) {
+    int64_t diff = high.microSecondsSinceEpoch() - low.microSecondsSinceEpoch();
+    return static_cast<double>(diff) / Timestamp::kMicroSecondsPerSecond;
+}
+
+// timestamp + seconds
+inline Timestamp addTime(Timestamp timestamp, double seconds) {
+    int64_t delta = static_cast<int64_t>(seconds * Timestamp::kMicroSecondsPerSecond);
+    return Timestamp(timestamp.microSecondsSinceEpoch() + delta);
+}
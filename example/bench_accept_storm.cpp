@@ -0,0 +1,125 @@
+#include <mymuduo/Acceptor.h>
+#include <mymuduo/EventLoop.h>
+#include <mymuduo/InetAddress.h>
+#include <mymuduo/Logger.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vector>
+
+// 连接风暴: 客户端进程每一轮非阻塞 connect burst 个连接，然后全部关掉，不停地重复
+// 1. 服务端 accept 之后马上关闭，统计每秒 accept 的连接数、每个连接的 poll 次数和 CPU
+// 2. 服务端保留所有连接直到 fd 用完（RLIMIT_NOFILE = 256），统计 seconds 秒内丢弃的连接数和 CPU，
+//    EMFILE 时没有把连接从 backlog 里取出来的话 listenfd 一直可读，loop 会空转
+// ./bench_accept_storm [maxAcceptsPerEvent] [burst] [seconds]
+
+static const rlim_t kFdLimit = 256;
+
+static double cpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);  // 只统计服务端进程
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void runStormClient(const InetAddress &addr, int burst) {
+    std::vector<int> fds;
+    while (true) {
+        for (int i = 0; i < burst; ++i) {
+            int sockfd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            ::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in));
+            fds.push_back(sockfd);
+        }
+        for (int sockfd : fds) {
+            ::close(sockfd);
+        }
+        fds.clear();
+        ::usleep(1000);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int maxAccepts = argc > 1 ? atoi(argv[1]) : 64;
+    int burst = argc > 2 ? atoi(argv[2]) : 256;
+    int seconds = argc > 3 ? atoi(argv[3]) : 3;
+
+    Logger::setLogLevel(FATAL);  // EMFILE 的日志不计入
+    EventLoop loop;
+    InetAddress addr(9996);
+    Acceptor acceptor(&loop, addr, false);
+    acceptor.setMaxAcceptsPerEvent(maxAccepts);
+
+    bool holding = false;
+    std::vector<int> held;
+    acceptor.setNewConnectionCallback([&](int sockfd, const InetAddress &) {
+        if (holding) {
+            held.push_back(sockfd);
+        } else {
+            ::close(sockfd);
+        }
+    });
+    acceptor.listen();
+
+    pid_t child = ::fork();
+    if (child == 0) {
+        runStormClient(addr, burst);
+        return 0;
+    }
+
+    uint64_t startAccepted = 0;
+    uint64_t startPolls = 0;
+    double startCpu = 0;
+    loop.runAfter(1.0, [&] {
+        startAccepted = acceptor.acceptedCount();
+        startPolls = loop.pollCount();
+        startCpu = cpuSeconds();
+    });
+    loop.runAfter(1.0 + seconds, [&] {
+        double accepted = static_cast<double>(acceptor.acceptedCount() - startAccepted);
+        printf("cap %3d  burst %4d  storm: %9.0f accepts/s   %.3f polls/accept   server CPU %5.2f us/accept\n",
+               maxAccepts,
+               burst,
+               accepted / seconds,
+               (loop.pollCount() - startPolls) / accepted,
+               (cpuSeconds() - startCpu) * 1e6 / accepted);
+
+        struct rlimit limit;
+        ::getrlimit(RLIMIT_NOFILE, &limit);
+        limit.rlim_cur = kFdLimit;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+        holding = true;
+    });
+
+    uint64_t startDropped = 0;
+    loop.runAfter(2.0 + seconds, [&] {
+        startDropped = acceptor.droppedCount();
+        startPolls = loop.pollCount();
+        startCpu = cpuSeconds();
+    });
+    loop.runAfter(2.0 + 2 * seconds, [&] {
+        printf("cap %3d  burst %4d  EMFILE: %9.0f drops/s     %8.0f polls/s   server CPU %5.1f%%  (%zu held)\n",
+               maxAccepts,
+               burst,
+               static_cast<double>(acceptor.droppedCount() - startDropped) / seconds,
+               static_cast<double>(loop.pollCount() - startPolls) / seconds,
+               (cpuSeconds() - startCpu) * 100 / seconds,
+               held.size());
+        loop.quit();
+    });
+    loop.loop();
+
+    ::kill(child, SIGKILL);
+    ::waitpid(child, nullptr, 0);
+    for (int sockfd : held) {
+        ::close(sockfd);
+    }
+    return 0;
+}
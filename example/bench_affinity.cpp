@@ -0,0 +1,133 @@
+#include <mymuduo/CpuAffinity.h>
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// subLoop 绑核（每个物理核一个 loop，MPOL_LOCAL）和不绑核的 echo 吞吐以及 p99 延迟
+// 客户端 fork 到另一个进程，每个连接一问一答，请求里带上发送时间，客户端统计往返延迟；先预热 1 秒再统计 seconds 秒
+// ./bench_affinity [on|off] [numLoops] [numConnections] [messageBytes] [seconds]
+
+static int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp) { conn->send(buf); }
+
+static void runClients(const InetAddress &addr, const std::string &mode, int numLoops, int numConnections,
+                       size_t messageBytes, int seconds) {
+    int epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    std::string message(std::max(messageBytes, sizeof(int64_t)), 'm');
+    std::vector<size_t> received(numConnections + 1024, 0);
+    std::vector<int64_t> sentAt(numConnections + 1024, 0);
+    for (int i = 0; i < numConnections; ++i) {
+        int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+            perror("connect");
+            exit(1);
+        }
+        if (static_cast<size_t>(sockfd) >= received.size()) {
+            received.resize(sockfd + 1, 0);
+            sentAt.resize(sockfd + 1, 0);
+        }
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = sockfd;
+        ::epoll_ctl(epfd, EPOLL_CTL_ADD, sockfd, &ev);
+        sentAt[sockfd] = nowNs();
+        if (::write(sockfd, message.data(), message.size()) != static_cast<ssize_t>(message.size())) {
+            exit(1);
+        }
+    }
+
+    std::vector<int64_t> latencies;
+    latencies.reserve(1 << 22);
+    int64_t start = nowNs() + 1000000000LL;
+    int64_t end = start + seconds * 1000000000LL;
+    std::vector<struct epoll_event> events(1024);
+    char buf[64 * 1024];
+    int64_t now = 0;
+    while ((now = nowNs()) < end) {
+        int n = ::epoll_wait(epfd, events.data(), static_cast<int>(events.size()), 100);
+        for (int i = 0; i < n; ++i) {
+            int sockfd = events[i].data.fd;
+            ssize_t nread = ::read(sockfd, buf, sizeof(buf));
+            if (nread <= 0) {
+                exit(1);
+            }
+            received[sockfd] += nread;
+            if (received[sockfd] >= message.size()) {
+                received[sockfd] -= message.size();
+                int64_t done = nowNs();
+                if (done >= start) {
+                    latencies.push_back(done - sentAt[sockfd]);
+                }
+                sentAt[sockfd] = done;
+                if (::write(sockfd, message.data(), message.size()) != static_cast<ssize_t>(message.size())) {
+                    exit(1);
+                }
+            }
+        }
+    }
+
+    size_t count = latencies.size();
+    std::sort(latencies.begin(), latencies.end());
+    printf("pinning %-3s %2d loops  %4d connections  %zu bytes: %9.0f requests/s   p50 %6.0f us   p99 %6.0f us\n",
+           mode.c_str(),
+           numLoops,
+           numConnections,
+           messageBytes,
+           static_cast<double>(count) / seconds,
+           count > 0 ? latencies[count / 2] / 1000.0 : 0,
+           count > 0 ? latencies[count * 99 / 100] / 1000.0 : 0);
+}
+
+int main(int argc, char *argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "on";
+    int numLoops = argc > 2 ? atoi(argv[2]) : static_cast<int>(CpuAffinity::physicalCores().size());
+    int numConnections = argc > 3 ? atoi(argv[3]) : 100;
+    size_t messageBytes = argc > 4 ? atoi(argv[4]) : 64;
+    int seconds = argc > 5 ? atoi(argv[5]) : 5;
+
+    Logger::setLogLevel(FATAL);  // 结束时客户端进程退出，连接关闭的日志不输出
+    EventLoop loop;
+    InetAddress addr(9998);
+    TcpServer server(&loop, addr, "AffinityBench");
+    server.setConnectionCallback([](const TcpConnectionPtr &) {});
+    server.setMessageCallback(onMessage);
+    server.setThreadNum(numLoops);
+    if (mode == "on") {
+        server.setCpuAffinityPerPhysicalCore();
+    }
+    server.start();
+
+    pid_t child = ::fork();
+    if (child == 0) {
+        runClients(addr, mode, numLoops, numConnections, messageBytes, seconds);
+        fflush(stdout);
+        ::_exit(0);  // 子进程里没有 loop 线程，不能析构 server
+    }
+
+    // 客户端统计完自己退出
+    loop.runEvery(0.1, [&] {
+        if (::waitpid(child, nullptr, WNOHANG) == child) {
+            loop.quit();
+        }
+    });
+    loop.loop();
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <mymuduo/EventLoopThread.h>
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// ping-pong 延迟: 一个连接，客户端发 messageBytes 字节，收到回显之后再发下一条，统计往返延迟的 p50 / p99 / p999
+// hop = 1 时服务端把回显交给另一个 loop（backend）再由它 conn->send，多两次跨线程交接（queueInLoop + eventfd）
+// block: 原来的阻塞 poll；spin: 所有 loop setBusyPoll(budgetUs)，可选 SO_BUSY_POLL
+// 客户端 fork 到另一个进程，阻塞 read / write
+// ./bench_busy_poll [block|spin] [hop] [budgetUs] [socketBusyPollUs] [seconds] [messageBytes]
+
+static EventLoop *g_backend = nullptr;
+
+static int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sendBack(const TcpConnectionPtr &conn, const std::string &message) { conn->send(message); }
+
+static void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp) {
+    if (g_backend == nullptr) {
+        conn->send(buf);
+        return;
+    }
+    g_backend->queueInLoop(std::bind(sendBack, conn, buf->retrieveAllAsString()));
+}
+
+static void runClient(const InetAddress &addr, const std::string &mode, int hop, int seconds, size_t messageBytes) {
+    int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+        perror("connect");
+        exit(1);
+    }
+    std::string message(messageBytes, 'p');
+    std::vector<char> buf(messageBytes);
+    std::vector<int64_t> latencies;
+    latencies.reserve(1 << 22);
+    int64_t start = nowNs() + 1000000000LL;  // 预热 1 秒
+    int64_t end = start + seconds * 1000000000LL;
+    int64_t now = 0;
+    while ((now = nowNs()) < end) {
+        if (::write(sockfd, message.data(), message.size()) != static_cast<ssize_t>(message.size())) {
+            exit(1);
+        }
+        size_t received = 0;
+        while (received < messageBytes) {
+            ssize_t n = ::read(sockfd, buf.data() + received, messageBytes - received);
+            if (n <= 0) {
+                exit(1);
+            }
+            received += n;
+        }
+        if (now >= start) {
+            latencies.push_back(nowNs() - now);
+        }
+    }
+
+    size_t count = latencies.size();
+    std::sort(latencies.begin(), latencies.end());
+    printf("%-5s hop %d: %8.0f round trips/s   p50 %7.1f us   p99 %7.1f us   p999 %7.1f us\n",
+           mode.c_str(),
+           hop,
+           static_cast<double>(count) / seconds,
+           count > 0 ? latencies[count / 2] / 1000.0 : 0,
+           count > 0 ? latencies[count * 99 / 100] / 1000.0 : 0,
+           count > 0 ? latencies[count * 999 / 1000] / 1000.0 : 0);
+    fflush(stdout);
+}
+
+static void printStats(const char *name, EventLoop *loop) {
+    EventLoop::BusyPollStats stats = loop->busyPollStats();
+    printf("      %-8s spin polls %10lu   spin wakeups %8lu   sleeps %8lu   skipped eventfd writes %8lu\n",
+           name,
+           stats.spinPolls,
+           stats.spinWakeups,
+           stats.sleeps,
+           stats.skippedWakeups);
+}
+
+int main(int argc, char *argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "spin";
+    int hop = argc > 2 ? atoi(argv[2]) : 1;
+    int64_t budgetUs = argc > 3 ? atoi(argv[3]) : 200;
+    int socketBusyPollUs = argc > 4 ? atoi(argv[4]) : 0;
+    int seconds = argc > 5 ? atoi(argv[5]) : 5;
+    size_t messageBytes = argc > 6 ? atoi(argv[6]) : 64;
+
+    Logger::setLogLevel(FATAL);  // 结束时客户端进程退出，连接关闭的日志不输出
+    EventLoop loop;
+    EventLoopThread backendThread(EventLoopThread::ThreadInitCallback(), "backend");
+    if (hop) {
+        g_backend = backendThread.startLoop();
+    }
+    InetAddress addr(9999);
+    TcpServer server(&loop, addr, "BusyPollBench");
+    server.setConnectionCallback([](const TcpConnectionPtr &) {});
+    server.setMessageCallback(onMessage);
+    server.setThreadNum(1);
+    if (mode == "spin") {
+        server.setBusyPoll(budgetUs, socketBusyPollUs);
+        if (g_backend != nullptr) {
+            g_backend->runInLoop(std::bind(&EventLoop::setBusyPoll, g_backend, budgetUs, 0));
+        }
+    }
+    EventLoop *ioLoop = nullptr;
+    server.setThreadInitCallback([&ioLoop](EventLoop *loop) { ioLoop = loop; });
+    server.start();
+
+    pid_t child = ::fork();
+    if (child == 0) {
+        runClient(addr, mode, hop, seconds, messageBytes);
+        ::_exit(0);  // 子进程里没有 loop 线程，不能析构 server
+    }
+
+    // 客户端统计完自己退出
+    loop.runEvery(0.1, [&] {
+        if (::waitpid(child, nullptr, WNOHANG) == child) {
+            loop.quit();
+        }
+    });
+    loop.loop();
+
+    if (mode == "spin") {
+        // 统计只能在 loop 线程读取，停下来之前各自打印
+        ioLoop->runInLoop(std::bind(printStats, "io", ioLoop));
+        if (g_backend != nullptr) {
+            g_backend->runInLoop(std::bind(printStats, "backend", g_backend));
+        }
+        ::usleep(100 * 1000);
+    }
+    return 0;
+}
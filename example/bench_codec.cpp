@@ -0,0 +1,176 @@
+#include <mymuduo/Crc32c.h>
+#include <mymuduo/EventLoopThread.h>
+#include <mymuduo/LengthHeaderCodec.h>
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpClient.h>
+#include <mymuduo/TcpServer.h>
+
+#include <endian.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+// LengthHeaderCodec 每秒收发的消息数，fork 出来的子进程发送，父进程的 TcpServer 用 codec 解帧并计数
+// concat: 消息体先序列化成 string，再和头部拼接成一个新的 string 发送（原来的写法）
+// prepend: 消息体直接写进复用的 Buffer，codec.send 原地 prepend 头部之后发送
+// crc / nocrc: 是否带 CRC32C 校验和；另外单独测一下 CRC32C 硬件和查表实现的速度
+// ./bench_codec [seconds] [payloadBytes...]
+
+static const uint16_t kPort = 9986;
+static const int kBatch = 64;  // 每轮发送的消息数
+
+static double nowSec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void benchCrc() {
+    std::string data(4096, 'c');
+    for (int hardware = 1; hardware >= 0; --hardware) {
+        Crc32c::setHardware(hardware);
+        const int iterations = 200000;
+        uint32_t crc = 0;
+        double start = nowSec();
+        for (int i = 0; i < iterations; ++i) {
+            crc = Crc32c::extend(crc, data.data(), data.size());
+        }
+        double elapsed = nowSec() - start;
+        printf("crc32c %-8s 4 KiB: %6.2f GB/s (%08x)\n",
+               Crc32c::hardware() ? "sse4.2" : "table",
+               data.size() * static_cast<double>(iterations) / elapsed / 1e9,
+               crc);
+    }
+    Crc32c::setHardware(true);
+}
+
+// 子进程：一个 loop 线程上的 TcpClient，每次输出缓冲区发完之后再发 kBatch 个消息
+//!NOTE: 直接写完的 send 每次都会排一个 writeComplete，同一轮 loop 里的多个 writeComplete 只补发一批，
+// 否则每个 writeComplete 都再发 kBatch 个，outputBuffer_ 会越积越多，测的就是内存拷贝而不是 codec
+static void runSender(bool prepend, bool checksum, size_t payloadBytes, double seconds) {
+    EventLoopThread thread;
+    EventLoop *loop = thread.startLoop();
+    const std::string payload(payloadBytes, 'p');
+    LengthHeaderCodec codec([](const TcpConnectionPtr &, const StringPiece &, Timestamp) {}, checksum);
+    Buffer message;
+
+    auto pump = [&](const TcpConnectionPtr &conn) {
+        for (int i = 0; i < kBatch; ++i) {
+            if (prepend) {
+                message.append(payload.data(), payload.size());
+                codec.send(conn, &message);
+            } else {
+                std::string body(payload.data(), payload.size());  // 序列化出来的消息体
+                uint32_t len = htobe32(static_cast<uint32_t>(body.size()));
+                std::string header(reinterpret_cast<const char *>(&len), sizeof len);
+                if (checksum) {
+                    uint32_t crc = Crc32c::extend(Crc32c::value(header.data(), header.size()), body.data(), body.size());
+                    crc = htobe32(crc);
+                    header.append(reinterpret_cast<const char *>(&crc), sizeof crc);
+                }
+                conn->send(header + body);
+            }
+        }
+    };
+
+    TcpClient client(loop, InetAddress(kPort), "CodecSender");
+    client.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            pump(conn);
+        }
+    });
+    client.setMessageCallback([](const TcpConnectionPtr &, Buffer *buf, Timestamp) { buf->retrieveAll(); });
+    bool scheduled = false;
+    client.setWriteCompleteCallback([&](const TcpConnectionPtr &conn) {
+        if (!scheduled) {
+            scheduled = true;
+            loop->queueInLoop([&, conn] {
+                scheduled = false;
+                pump(conn);
+            });
+        }
+    });
+    client.connect();
+    ::usleep(static_cast<useconds_t>(seconds * 1e6));
+    ::_exit(0);  // 不析构 loop 线程里的对象
+}
+
+int main(int argc, char *argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 1.0;
+    std::vector<size_t> sizes;
+    for (int i = 2; i < argc; ++i) {
+        sizes.push_back(atoi(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes = {32, 256, 1024, 4096};
+    }
+
+    Logger::setLogLevel(FATAL);
+    benchCrc();
+
+    int64_t messages = 0;
+    int64_t badMessages = 0;
+    size_t expectedBytes = 0;
+    double firstTime = 0;
+    double lastTime = 0;
+    auto onFrame = [&](const TcpConnectionPtr &, const StringPiece &message, Timestamp) {
+        if (messages == 0) {
+            firstTime = nowSec();
+        }
+        ++messages;
+        if (message.size() != expectedBytes) {
+            ++badMessages;
+        }
+        lastTime = nowSec();
+    };
+    LengthHeaderCodec plainCodec(onFrame, false);
+    LengthHeaderCodec crcCodec(onFrame, true);
+    LengthHeaderCodec *codec = &plainCodec;
+
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort), "CodecReceiver");
+    server.setConnectionCallback([](const TcpConnectionPtr &) {});
+    server.setMessageCallback(
+        [&](const TcpConnectionPtr &conn, Buffer *buf, Timestamp receiveTime) { codec->onMessage(conn, buf, receiveTime); });
+    server.start();
+
+    pid_t child = 0;
+    int status = 0;
+    loop.runEvery(0.02, [&] {
+        if (child > 0 && ::waitpid(child, &status, WNOHANG) == child) {
+            loop.quit();
+        }
+    });
+
+    for (size_t payloadBytes : sizes) {
+        for (int checksum = 0; checksum <= 1; ++checksum) {
+            for (int prepend = 0; prepend <= 1; ++prepend) {
+                codec = checksum ? &crcCodec : &plainCodec;
+                messages = 0;
+                badMessages = 0;
+                expectedBytes = payloadBytes;
+                fflush(stdout);  // 不然子进程会把缓冲区里还没输出的内容再输出一遍
+                child = ::fork();
+                if (child == 0) {
+                    runSender(prepend, checksum, payloadBytes, seconds);
+                }
+                loop.loop();
+                double elapsed = lastTime - firstTime;
+                printf("%-7s %-5s %5zu B payload: %9.0f msg/s %7.1f MB/s%s\n",
+                       prepend ? "prepend" : "concat",
+                       checksum ? "crc" : "nocrc",
+                       payloadBytes,
+                       elapsed > 0 ? messages / elapsed : 0.0,
+                       elapsed > 0 ? messages * payloadBytes / elapsed / 1e6 : 0.0,
+                       badMessages ? "  BAD MESSAGES" : "");
+                fflush(stdout);
+            }
+        }
+    }
+    return 0;
+}
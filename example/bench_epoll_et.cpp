@@ -0,0 +1,195 @@
+#include <mymuduo/EventLoopThread.h>
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 大量活跃连接下对比水平触发（LT）和边缘触发（ET）: 每个请求 1 字节，响应 responseBytes 字节，
+// 服务端的发送缓冲区只有响应的 1/4，客户端的接收缓冲区很小，每个响应都要部分写。统计每个响应的 epoll_wait / epoll_ctl 次数和吞吐
+// 客户端 fork 到另一个进程，避免两边的 fd 加起来超过 nofile 限制
+// lt-file / et-file: 响应由另一个线程发送，一个 16 字节的头部（send）加上文件的剩余部分（sendFile），
+// 暂存的数据一次 flush，writeFd 写完头部之后停在文件分段前面，检查 ET 模式下剩下的部分也能发出去
+// ./bench_epoll_et [lt|et|lt-file|et-file] [numConnections] [responseBytes] [seconds]
+
+static double cpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);  // 只统计服务端进程
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static std::shared_ptr<const std::string> g_response;
+static int g_numConnections = 0;
+static int g_sendBufferSize = 0;
+static long g_responses = 0;  // 只在 loop 线程访问
+static int g_connections = 0;
+static std::function<void()> g_allConnected;
+static EventLoop *g_worker = nullptr;  // file 模式发送响应的线程
+static int g_file = -1;
+static const size_t kHeaderBytes = 16;
+
+static void onConnection(const TcpConnectionPtr &conn) {
+    if (!conn->connected()) {
+        return;
+    }
+    conn->setSendBufferSize(g_sendBufferSize);  // 发送缓冲区比响应小，每个响应都会部分写
+    if (++g_connections == g_numConnections) {
+        g_allConnected();
+    }
+}
+
+static void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp time) {
+    size_t requests = buf->readableBytes();
+    buf->retrieveAll();
+    for (size_t i = 0; i < requests; ++i) {
+        if (g_worker) {
+            g_worker->runInLoop([conn] {
+                conn->send(g_response->data(), kHeaderBytes);
+                conn->sendFile(g_file, 0, g_response->size() - kHeaderBytes);
+            });
+        } else {
+            conn->send(g_response);
+        }
+        ++g_responses;
+    }
+}
+
+// 客户端: 每个连接发 1 字节，收完整个响应之后再发下一个
+static void runClients(const InetAddress &addr, int numConnections, size_t responseBytes) {
+    int epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    std::vector<size_t> received(numConnections + 1024, 0);
+    for (int i = 0; i < numConnections; ++i) {
+        int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+        int rcvbuf = 4096;  // 接收窗口也要小，否则 loopback 上 send 直接把数据交给对端，发送缓冲区不会满
+        ::setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        if (::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+            perror("connect");
+            exit(1);
+        }
+        ::fcntl(sockfd, F_SETFL, O_NONBLOCK);
+        if (static_cast<size_t>(sockfd) >= received.size()) {
+            received.resize(sockfd + 1, 0);
+        }
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = sockfd;
+        ::epoll_ctl(epfd, EPOLL_CTL_ADD, sockfd, &ev);
+        if (::write(sockfd, "r", 1) != 1) {
+            perror("write");
+            exit(1);
+        }
+    }
+
+    std::vector<struct epoll_event> events(1024);
+    char buf[64 * 1024];
+    while (true) {
+        int n = ::epoll_wait(epfd, events.data(), static_cast<int>(events.size()), -1);
+        for (int i = 0; i < n; ++i) {
+            int sockfd = events[i].data.fd;
+            ssize_t nread = ::read(sockfd, buf, sizeof(buf));
+            if (nread <= 0) {
+                if (nread < 0 && errno == EAGAIN) {
+                    continue;
+                }
+                exit(0);
+            }
+            received[sockfd] += nread;
+            if (received[sockfd] >= responseBytes) {
+                received[sockfd] -= responseBytes;
+                if (::write(sockfd, "r", 1) != 1) {
+                    exit(0);
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "et";
+    int numConnections = argc > 2 ? atoi(argv[2]) : 10000;
+    g_numConnections = numConnections;
+    size_t responseBytes = argc > 3 ? atoi(argv[3]) : 16 * 1024;
+    int seconds = argc > 4 ? atoi(argv[4]) : 5;
+    g_sendBufferSize = static_cast<int>(responseBytes / 4);
+
+    Logger::setLogLevel(ERROR);
+    g_response = std::make_shared<const std::string>(responseBytes, 'x');
+    bool fileMode = mode.size() > 5 && mode.compare(mode.size() - 5, 5, "-file") == 0;
+    EventLoopThread worker;
+    if (fileMode) {
+        char path[] = "/tmp/bench_epoll_et.XXXXXX";
+        g_file = ::mkstemp(path);
+        ::unlink(path);
+        if (g_file < 0 || ::write(g_file, g_response->data(), responseBytes - kHeaderBytes) !=
+                              static_cast<ssize_t>(responseBytes - kHeaderBytes)) {
+            perror("mkstemp");
+            return 1;
+        }
+        g_worker = worker.startLoop();
+    }
+
+    EventLoop loop;
+    InetAddress addr(9990);
+    TcpServer server(&loop, addr, "EpollBench");
+    server.setConnectionCallback(onConnection);
+    server.setMessageCallback(onMessage);
+    server.setEdgeTriggered(mode.compare(0, 2, "et") == 0);
+    server.start();
+
+    pid_t child = ::fork();
+    if (child == 0) {
+        runClients(addr, numConnections, responseBytes);
+        return 0;
+    }
+
+    // 连接都建立好之后再统计 seconds 秒
+    long startResponses = 0;
+    uint64_t startPolls = 0;
+    uint64_t startUpdates = 0;
+    double startCpu = 0;
+    g_allConnected = [&] {
+        loop.runAfter(1.0, [&] {
+            startResponses = g_responses;
+            startPolls = loop.pollCount();
+            startUpdates = loop.pollerUpdateCount();
+            startCpu = cpuSeconds();
+        });
+        loop.runAfter(1.0 + seconds, [&] {
+            double responses = static_cast<double>(g_responses - startResponses);
+            if (responses < g_numConnections) {
+                printf("%s: only %.0f responses in %d s, responses are stuck\n", mode.c_str(), responses, seconds);
+                loop.quit();
+                return;
+            }
+            printf("%s  %d connections  %zu bytes/response: %8.0f responses/s   server CPU %6.2f us/response   "
+                   "epoll_wait %.4f/response   epoll_ctl %.3f/response\n",
+                   mode.c_str(),
+                   numConnections,
+                   responseBytes,
+                   responses / seconds,
+                   (cpuSeconds() - startCpu) * 1e6 / responses,
+                   (loop.pollCount() - startPolls) / responses,
+                   (loop.pollerUpdateCount() - startUpdates) / responses);
+            loop.quit();
+        });
+    };
+    loop.loop();
+
+    ::kill(child, SIGKILL);
+    ::waitpid(child, nullptr, 0);
+    return 0;
+}
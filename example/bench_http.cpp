@@ -0,0 +1,201 @@
+#include <mymuduo/HttpServer.h>
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// 类似 wrk 的本地压测：fork 出来的子进程用一个 epoll 线程维持 connections 个长连接，
+// 每个连接一次发 pipeline 个 GET，收齐响应之后再发下一批，统计每秒完成的请求数
+// http: HttpServer 解析每个请求，回调里填写 Hello, World!
+// baseline: TcpServer 只数 "\r\n\r\n"，回复事先拼好的同样的响应，不解析，作为上限参考
+// ./bench_http [http|baseline] [connections] [pipeline] [seconds] [threads]
+
+static const uint16_t kPort = 9993;
+static const char kRequest[] = "GET /hello HTTP/1.1\r\nHost: localhost\r\nUser-Agent: bench_http\r\nAccept: */*\r\n\r\n";
+static const char kResponse[] =
+    "HTTP/1.1 200 OK\r\nContent-Length: 13\r\nConnection: Keep-Alive\r\nContent-Type: text/plain\r\n\r\nHello, World!";
+
+static int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+struct Result {
+    int64_t requests;
+    int64_t elapsedNs;
+    int errors;
+};
+
+struct Client {
+    int fd;
+    std::string batch;  // pipeline 个请求
+    size_t outstanding;
+    size_t partial;     // 当前响应已经收到的字节数
+    bool checked;       // 第一个响应和 kResponse 比较过
+};
+
+static void runClient(int connections, int pipeline, double seconds, int resultFd) {
+    const size_t responseBytes = sizeof(kResponse) - 1;
+    Result result = {0, 0, 0};
+    int epfd = ::epoll_create1(0);
+    std::vector<Client> clients(connections);
+    InetAddress serverAddr(kPort);
+    for (int i = 0; i < connections; ++i) {
+        Client &c = clients[i];
+        c.fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(c.fd, (const sockaddr *)serverAddr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+            perror("connect");
+            ::_exit(1);
+        }
+        for (int j = 0; j < pipeline; ++j) {
+            c.batch.append(kRequest, sizeof(kRequest) - 1);
+        }
+        c.outstanding = 0;
+        c.partial = 0;
+        c.checked = false;
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        ::epoll_ctl(epfd, EPOLL_CTL_ADD, c.fd, &ev);
+    }
+
+    int64_t start = nowNs();
+    int64_t deadline = start + static_cast<int64_t>(seconds * 1e9);
+    for (Client &c : clients) {
+        ::write(c.fd, c.batch.data(), c.batch.size());
+        c.outstanding = pipeline;
+    }
+
+    std::vector<struct epoll_event> events(connections);
+    std::vector<char> buf(64 * 1024);
+    while (nowNs() < deadline) {
+        int n = ::epoll_wait(epfd, events.data(), connections, 100);
+        for (int i = 0; i < n; ++i) {
+            Client &c = clients[events[i].data.u32];
+            ssize_t nread = ::read(c.fd, buf.data(), buf.size());
+            if (nread <= 0) {
+                ++result.errors;
+                ::epoll_ctl(epfd, EPOLL_CTL_DEL, c.fd, nullptr);
+                continue;
+            }
+            if (!c.checked && nread >= static_cast<ssize_t>(responseBytes)) {
+                c.checked = true;
+                if (::memcmp(buf.data(), kResponse, responseBytes) != 0) {
+                    ++result.errors;
+                }
+            }
+            // 所有响应都一样长，按字节数计算完成了几个
+            c.partial += nread;
+            size_t done = c.partial / responseBytes;
+            c.partial %= responseBytes;
+            c.outstanding -= done;
+            result.requests += done;
+            if (c.outstanding == 0) {
+                ::write(c.fd, c.batch.data(), c.batch.size());
+                c.outstanding = pipeline;
+            }
+        }
+    }
+    result.elapsedNs = nowNs() - start;
+    for (Client &c : clients) {
+        ::close(c.fd);
+    }
+    if (::write(resultFd, &result, sizeof(result)) != sizeof(result)) {
+        ::_exit(1);
+    }
+}
+
+static void onHello(const HttpRequest &, HttpResponse *resp) {
+    resp->setStatusCode(HttpResponse::k200Ok);
+    resp->setContentType("text/plain");
+    resp->setBody("Hello, World!");
+}
+
+// 不解析，只数请求结尾的空行
+static void onBaselineMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp) {
+    static thread_local std::string out;
+    out.clear();
+    const char *begin = buf->peek();
+    const char *end = begin + buf->readableBytes();
+    const char *p = begin;
+    while (const char *blank = static_cast<const char *>(::memmem(p, end - p, "\r\n\r\n", 4))) {
+        out.append(kResponse, sizeof(kResponse) - 1);
+        p = blank + 4;
+    }
+    buf->retrieve(p - begin);
+    if (!out.empty()) {
+        conn->send(out);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "http";
+    int connections = argc > 2 ? atoi(argv[2]) : 16;
+    int pipeline = argc > 3 ? atoi(argv[3]) : 1;
+    double seconds = argc > 4 ? atof(argv[4]) : 5;
+    int threads = argc > 5 ? atoi(argv[5]) : 0;
+
+    Logger::setLogLevel(FATAL);
+    EventLoop loop;
+    InetAddress addr(kPort);
+    std::unique_ptr<HttpServer> httpServer;
+    std::unique_ptr<TcpServer> baselineServer;
+    if (mode == "baseline") {
+        baselineServer.reset(new TcpServer(&loop, addr, "BaselineBench"));
+        baselineServer->setConnectionCallback([](const TcpConnectionPtr &) {});
+        baselineServer->setMessageCallback(onBaselineMessage);
+        baselineServer->setThreadNum(threads);
+        baselineServer->start();
+    } else {
+        httpServer.reset(new HttpServer(&loop, addr, "HttpBench"));
+        httpServer->setHttpCallback(onHello);
+        httpServer->setThreadNum(threads);
+        httpServer->start();
+    }
+
+    int fds[2];
+    if (::pipe(fds) < 0) {
+        perror("pipe");
+        return 1;
+    }
+    pid_t child = ::fork();
+    if (child == 0) {
+        runClient(connections, pipeline, seconds, fds[1]);
+        ::_exit(0);  // 子进程里没有 loop 线程，不能析构 server
+    }
+    ::close(fds[1]);
+
+    int status = 0;
+    loop.runEvery(0.05, [&] {
+        if (::waitpid(child, &status, WNOHANG) == child) {
+            loop.quit();
+        }
+    });
+    loop.loop();
+
+    Result result;
+    if (::read(fds[0], &result, sizeof(result)) != sizeof(result) || result.elapsedNs <= 0) {
+        printf("%-8s failed, child status %d\n", mode.c_str(), status);
+        return 1;
+    }
+    printf("%-8s %3d conns pipeline %2d: %10.0f req/s  errors %d\n",
+           mode.c_str(),
+           connections,
+           pipeline,
+           result.requests / (result.elapsedNs / 1e9),
+           result.errors);
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <mymuduo/EventLoop.h>
+#include <mymuduo/IdleWheel.h>
+#include <mymuduo/Timestamp.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory>
+#include <vector>
+
+// IdleWheel 每条消息刷新一次的开销，默认 50 万个连接
+// ./bench_idle [numConnections] [numMessages]
+
+static int g_expired = 0;
+
+static void onExpired(IdleEntry *) { ++g_expired; }
+
+int main(int argc, char *argv[]) {
+    int numConns = argc > 1 ? atoi(argv[1]) : 500 * 1000;
+    int numMessages = argc > 2 ? atoi(argv[2]) : 20 * 1000 * 1000;
+
+    EventLoop loop;
+    std::shared_ptr<IdleWheel> wheel(new IdleWheel(&loop, 60.0));
+
+    std::unique_ptr<IdleEntry[]> entries(new IdleEntry[numConns]);
+    for (int i = 0; i < numConns; ++i) {
+        entries[i].setOwner(nullptr, onExpired);
+        wheel->touch(&entries[i]);
+    }
+
+    // 预先生成随机的连接序列，避免把随机数的开销算进去
+    std::vector<int> order(numMessages);
+    srand(1);
+    for (int i = 0; i < numMessages; ++i) {
+        order[i] = rand() % numConns;
+    }
+
+    // 基准: 只访问 entry 内存，不刷新
+    Timestamp start(Timestamp::now());
+    int64_t sum = 0;
+    for (int i = 0; i < numMessages; ++i) {
+        sum += entries[order[i]].linked();
+    }
+    double baseline = timeDifference(Timestamp::now(), start);
+
+    // 每 numConns 条消息前进一个 tick，让大部分刷新都要换桶
+    start = Timestamp::now();
+    for (int i = 0; i < numMessages; ++i) {
+        if (i % numConns == 0) {
+            wheel->advance();
+        }
+        wheel->touch(&entries[order[i]]);
+    }
+    double refresh = timeDifference(Timestamp::now(), start);
+
+    // 同一个 tick 内的重复刷新
+    start = Timestamp::now();
+    for (int i = 0; i < numMessages; ++i) {
+        wheel->touch(&entries[order[i]]);
+    }
+    double sameTick = timeDifference(Timestamp::now(), start);
+
+    // 全部到期，批量回调
+    start = Timestamp::now();
+    for (int i = 0; i <= IdleWheel::kNumTicks; ++i) {
+        wheel->advance();
+    }
+    double expire = timeDifference(Timestamp::now(), start);
+
+    printf("connections: %d, messages: %d (checksum %ld)\n", numConns, numMessages, sum);
+    printf("baseline access:   %6.2f ns/msg\n", baseline * 1e9 / numMessages);
+    printf("refresh (moving):  %6.2f ns/msg\n", refresh * 1e9 / numMessages);
+    printf("refresh (same):    %6.2f ns/msg\n", sameTick * 1e9 / numMessages);
+    printf("expire %d entries: %6.2f ms\n", g_expired, expire * 1000);
+    return 0;
+}
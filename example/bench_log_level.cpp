@@ -0,0 +1,77 @@
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <thread>
+
+// echo server 每条消息打一行 LOG_INFO，对比 INFO 打开和关闭时的 requests/s
+// ./bench_log_level [numRequests] > /dev/null    (结果输出在 stderr)
+
+static void onConnection(const TcpConnectionPtr &conn) {
+    LOG_INFO("connection %s is %s", conn->name().c_str(), conn->connected() ? "UP" : "DOWN");
+}
+
+static void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp time) {
+    std::string msg = buf->retrieveAllAsString();
+    LOG_INFO("%s echo %lu bytes, data received at %s", conn->name().c_str(), msg.size(), time.toString().c_str());
+    conn->send(msg);
+}
+
+// 单连接 ping-pong，返回 requests/s
+static double pingpong(const InetAddress &addr, int numRequests) {
+    int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+        perror("connect");
+        exit(1);
+    }
+
+    char buf[64] = "ping ping ping ping ping ping ping ping";
+    Timestamp start(Timestamp::now());
+    for (int i = 0; i < numRequests; ++i) {
+        if (::write(sockfd, buf, sizeof(buf)) != sizeof(buf)) {
+            perror("write");
+            exit(1);
+        }
+        size_t nread = 0;
+        while (nread < sizeof(buf)) {
+            ssize_t n = ::read(sockfd, buf + nread, sizeof(buf) - nread);
+            if (n <= 0) {
+                perror("read");
+                exit(1);
+            }
+            nread += n;
+        }
+    }
+    double seconds = timeDifference(Timestamp::now(), start);
+    ::close(sockfd);
+    return numRequests / seconds;
+}
+
+int main(int argc, char *argv[]) {
+    int numRequests = argc > 1 ? atoi(argv[1]) : 100 * 1000;
+
+    EventLoop loop;
+    InetAddress addr(9987);
+    TcpServer server(&loop, addr, "LogLevelBench");
+    server.setConnectionCallback(onConnection);
+    server.setMessageCallback(onMessage);
+    server.start();
+
+    std::thread client([&] {
+        Logger::setLogLevel(INFO);
+        double infoOn = pingpong(addr, numRequests);
+        Logger::setLogLevel(ERROR);
+        double infoOff = pingpong(addr, numRequests);
+        fprintf(stderr, "INFO on:  %10.0f requests/s\n", infoOn);
+        fprintf(stderr, "INFO off: %10.0f requests/s\n", infoOff);
+        loop.quit();
+    });
+
+    loop.loop();
+    client.join();
+    return 0;
+}
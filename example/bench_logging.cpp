@@ -0,0 +1,74 @@
+#include <mymuduo/AsyncLogging.h>
+#include <mymuduo/EventLoop.h>
+#include <mymuduo/EventLoopThread.h>
+#include <mymuduo/Logger.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <future>
+#include <vector>
+
+// 对比 std::cout 同步日志和 AsyncLogging 的吞吐，以及 EventLoop 线程上每条日志增加的延迟
+// ./bench_logging [numLines] > /dev/null    (结果输出在 stderr)
+
+static AsyncLogging *g_asyncLog = nullptr;
+
+static void asyncOutput(const char *msg, size_t len) { g_asyncLog->append(msg, len); }
+
+static int64_t nowNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+static void logInLoop(std::vector<int64_t> *latencies, int64_t *elapsed) {
+    int64_t start = nowNanos();
+    for (size_t i = 0; i < latencies->size(); ++i) {
+        int64_t t0 = nowNanos();
+        LOG_INFO("bench_logging line %lu: hello %s", i, "muduo");
+        (*latencies)[i] = nowNanos() - t0;
+    }
+    *elapsed = nowNanos() - start;
+}
+
+static void run(const char *name, EventLoop *loop, int numLines) {
+    std::vector<int64_t> latencies(numLines);
+    int64_t elapsed = 0;
+    std::promise<void> done;
+    loop->runInLoop([&] {
+        logInLoop(&latencies, &elapsed);
+        done.set_value();
+    });
+    done.get_future().wait();
+
+    std::sort(latencies.begin(), latencies.end());
+    fprintf(stderr,
+            "%-6s %10.0f lines/s  p50 %6ld ns  p99 %6ld ns  p999 %7ld ns  max %8ld ns\n",
+            name,
+            numLines * 1e9 / elapsed,
+            latencies[numLines / 2],
+            latencies[numLines * 99 / 100],
+            latencies[numLines * 999 / 1000],
+            latencies.back());
+}
+
+int main(int argc, char *argv[]) {
+    int numLines = argc > 1 ? atoi(argv[1]) : 1000 * 1000;
+
+    EventLoopThread loopThread;
+    EventLoop *loop = loopThread.startLoop();
+
+    run("cout", loop, numLines);
+
+    AsyncLogging asyncLog("/tmp/bench_logging", 256 * 1024 * 1024);
+    g_asyncLog = &asyncLog;
+    asyncLog.start();
+    Logger::setOutput(asyncOutput);
+    run("async", loop, numLines);
+    asyncLog.stop();
+    fprintf(stderr, "async dropped %ld lines\n", asyncLog.droppedLines());
+    return 0;
+}
@@ -0,0 +1,214 @@
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <arpa/inet.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+// 不均衡负载下的 subLoop 选择策略: 前一半连接里每 numLoops 个有一个重连接（每个请求在服务端忙 heavyUs 微秒），其余是轻连接
+// 轮询会把重连接都放到同一个 loop 上，和那里的轻连接抢时间。连接每 kRampMs 毫秒建立一个，建立之后马上开始发请求（一问一答），
+// 客户端从 127.0.0.2 ~ 127.0.0.33 这些地址发起连接，kPeerHash 才有区分度
+// 统计每个 loop 上轻请求的 p99 延迟（客户端发送到服务端开始处理，同一台机器的 CLOCK_MONOTONIC），以及 loop 之间的差距
+// ./bench_loop_select [rr|lc|p2c|hash] [numLoops] [numConnections] [heavyUs] [seconds]
+
+static const int kNumPeerAddrs = 32;
+static const int kRampMs = 10;
+
+struct Request {
+    int64_t sendNs;
+    int64_t heavy;
+};
+
+static int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int g_heavyUs = 0;
+static std::atomic_bool g_recording(false);
+static std::atomic_int g_numLoops(0);
+static std::vector<std::vector<int64_t>> g_latencies;  // 每个 loop 一个，只在自己的 loop 线程写
+static std::vector<std::atomic_int> *g_connections = nullptr;
+static __thread int t_loopIndex = 0;
+
+static void onThreadInit(EventLoop *) { t_loopIndex = g_numLoops++; }
+
+static void onConnection(const TcpConnectionPtr &conn) {
+    if (conn->connected()) {
+        ++(*g_connections)[t_loopIndex];
+    }
+}
+
+static void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp) {
+    while (buf->readableBytes() >= sizeof(Request)) {
+        Request request;
+        memcpy(&request, buf->peek(), sizeof(request));
+        buf->retrieve(sizeof(request));
+        int64_t start = nowNs();
+        if (request.heavy) {
+            while (nowNs() - start < g_heavyUs * 1000LL) {
+            }
+        } else if (g_recording) {
+            g_latencies[t_loopIndex].push_back(start - request.sendNs);
+        }
+        conn->send(&request, sizeof(request));
+    }
+}
+
+static int connectFrom(const InetAddress &addr, int i) {
+    int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK + 1 + i % kNumPeerAddrs);
+    ::bind(sockfd, (const sockaddr *)&local, sizeof(local));
+    if (::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+        perror("connect");
+        exit(1);
+    }
+    return sockfd;
+}
+
+static void sendRequest(int sockfd, bool heavy) {
+    Request request = {nowNs(), heavy ? 1 : 0};
+    if (::write(sockfd, &request, sizeof(request)) != sizeof(request)) {
+        exit(0);
+    }
+}
+
+static void runClients(const InetAddress &addr, int numLoops, int numConnections) {
+    int epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    std::vector<char> heavy(numConnections + 1024, 0);
+    std::vector<size_t> received(numConnections + 1024, 0);
+    std::vector<struct epoll_event> events(1024);
+    int connected = 0;
+    int64_t nextConnect = nowNs();
+    char buf[4096];
+    while (true) {
+        if (connected < numConnections && nowNs() >= nextConnect) {
+            int sockfd = connectFrom(addr, connected);
+            if (static_cast<size_t>(sockfd) >= heavy.size()) {
+                heavy.resize(sockfd + 1, 0);
+                received.resize(sockfd + 1, 0);
+            }
+            heavy[sockfd] = connected % numLoops == 0 && connected < numConnections / 2;
+            struct epoll_event ev;
+            ev.events = EPOLLIN;
+            ev.data.fd = sockfd;
+            ::epoll_ctl(epfd, EPOLL_CTL_ADD, sockfd, &ev);
+            sendRequest(sockfd, heavy[sockfd]);
+            ++connected;
+            nextConnect += kRampMs * 1000000LL;
+        }
+        int timeoutMs = connected < numConnections ? 1 : -1;
+        int n = ::epoll_wait(epfd, events.data(), static_cast<int>(events.size()), timeoutMs);
+        for (int i = 0; i < n; ++i) {
+            int sockfd = events[i].data.fd;
+            ssize_t nread = ::read(sockfd, buf, sizeof(buf));
+            if (nread <= 0) {
+                exit(0);
+            }
+            received[sockfd] += nread;
+            while (received[sockfd] >= sizeof(Request)) {
+                received[sockfd] -= sizeof(Request);
+                sendRequest(sockfd, heavy[sockfd]);
+            }
+        }
+    }
+}
+
+static LoopSelector::Policy parsePolicy(const std::string &name) {
+    if (name == "lc") {
+        return LoopSelector::kLeastConnections;
+    } else if (name == "p2c") {
+        return LoopSelector::kPowerOfTwoChoices;
+    } else if (name == "hash") {
+        return LoopSelector::kPeerHash;
+    }
+    return LoopSelector::kRoundRobin;
+}
+
+static double percentile(std::vector<int64_t> &values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(p * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index] / 1000.0;
+}
+
+int main(int argc, char *argv[]) {
+    std::string policy = argc > 1 ? argv[1] : "p2c";
+    int numLoops = argc > 2 ? atoi(argv[2]) : 4;
+    int numConnections = argc > 3 ? atoi(argv[3]) : 64;
+    g_heavyUs = argc > 4 ? atoi(argv[4]) : 500;
+    int seconds = argc > 5 ? atoi(argv[5]) : 5;
+
+    g_latencies.resize(numLoops);
+    std::vector<std::atomic_int> connections(numLoops);
+    for (auto &count : connections) {
+        count = 0;
+    }
+    g_connections = &connections;
+
+    Logger::setLogLevel(FATAL);  // 结束时客户端进程被杀掉，连接 ECONNRESET 的日志不输出
+    EventLoop loop;
+    InetAddress addr(9997);
+    TcpServer server(&loop, addr, "LoopSelectBench");
+    server.setThreadInitCallback(onThreadInit);
+    server.setConnectionCallback(onConnection);
+    server.setMessageCallback(onMessage);
+    server.setThreadNum(numLoops);
+    server.setLoopSelectPolicy(parsePolicy(policy));
+    server.start();
+
+    pid_t child = ::fork();
+    if (child == 0) {
+        runClients(addr, numLoops, numConnections);
+        return 0;
+    }
+
+    double rampSeconds = numConnections * kRampMs / 1000.0 + 0.5;
+    loop.runAfter(rampSeconds, [] { g_recording = true; });
+    loop.runAfter(rampSeconds + seconds, [] { g_recording = false; });
+    loop.runAfter(rampSeconds + seconds + 0.1, [&] {
+        std::vector<int64_t> all;
+        double minP99 = 1e18;
+        double maxP99 = 0;
+        printf("%-5s %d loops  %d connections  heavy %d us\n", policy.c_str(), numLoops, numConnections, g_heavyUs);
+        for (int i = 0; i < numLoops; ++i) {
+            std::vector<int64_t> &latencies = g_latencies[i];
+            all.insert(all.end(), latencies.begin(), latencies.end());
+            double p99 = percentile(latencies, 0.99);
+            minP99 = std::min(minP99, p99);
+            maxP99 = std::max(maxP99, p99);
+            printf("  loop %2d: %3d connections  %8zu light requests  p99 %9.0f us\n",
+                   i,
+                   connections[i].load(),
+                   latencies.size(),
+                   p99);
+        }
+        printf("  overall p99 %9.0f us   p99 spread across loops (max - min) %9.0f us\n",
+               percentile(all, 0.99),
+               maxP99 - minP99);
+        loop.quit();
+    });
+    loop.loop();
+
+    ::kill(child, SIGKILL);
+    ::waitpid(child, nullptr, 0);
+    return 0;
+}
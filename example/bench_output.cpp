@@ -0,0 +1,135 @@
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// 慢速客户端下 1MiB 响应的吞吐，以及服务端 loop 线程每个响应消耗的 CPU 时间
+// ./bench_output [string|iov|shared] [numClients] [seconds]
+//   string: header + body 拼接成一个 std::string 再 send（拷贝）
+//   iov:    send(iovec[2])，header 和 body 不拼接
+//   shared: body 是 shared_ptr<const std::string>，outputBuffer 只引用
+
+static const size_t kBodySize = 1024 * 1024;
+static const size_t kHeaderSize = 16;
+
+static std::string g_mode = "shared";
+static std::shared_ptr<const std::string> g_body;
+static std::string g_header;
+
+static void onConnection(const TcpConnectionPtr &conn) {}
+
+static void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp time) {
+    size_t requests = buf->readableBytes();
+    buf->retrieveAll();
+    for (size_t i = 0; i < requests; ++i) {
+        if (g_mode == "string") {
+            std::string response = g_header + *g_body;
+            conn->send(response);
+        } else if (g_mode == "iov") {
+            struct iovec vec[2];
+            vec[0].iov_base = const_cast<char *>(g_header.data());
+            vec[0].iov_len = g_header.size();
+            vec[1].iov_base = const_cast<char *>(g_body->data());
+            vec[1].iov_len = g_body->size();
+            conn->send(vec, 2);
+        } else {
+            conn->send(g_header);
+            conn->send(g_body);
+        }
+    }
+}
+
+static double threadCpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 慢速读: 接收缓冲区很小，每次读 16K 之后 sleep 一下
+static void slowClient(const InetAddress &addr, std::atomic_bool *running, std::atomic_long *responses) {
+    int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int rcvbuf = 32 * 1024;
+    ::setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+        perror("connect");
+        exit(1);
+    }
+
+    char buf[16 * 1024];
+    while (running->load()) {
+        if (::write(sockfd, "q", 1) != 1) {
+            perror("write");
+            exit(1);
+        }
+        size_t nread = 0;
+        while (nread < kHeaderSize + kBodySize) {
+            ssize_t n = ::read(sockfd, buf, sizeof(buf));
+            if (n <= 0) {
+                perror("read");
+                exit(1);
+            }
+            nread += n;
+            ::usleep(20);
+        }
+        ++*responses;
+    }
+    ::close(sockfd);
+}
+
+int main(int argc, char *argv[]) {
+    g_mode = argc > 1 ? argv[1] : "shared";
+    int numClients = argc > 2 ? atoi(argv[2]) : 8;
+    int seconds = argc > 3 ? atoi(argv[3]) : 3;
+
+    Logger::setLogLevel(ERROR);
+    g_body = std::make_shared<const std::string>(kBodySize, 'x');
+    g_header.assign(kHeaderSize - 2, 'h');
+    g_header += "\r\n";
+
+    EventLoop loop;
+    InetAddress addr(9988);
+    TcpServer server(&loop, addr, "OutputBench");
+    server.setConnectionCallback(onConnection);
+    server.setMessageCallback(onMessage);
+    server.start();
+
+    std::atomic_bool running(true);
+    std::atomic_long responses(0);
+    std::thread driver([&] {
+        std::vector<std::thread> clients;
+        for (int i = 0; i < numClients; ++i) {
+            clients.emplace_back(slowClient, std::cref(addr), &running, &responses);
+        }
+        ::sleep(seconds);
+        running = false;
+        for (auto &t : clients) {
+            t.join();
+        }
+        loop.quit();
+    });
+
+    double cpuStart = threadCpuSeconds();
+    Timestamp start(Timestamp::now());
+    loop.loop();
+    double elapsed = timeDifference(Timestamp::now(), start);
+    double cpu = threadCpuSeconds() - cpuStart;
+    driver.join();
+
+    long n = responses.load();
+    printf("mode=%s clients=%d responses=%ld  %.1f MiB/s  server cpu %.1f us/response\n",
+           g_mode.c_str(),
+           numClients,
+           n,
+           n * (kHeaderSize + kBodySize) / elapsed / (1024 * 1024),
+           n > 0 ? cpu * 1e6 / n : 0.0);
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// echo 服务器对比 EPollPoller 和 IoUringPoller: 每个连接发 messageBytes 字节，收到回显之后再发下一条
+// 统计每个请求的 poller 系统调用次数（epoll_wait + epoll_ctl / io_uring_enter）、注册修改次数和吞吐
+// 客户端 fork 到另一个进程，使用 epoll
+// ./bench_poller [epoll|uring] [lt|et] [numConnections] [messageBytes] [seconds]
+
+static int g_numConnections = 0;
+static int g_connections = 0;
+static long g_requests = 0;  // 只在 loop 线程访问
+static std::function<void()> g_allConnected;
+
+static double cpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);  // 只统计服务端进程
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void onConnection(const TcpConnectionPtr &conn) {
+    if (conn->connected() && ++g_connections == g_numConnections) {
+        g_allConnected();
+    }
+}
+
+static void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp time) {
+    ++g_requests;
+    conn->send(buf);
+}
+
+static void runClients(const InetAddress &addr, int numConnections, size_t messageBytes) {
+    int epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    std::vector<size_t> received(numConnections + 1024, 0);
+    std::string message(messageBytes, 'm');
+    for (int i = 0; i < numConnections; ++i) {
+        int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+            perror("connect");
+            exit(1);
+        }
+        ::fcntl(sockfd, F_SETFL, O_NONBLOCK);
+        if (static_cast<size_t>(sockfd) >= received.size()) {
+            received.resize(sockfd + 1, 0);
+        }
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = sockfd;
+        ::epoll_ctl(epfd, EPOLL_CTL_ADD, sockfd, &ev);
+        if (::write(sockfd, message.data(), message.size()) != static_cast<ssize_t>(message.size())) {
+            perror("write");
+            exit(1);
+        }
+    }
+
+    std::vector<struct epoll_event> events(1024);
+    char buf[64 * 1024];
+    while (true) {
+        int n = ::epoll_wait(epfd, events.data(), static_cast<int>(events.size()), -1);
+        for (int i = 0; i < n; ++i) {
+            int sockfd = events[i].data.fd;
+            ssize_t nread = ::read(sockfd, buf, sizeof(buf));
+            if (nread <= 0) {
+                if (nread < 0 && errno == EAGAIN) {
+                    continue;
+                }
+                exit(0);
+            }
+            received[sockfd] += nread;
+            if (received[sockfd] >= messageBytes) {
+                received[sockfd] -= messageBytes;
+                if (::write(sockfd, message.data(), message.size()) != static_cast<ssize_t>(message.size())) {
+                    exit(0);
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string backend = argc > 1 ? argv[1] : "uring";
+    std::string mode = argc > 2 ? argv[2] : "lt";
+    int numConnections = argc > 3 ? atoi(argv[3]) : 1000;
+    size_t messageBytes = argc > 4 ? atoi(argv[4]) : 64;
+    int seconds = argc > 5 ? atoi(argv[5]) : 5;
+    g_numConnections = numConnections;
+
+    Logger::setLogLevel(ERROR);
+    EventLoop loop(backend == "uring" ? EventLoop::kIoUringPoller : EventLoop::kEPollPoller);
+    InetAddress addr(9991);
+    TcpServer server(&loop, addr, "PollerBench");
+    server.setConnectionCallback(onConnection);
+    server.setMessageCallback(onMessage);
+    server.setEdgeTriggered(mode == "et");
+    server.start();
+
+    pid_t child = ::fork();
+    if (child == 0) {
+        runClients(addr, numConnections, messageBytes);
+        return 0;
+    }
+
+    // 连接都建立好之后再统计 seconds 秒
+    long startRequests = 0;
+    uint64_t startSyscalls = 0;
+    uint64_t startUpdates = 0;
+    double startCpu = 0;
+    g_allConnected = [&] {
+        loop.runAfter(1.0, [&] {
+            startRequests = g_requests;
+            startSyscalls = loop.pollerSyscallCount();
+            startUpdates = loop.pollerUpdateCount();
+            startCpu = cpuSeconds();
+        });
+        loop.runAfter(1.0 + seconds, [&] {
+            double requests = static_cast<double>(g_requests - startRequests);
+            printf("%-5s %s  %d connections  %zu bytes: %9.0f requests/s   server CPU %5.2f us/request   "
+                   "poller syscalls %.4f/request   interest updates %.3f/request\n",
+                   backend.c_str(),
+                   mode.c_str(),
+                   numConnections,
+                   messageBytes,
+                   requests / seconds,
+                   (cpuSeconds() - startCpu) * 1e6 / requests,
+                   (loop.pollerSyscallCount() - startSyscalls) / requests,
+                   (loop.pollerUpdateCount() - startUpdates) / requests);
+            loop.quit();
+        });
+    };
+    loop.loop();
+
+    ::kill(child, SIGKILL);
+    ::waitpid(child, nullptr, 0);
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <mymuduo/Channel.h>
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// 1. channel 注册表: numChannels 个 eventfd 反复 enableReading / enableWriting / disableAll / remove，
+//    统计 updateChannel + removeChannel 每秒的次数，另外统计 hasChannel 每秒的次数
+// 2. 连接抖动: 客户端 fork 到另一个进程，不停地 connect + close，统计服务端每秒建立并关闭的连接数
+// ./bench_poller_churn [epoll|uring] [numChannels] [seconds]
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void benchChannelTable(EventLoop *loop, int numChannels, double seconds) {
+    std::vector<int> fds;
+    std::vector<std::unique_ptr<Channel>> channels;
+    for (int i = 0; i < numChannels; ++i) {
+        fds.push_back(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+        channels.emplace_back(new Channel(loop, fds.back()));
+    }
+
+    long ops = 0;
+    double start = now();
+    double elapsed = 0;
+    while ((elapsed = now() - start) < seconds) {
+        for (auto &channel : channels) {
+            channel->enableReading();   // add
+            channel->enableWriting();   // mod
+            channel->disableWriting();  // mod
+            channel->disableAll();      // del
+            channel->remove();
+        }
+        ops += 5L * numChannels;
+    }
+    printf("channel table: %d channels  %10.0f updateChannel/removeChannel per second\n", numChannels, ops / elapsed);
+
+    for (auto &channel : channels) {
+        channel->enableReading();
+    }
+    long lookups = 0;
+    start = now();
+    while ((elapsed = now() - start) < seconds) {
+        for (int round = 0; round < 100; ++round) {
+            for (auto &channel : channels) {
+                loop->hasChannel(channel.get());
+            }
+        }
+        lookups += 100L * numChannels;
+    }
+    printf("channel table: %d channels  %10.0f hasChannel per second\n", numChannels, lookups / elapsed);
+
+    for (auto &channel : channels) {
+        channel->disableAll();
+        channel->remove();
+    }
+    for (int fd : fds) {
+        ::close(fd);
+    }
+}
+
+static long g_closed = 0;  // 只在 loop 线程访问
+
+static void onConnection(const TcpConnectionPtr &conn) {
+    if (!conn->connected()) {
+        ++g_closed;
+    }
+}
+
+static void runChurnClient(const InetAddress &addr) {
+    while (true) {
+        int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+            ::close(sockfd);
+            ::usleep(1000);
+            continue;
+        }
+        ::close(sockfd);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string backend = argc > 1 ? argv[1] : "epoll";
+    int numChannels = argc > 2 ? atoi(argv[2]) : 1000;
+    int seconds = argc > 3 ? atoi(argv[3]) : 3;
+
+    Logger::setLogLevel(ERROR);
+    EventLoop loop(backend == "uring" ? EventLoop::kIoUringPoller : EventLoop::kEPollPoller);
+    benchChannelTable(&loop, numChannels, seconds);
+
+    InetAddress addr(9994);
+    TcpServer server(&loop, addr, "ChurnBench");
+    server.setConnectionCallback(onConnection);
+    server.setMessageCallback([](const TcpConnectionPtr &, Buffer *buf, Timestamp) { buf->retrieveAll(); });
+    server.start();
+
+    pid_t child = ::fork();
+    if (child == 0) {
+        runChurnClient(addr);
+        return 0;
+    }
+
+    long startClosed = 0;
+    loop.runAfter(1.0, [&] { startClosed = g_closed; });
+    loop.runAfter(1.0 + seconds, [&] {
+        printf("connection churn: %10.0f connect + close per second\n",
+               static_cast<double>(g_closed - startClosed) / seconds);
+        loop.quit();
+    });
+    loop.loop();
+
+    ::kill(child, SIGKILL);
+    ::waitpid(child, nullptr, 0);
+    return 0;
+}
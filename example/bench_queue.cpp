@@ -0,0 +1,102 @@
+#include <mymuduo/EventLoop.h>
+#include <mymuduo/Logger.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// N 个生产者线程 queueInLoop 到 1 个 loop，统计 ops/s 以及从 queueInLoop 到开始执行的延迟分布
+// ./bench_queue [numProducers] [tasksPerProducer]
+
+static int64_t nowNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static std::vector<int64_t> g_latencies;  // 只在 loop 线程访问
+static std::atomic_long g_executed(0);
+
+static void task(int64_t enqueued) {
+    g_latencies.push_back(nowNanos() - enqueued);
+    ++g_executed;
+}
+
+static void report(const char *phase, double seconds, long tasks) {
+    std::sort(g_latencies.begin(), g_latencies.end());
+    size_t n = g_latencies.size();
+    printf("%-10s %12.0f ops/s   latency us: p50 %8.1f  p99 %8.1f  p99.9 %8.1f  max %8.1f\n",
+           phase,
+           tasks / seconds,
+           g_latencies[n / 2] / 1e3,
+           g_latencies[n * 99 / 100] / 1e3,
+           g_latencies[n * 999 / 1000] / 1e3,
+           g_latencies[n - 1] / 1e3);
+}
+
+// pauseMicros > 0 时生产者每次 queueInLoop 之后 sleep，测量 loop 不饱和时的唤醒延迟
+static void runPhase(EventLoop *loop, const char *phase, int numProducers, int tasksPerProducer, int pauseMicros) {
+    loop->runInLoop([] {});
+    g_executed = 0;
+    std::atomic_bool cleared(false);
+    loop->queueInLoop([&] {
+        g_latencies.clear();
+        g_latencies.reserve(static_cast<size_t>(numProducers) * tasksPerProducer);
+        cleared = true;
+    });
+    while (!cleared) {
+        ::usleep(100);
+    }
+
+    long total = static_cast<long>(numProducers) * tasksPerProducer;
+    int64_t start = nowNanos();
+    std::vector<std::thread> producers;
+    for (int p = 0; p < numProducers; ++p) {
+        producers.emplace_back([=] {
+            for (int i = 0; i < tasksPerProducer; ++i) {
+                loop->queueInLoop(std::bind(task, nowNanos()));
+                if (pauseMicros > 0) {
+                    ::usleep(pauseMicros);
+                }
+            }
+        });
+    }
+    for (auto &t : producers) {
+        t.join();
+    }
+    while (g_executed.load() < total) {
+        ::usleep(100);
+    }
+    double seconds = (nowNanos() - start) / 1e9;
+
+    std::atomic_bool reported(false);
+    loop->queueInLoop([&] {
+        report(phase, seconds, total);
+        reported = true;
+    });
+    while (!reported) {
+        ::usleep(100);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int numProducers = argc > 1 ? atoi(argv[1]) : 4;
+    int tasksPerProducer = argc > 2 ? atoi(argv[2]) : 500 * 1000;
+
+    Logger::setLogLevel(ERROR);
+    EventLoop loop;
+    std::thread driver([&] {
+        runPhase(&loop, "saturated", numProducers, tasksPerProducer, 0);
+        runPhase(&loop, "paced", numProducers, std::min(tasksPerProducer, 20000), 20);
+        loop.quit();
+    });
+    loop.loop();
+    driver.join();
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <mymuduo/Buffer.h>
+#include <mymuduo/Timestamp.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <vector>
+
+// 小消息（64B ~ 1KiB）的 reads/s，对比旧的 readFd（每次在栈上清零 64K 的 extrabuf）
+// ./bench_read [numReads]
+
+// 旧实现: 栈上 char extrabuf[65536] = {0}，readv 到 inline 部分和 extrabuf，再把 extrabuf 的部分拷贝出来
+static ssize_t legacyReadFd(int fd, std::vector<char> *inlineBuf, std::vector<char> *output) {
+    char extrabuf[65536] = {0};
+    struct iovec vec[2];
+    vec[0].iov_base = inlineBuf->data();
+    vec[0].iov_len = inlineBuf->size();
+    vec[1].iov_base = extrabuf;
+    vec[1].iov_len = sizeof(extrabuf);
+    ssize_t n = ::readv(fd, vec, 2);
+    if (n > static_cast<ssize_t>(inlineBuf->size())) {
+        output->insert(output->end(), extrabuf, extrabuf + n - inlineBuf->size());
+    }
+    return n;
+}
+
+static int64_t runLegacy(int fds[2], const char *msg, size_t len, int numReads) {
+    std::vector<char> inlineBuf(1024);
+    std::vector<char> output;
+    int64_t total = 0;
+    for (int i = 0; i < numReads; ++i) {
+        ::write(fds[0], msg, len);
+        total += legacyReadFd(fds[1], &inlineBuf, &output);
+        output.clear();
+    }
+    return total;
+}
+
+static int64_t runBuffer(int fds[2], const char *msg, size_t len, int numReads) {
+    Buffer buffer;
+    int64_t total = 0;
+    int savedErrno = 0;
+    for (int i = 0; i < numReads; ++i) {
+        ::write(fds[0], msg, len);
+        total += buffer.readFd(fds[1], &savedErrno);
+        buffer.retrieveAll();
+    }
+    return total;
+}
+
+int main(int argc, char *argv[]) {
+    int numReads = argc > 1 ? atoi(argv[1]) : 1000 * 1000;
+
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+        perror("socketpair");
+        return 1;
+    }
+    ::fcntl(fds[1], F_SETFL, O_NONBLOCK);
+
+    char msg[1024];
+    for (size_t i = 0; i < sizeof(msg); ++i) {
+        msg[i] = static_cast<char>('a' + i % 26);
+    }
+
+    printf("%6s %14s %14s\n", "size", "legacy reads/s", "Buffer reads/s");
+    for (size_t len = 64; len <= 1024; len *= 2) {
+        Timestamp start(Timestamp::now());
+        runLegacy(fds, msg, len, numReads);
+        double legacy = timeDifference(Timestamp::now(), start);
+
+        start = Timestamp::now();
+        runBuffer(fds, msg, len, numReads);
+        double current = timeDifference(Timestamp::now(), start);
+
+        printf("%6lu %14.0f %14.0f\n", len, numReads / legacy, numReads / current);
+    }
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+    return 0;
+}
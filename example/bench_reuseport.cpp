@@ -0,0 +1,83 @@
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+// 新连接速率: 单个 Acceptor 在 baseLoop 里 accept 再轮询分发（single），
+// 对比每个 subLoop 各自一个 SO_REUSEPORT Acceptor（perloop）
+// numClients 个客户端进程不停地 connect + close，统计服务端每秒建立并关闭的连接数
+// ./bench_reuseport [single|perloop] [numLoops] [numClients] [seconds]
+
+static std::atomic_long g_closed(0);  // 多个 subLoop 线程同时更新
+
+static void onConnection(const TcpConnectionPtr &conn) {
+    if (!conn->connected()) {
+        ++g_closed;
+    }
+}
+
+static void runChurnClient(const InetAddress &addr) {
+    while (true) {
+        int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+            ::close(sockfd);
+            ::usleep(1000);
+            continue;
+        }
+        ::close(sockfd);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "perloop";
+    int numLoops = argc > 2 ? atoi(argv[2]) : 4;
+    int numClients = argc > 3 ? atoi(argv[3]) : 4;
+    int seconds = argc > 4 ? atoi(argv[4]) : 5;
+
+    Logger::setLogLevel(ERROR);
+    EventLoop loop;
+    InetAddress addr(9995);
+    TcpServer server(&loop, addr, "ReusePortBench",
+                     mode == "perloop" ? TcpServer::kReusePortPerLoop : TcpServer::kNoReusePort);
+    server.setConnectionCallback(onConnection);
+    server.setMessageCallback([](const TcpConnectionPtr &, Buffer *buf, Timestamp) { buf->retrieveAll(); });
+    server.setThreadNum(numLoops);
+    server.start();
+
+    std::vector<pid_t> children;
+    for (int i = 0; i < numClients; ++i) {
+        pid_t child = ::fork();
+        if (child == 0) {
+            runChurnClient(addr);
+            return 0;
+        }
+        children.push_back(child);
+    }
+
+    long startClosed = 0;
+    loop.runAfter(1.0, [&] { startClosed = g_closed; });
+    loop.runAfter(1.0 + seconds, [&] {
+        printf("%-8s %2d loops  %2d clients: %10.0f connect + close per second\n",
+               mode.c_str(),
+               numLoops,
+               numClients,
+               static_cast<double>(g_closed - startClosed) / seconds);
+        loop.quit();
+    });
+    loop.loop();
+
+    for (pid_t child : children) {
+        ::kill(child, SIGKILL);
+        ::waitpid(child, nullptr, 0);
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include <mymuduo/Buffer.h>
+#include <mymuduo/SimdSearch.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Buffer 查找的微基准，64B - 64KiB 的可读数据，每种实现重复调用取平均
+// byte: 分隔符在最后，findEOL 对比 memchr（sse2 / avx2 级别的 findByte 就是 memchr，只看分发的开销）
+// crlf: 普通文本里只有最后一个 "\r\n"，findCRLF 对比 std::search
+// lines: 每行 lineBytes 字节以 "\r\n" 结尾，splitLines 对比逐行 memchr
+// scalar / sse2 / avx2 是 SimdSearch::setLevel 限制之后的 Buffer 实现，CPU 不支持的级别不测
+// ./bench_search [lineBytes]
+
+static double nowSec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static volatile size_t g_sink;
+
+// 每个尺寸至少跑 kBytesPerCase 字节
+static const size_t kBytesPerCase = 512 * 1024 * 1024;
+
+static void report(const char *kind, const char *impl, size_t size, const std::function<size_t()> &fn) {
+    size_t iterations = std::max<size_t>(kBytesPerCase / size, 1000);
+    size_t sum = 0;
+    double start = nowSec();
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += fn();
+    }
+    double elapsed = nowSec() - start;
+    g_sink = sum;
+    printf("%-5s %-10s %6zu B: %9.1f ns/call %7.2f GB/s\n",
+           kind,
+           impl,
+           size,
+           elapsed / iterations * 1e9,
+           size * static_cast<double>(iterations) / elapsed / 1e9);
+}
+
+static std::vector<SimdSearch::Level> supportedLevels() {
+    std::vector<SimdSearch::Level> levels;
+    for (int level = SimdSearch::kScalar; level <= SimdSearch::kAvx2; ++level) {
+        if (SimdSearch::setLevel(static_cast<SimdSearch::Level>(level)) == level) {
+            levels.push_back(static_cast<SimdSearch::Level>(level));
+        }
+    }
+    return levels;
+}
+
+int main(int argc, char *argv[]) {
+    size_t lineBytes = argc > 1 ? atoi(argv[1]) : 32;
+    const size_t sizes[] = {64, 256, 1024, 4096, 16384, 65536};
+    std::vector<SimdSearch::Level> levels = supportedLevels();
+
+    for (size_t size : sizes) {
+        // byte / crlf: 文本里没有分隔符，最后两个字节是 "\r\n"
+        std::string text(size, 'x');
+        for (size_t i = 0; i < size; ++i) {
+            text[i] = static_cast<char>('a' + i % 26);
+        }
+        text[size - 2] = '\r';
+        text[size - 1] = '\n';
+        Buffer buf(size);
+        buf.append(text.data(), text.size());
+        const char *begin = buf.peek();
+        const char *end = begin + buf.readableBytes();
+
+        report("byte", "memchr", size, [&] {
+            return static_cast<const char *>(::memchr(begin, '\n', end - begin)) - begin;
+        });
+        for (SimdSearch::Level level : levels) {
+            SimdSearch::setLevel(level);
+            report("byte", SimdSearch::levelName(level), size, [&] { return buf.findEOL() - begin; });
+        }
+
+        const char kCRLF[] = "\r\n";
+        report("crlf", "std::search", size, [&] { return std::search(begin, end, kCRLF, kCRLF + 2) - begin; });
+        for (SimdSearch::Level level : levels) {
+            SimdSearch::setLevel(level);
+            report("crlf", SimdSearch::levelName(level), size, [&] { return buf.findCRLF() - begin; });
+        }
+
+        // lines: 每行 lineBytes 字节，包括结尾的 "\r\n"
+        std::string lines;
+        while (lines.size() + lineBytes <= size) {
+            lines.append(lineBytes - 2, 'l');
+            lines.append("\r\n");
+        }
+        if (lines.empty()) {
+            continue;
+        }
+        Buffer lineBuf(size);
+        lineBuf.append(lines.data(), lines.size());
+        std::vector<StringPiece> pieces;
+        pieces.reserve(size);
+        report("lines", "memchr", lines.size(), [&] {
+            pieces.clear();
+            const char *p = lineBuf.peek();
+            const char *e = p + lineBuf.readableBytes();
+            while (const char *eol = static_cast<const char *>(::memchr(p, '\n', e - p))) {
+                const char *lineEnd = eol > p && eol[-1] == '\r' ? eol - 1 : eol;
+                pieces.push_back(StringPiece(p, lineEnd - p));
+                p = eol + 1;
+            }
+            return pieces.size();
+        });
+        for (SimdSearch::Level level : levels) {
+            SimdSearch::setLevel(level);
+            report("lines", SimdSearch::levelName(level), lines.size(), [&] {
+                pieces.clear();
+                lineBuf.splitLines(&pieces);
+                return pieces.size();
+            });
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// worker 线程 -> IO loop 的 send 吞吐，对比 const std::string&（拷贝一次）和 std::string&&（不拷贝）
+// ./bench_send [numMessages]
+
+static std::atomic<TcpConnection *> g_conn(nullptr);
+static TcpConnectionPtr g_connPtr;
+
+static void onConnection(const TcpConnectionPtr &conn) {
+    if (conn->connected()) {
+        g_connPtr = conn;
+        g_conn = conn.get();
+    }
+}
+
+static void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp time) { buf->retrieveAll(); }
+
+// 客户端只负责把数据读完
+static void drain(int sockfd, size_t total) {
+    std::vector<char> buf(256 * 1024);
+    size_t nread = 0;
+    while (nread < total) {
+        ssize_t n = ::read(sockfd, buf.data(), buf.size());
+        if (n <= 0) {
+            perror("read");
+            exit(1);
+        }
+        nread += n;
+    }
+}
+
+static double run(const std::string &mode, int sockfd, size_t size, int numMessages) {
+    TcpConnection *conn = g_conn.load();
+    std::thread reader(drain, sockfd, size * numMessages);
+
+    Timestamp start(Timestamp::now());
+    for (int i = 0; i < numMessages; ++i) {
+        std::string msg(size, 'm');  // worker 生成的响应
+        if (mode == "copy") {
+            conn->send(static_cast<const std::string &>(msg));
+        } else {
+            conn->send(std::move(msg));
+        }
+    }
+    reader.join();
+    return timeDifference(Timestamp::now(), start);
+}
+
+int main(int argc, char *argv[]) {
+    int numMessages = argc > 1 ? atoi(argv[1]) : 100 * 1000;
+
+    Logger::setLogLevel(ERROR);
+    EventLoop loop;
+    InetAddress addr(9990);
+    TcpServer server(&loop, addr, "SendBench");
+    server.setConnectionCallback(onConnection);
+    server.setMessageCallback(onMessage);
+    server.start();
+
+    std::thread worker([&] {
+        int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+            perror("connect");
+            exit(1);
+        }
+        while (g_conn.load() == nullptr) {
+            ::usleep(1000);
+        }
+
+        printf("%8s %14s %14s %14s\n", "size", "copy msgs/s", "move msgs/s", "move MiB/s");
+        const size_t sizes[] = {64, 4096, 64 * 1024, 1024 * 1024};
+        for (size_t size : sizes) {
+            // 每轮最多 256MiB，worker 比 socket 快的时候数据都排在 outputBuffer_ 里
+            int n = static_cast<int>(std::min<size_t>(numMessages, (256ULL << 20) / size));
+            double copy = run("copy", sockfd, size, n);
+            double move = run("move", sockfd, size, n);
+            printf("%8lu %14.0f %14.0f %14.1f\n", size, n / copy, n / move, n * size / move / (1024 * 1024));
+        }
+        ::close(sockfd);
+        loop.runInLoop([] { g_connPtr.reset(); });
+        loop.quit();
+    });
+
+    loop.loop();
+    worker.join();
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 8 个 worker 线程向 4 个 IO loop 上的连接跨线程 send 小消息，统计 sends/s
+// ./bench_send_batch [numProducers] [numLoops] [numConnections] [messagesPerProducer] [messageSize]
+
+static std::mutex g_mutex;
+static std::vector<TcpConnectionPtr> g_conns;
+
+static void onConnection(const TcpConnectionPtr &conn) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (conn->connected()) {
+        g_conns.push_back(conn);
+    }
+}
+
+static void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp time) { buf->retrieveAll(); }
+
+// 一个线程 poll 所有客户端 socket，把数据读完
+static void drain(const std::vector<int> &fds, size_t total) {
+    std::vector<struct pollfd> pfds(fds.size());
+    for (size_t i = 0; i < fds.size(); ++i) {
+        pfds[i].fd = fds[i];
+        pfds[i].events = POLLIN;
+    }
+    std::vector<char> buf(256 * 1024);
+    size_t nread = 0;
+    while (nread < total) {
+        ::poll(pfds.data(), pfds.size(), 1000);
+        for (size_t i = 0; i < pfds.size(); ++i) {
+            if (pfds[i].revents & POLLIN) {
+                ssize_t n = ::read(pfds[i].fd, buf.data(), buf.size());
+                if (n <= 0) {
+                    perror("read");
+                    exit(1);
+                }
+                nread += n;
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int numProducers = argc > 1 ? atoi(argv[1]) : 8;
+    int numLoops = argc > 2 ? atoi(argv[2]) : 4;
+    int numConns = argc > 3 ? atoi(argv[3]) : 16;
+    int messagesPerProducer = argc > 4 ? atoi(argv[4]) : 200 * 1000;
+    size_t messageSize = argc > 5 ? atoi(argv[5]) : 64;
+
+    Logger::setLogLevel(ERROR);
+    EventLoop loop;
+    InetAddress addr(9991);
+    TcpServer server(&loop, addr, "SendBatchBench");
+    server.setConnectionCallback(onConnection);
+    server.setMessageCallback(onMessage);
+    server.setThreadNum(numLoops);
+    server.start();
+
+    std::thread driver([&] {
+        std::vector<int> fds;
+        for (int i = 0; i < numConns; ++i) {
+            int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+                perror("connect");
+                exit(1);
+            }
+            fds.push_back(sockfd);
+        }
+        while (true) {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            if (static_cast<int>(g_conns.size()) == numConns) {
+                break;
+            }
+        }
+
+        size_t total = static_cast<size_t>(numProducers) * messagesPerProducer * messageSize;
+        std::thread reader(drain, std::cref(fds), total);
+
+        Timestamp start(Timestamp::now());
+        std::vector<std::thread> producers;
+        for (int p = 0; p < numProducers; ++p) {
+            producers.emplace_back([=] {
+                std::string msg(messageSize, 'w');
+                for (int i = 0; i < messagesPerProducer; ++i) {
+                    g_conns[(p + i) % g_conns.size()]->send(msg);
+                }
+            });
+        }
+        for (auto &t : producers) {
+            t.join();
+        }
+        double sendSeconds = timeDifference(Timestamp::now(), start);
+        reader.join();
+        double totalSeconds = timeDifference(Timestamp::now(), start);
+
+        long sends = static_cast<long>(numProducers) * messagesPerProducer;
+        printf("producers=%d loops=%d conns=%d size=%lu  %.0f sends/s (producer side)  %.0f sends/s (delivered)\n",
+               numProducers,
+               numLoops,
+               numConns,
+               messageSize,
+               sends / sendSeconds,
+               sends / totalSeconds);
+
+        for (int fd : fds) {
+            ::close(fd);
+        }
+        loop.quit();
+    });
+
+    loop.loop();
+    driver.join();
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include <mymuduo/FileCache.h>
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// 静态大文件的发送吞吐，对比 sendFile（FileCache + sendfile）和 read 到 std::string 再 send
+// ./bench_sendfile [sendfile|string] [fileMiB] [numClients] [seconds]
+
+static std::string g_mode = "sendfile";
+static std::string g_path;
+static size_t g_fileSize = 0;
+static FileCache g_cache;
+
+static void onConnection(const TcpConnectionPtr &conn) {}
+
+// 以前的做法: open + fstat + read 到 std::string 再 send，用户空间拷贝两次
+static void sendByString(const TcpConnectionPtr &conn) {
+    int fd = ::open(g_path.c_str(), O_RDONLY);
+    struct stat st;
+    ::fstat(fd, &st);
+    std::string content(st.st_size, '\0');
+    size_t nread = 0;
+    while (nread < content.size()) {
+        ssize_t n = ::read(fd, &content[nread], content.size() - nread);
+        if (n <= 0) {
+            break;
+        }
+        nread += n;
+    }
+    ::close(fd);
+    conn->send(content);
+}
+
+static void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp time) {
+    size_t requests = buf->readableBytes();
+    buf->retrieveAll();
+    for (size_t i = 0; i < requests; ++i) {
+        if (g_mode == "string") {
+            sendByString(conn);
+        } else {
+            CachedFilePtr file = g_cache.open(g_path);
+            conn->sendFile(file, 0, file->size());
+        }
+    }
+}
+
+static double cpuSeconds(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void client(const InetAddress &addr, std::atomic_bool *running, std::atomic_long *files) {
+    int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+        perror("connect");
+        exit(1);
+    }
+
+    std::vector<char> buf(256 * 1024);
+    while (running->load()) {
+        if (::write(sockfd, "g", 1) != 1) {
+            perror("write");
+            exit(1);
+        }
+        size_t nread = 0;
+        while (nread < g_fileSize) {
+            ssize_t n = ::read(sockfd, buf.data(), buf.size());
+            if (n <= 0) {
+                perror("read");
+                exit(1);
+            }
+            nread += n;
+        }
+        ++*files;
+    }
+    ::close(sockfd);
+}
+
+int main(int argc, char *argv[]) {
+    g_mode = argc > 1 ? argv[1] : "sendfile";
+    g_fileSize = (argc > 2 ? atoi(argv[2]) : 8) * 1024 * 1024;
+    int numClients = argc > 3 ? atoi(argv[3]) : 4;
+    int seconds = argc > 4 ? atoi(argv[4]) : 3;
+
+    Logger::setLogLevel(ERROR);
+
+    char path[] = "/tmp/bench_sendfile.XXXXXX";
+    int fd = ::mkstemp(path);
+    g_path = path;
+    std::string chunk(1024 * 1024, 'f');
+    for (size_t written = 0; written < g_fileSize; written += chunk.size()) {
+        if (::write(fd, chunk.data(), chunk.size()) != static_cast<ssize_t>(chunk.size())) {
+            perror("write");
+            return 1;
+        }
+    }
+    ::close(fd);
+
+    EventLoop loop;
+    InetAddress addr(9989);
+    TcpServer server(&loop, addr, "SendfileBench");
+    server.setConnectionCallback(onConnection);
+    server.setMessageCallback(onMessage);
+    server.start();
+
+    std::atomic_bool running(true);
+    std::atomic_long files(0);
+    std::thread driver([&] {
+        std::vector<std::thread> clients;
+        for (int i = 0; i < numClients; ++i) {
+            clients.emplace_back(client, std::cref(addr), &running, &files);
+        }
+        ::sleep(seconds);
+        running = false;
+        for (auto &t : clients) {
+            t.join();
+        }
+        loop.quit();
+    });
+
+    double threadStart = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+    double processStart = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID);
+    Timestamp start(Timestamp::now());
+    loop.loop();
+    double elapsed = timeDifference(Timestamp::now(), start);
+    double threadCpu = cpuSeconds(CLOCK_THREAD_CPUTIME_ID) - threadStart;
+    double processCpu = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID) - processStart;
+    driver.join();
+    ::unlink(path);
+
+    long n = files.load();
+    printf("mode=%s file=%luMiB clients=%d  %.2f GB/s  loop thread cpu %.0f%%  process cpu %.0f%%\n",
+           g_mode.c_str(),
+           g_fileSize / (1024 * 1024),
+           numClients,
+           n * g_fileSize / elapsed / 1e9,
+           threadCpu * 100 / elapsed,
+           processCpu * 100 / elapsed);
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpClient.h>
+#include <mymuduo/TcpServer.h>
+
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// TCP 代理的吞吐和每 GB 的 CPU: source => proxy(TcpConnection::forwardTo) => sink
+// 代理在父进程（一个 loop），source 和 sink 在 fork 出来的子进程里用阻塞 socket 收发，统计 sink 收到的字节数和时间
+// splice: forwardTo(peer, true)，copy: forwardTo(peer, false) 经过 inputBuffer_ 拷贝
+// ./bench_splice_proxy [splice|copy] [streams] [totalMiB per stream] [chunkKiB]
+
+static const uint16_t kProxyPort = 9995;
+static const uint16_t kSinkPort = 9994;
+
+static int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static double cpuSeconds() {
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+struct Result {
+    int64_t bytes;
+    int64_t elapsedNs;
+};
+
+// 子进程: streams 个 sink 连接读到 EOF，streams 个 source 连接各写 totalBytes
+static void runSourceAndSink(int streams, int64_t totalBytes, size_t chunk, int resultFd) {
+    int listenfd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    ::setsockopt(listenfd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    InetAddress sinkAddr(kSinkPort);
+    if (::bind(listenfd, (const sockaddr *)sinkAddr.getSockAddr(), sizeof(sockaddr_in)) < 0 ||
+        ::listen(listenfd, 128) < 0) {
+        perror("sink listen");
+        ::_exit(1);
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<int64_t> received(streams, 0);
+    int64_t firstByte = 0;
+    for (int i = 0; i < streams; ++i) {
+        threads.emplace_back([&, i] {
+            int connfd = ::accept(listenfd, nullptr, nullptr);
+            std::vector<char> buf(256 * 1024);
+            ssize_t n = 0;
+            while ((n = ::read(connfd, buf.data(), buf.size())) > 0) {
+                if (firstByte == 0) {
+                    firstByte = nowNs();
+                }
+                received[i] += n;
+            }
+            ::close(connfd);
+        });
+    }
+    for (int i = 0; i < streams; ++i) {
+        threads.emplace_back([&] {
+            int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+            InetAddress proxyAddr(kProxyPort);
+            if (::connect(sockfd, (const sockaddr *)proxyAddr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+                perror("connect proxy");
+                ::_exit(1);
+            }
+            std::string data(chunk, 's');
+            for (int64_t sent = 0; sent < totalBytes;) {
+                ssize_t n = ::write(sockfd, data.data(), std::min<int64_t>(chunk, totalBytes - sent));
+                if (n <= 0) {
+                    perror("source write");
+                    ::_exit(1);
+                }
+                sent += n;
+            }
+            ::close(sockfd);
+        });
+    }
+    for (std::thread &t : threads) {
+        t.join();
+    }
+
+    Result result;
+    result.bytes = 0;
+    for (int64_t n : received) {
+        result.bytes += n;
+    }
+    result.elapsedNs = nowNs() - firstByte;
+    if (::write(resultFd, &result, sizeof(result)) != sizeof(result)) {
+        ::_exit(1);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "splice";
+    int streams = argc > 2 ? atoi(argv[2]) : 1;
+    int64_t totalBytes = (argc > 3 ? atoll(argv[3]) : 2048) * 1024 * 1024;
+    size_t chunk = (argc > 4 ? atoi(argv[4]) : 64) * 1024;
+    bool useSplice = mode == "splice";
+
+    Logger::setLogLevel(FATAL);
+    EventLoop loop;
+    InetAddress proxyAddr(kProxyPort);
+    InetAddress sinkAddr(kSinkPort);
+    TcpServer server(&loop, proxyAddr, "Proxy");
+    std::map<std::string, std::unique_ptr<TcpClient>> upstreams;
+
+    // 下游连接建立之后再连上游，连上之后两个方向各 forwardTo 一次；在此之前下游的数据留在 inputBuffer_ 里
+    server.setConnectionCallback([&](const TcpConnectionPtr &down) {
+        if (!down->connected()) {
+            return;
+        }
+        std::unique_ptr<TcpClient> client(new TcpClient(&loop, sinkAddr, "Upstream"));
+        std::weak_ptr<TcpConnection> weakDown(down);
+        client->setConnectionCallback([weakDown, useSplice](const TcpConnectionPtr &up) {
+            TcpConnectionPtr down = weakDown.lock();
+            if (up->connected() && down) {
+                down->forwardTo(up, useSplice);
+                up->forwardTo(down, useSplice);
+            }
+        });
+        client->connect();
+        upstreams[down->name()] = std::move(client);
+    });
+    server.setMessageCallback([](const TcpConnectionPtr &, Buffer *, Timestamp) {});
+    server.start();
+
+    int fds[2];
+    if (::pipe(fds) < 0) {
+        perror("pipe");
+        return 1;
+    }
+    double cpuStart = cpuSeconds();
+    pid_t child = ::fork();
+    if (child == 0) {
+        runSourceAndSink(streams, totalBytes, chunk, fds[1]);
+        ::_exit(0);  // 子进程里没有 loop 线程，不能析构 server
+    }
+    ::close(fds[1]);  // 子进程异常退出时 read 返回 0
+
+    int status = 0;
+    loop.runEvery(0.05, [&] {
+        if (::waitpid(child, &status, WNOHANG) == child) {
+            loop.quit();
+        }
+    });
+    loop.loop();
+    double cpu = cpuSeconds() - cpuStart;
+
+    Result result;
+    if (::read(fds[0], &result, sizeof(result)) != sizeof(result) || result.elapsedNs <= 0) {
+        printf("%-6s failed, child status %d\n", mode.c_str(), status);
+        return 1;
+    }
+    if (result.bytes != streams * totalBytes) {
+        printf("%-6s lost %ld bytes\n", mode.c_str(), static_cast<long>(streams * totalBytes - result.bytes));
+    }
+    double gib = result.bytes / (1024.0 * 1024 * 1024);
+    printf("%-6s %2d streams %4zu KiB writes: %6.2f GiB/s   proxy cpu %6.3f s/GiB\n",
+           mode.c_str(),
+           streams,
+           chunk / 1024,
+           gib / (result.elapsedNs / 1e9),
+           cpu / gib);
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <mymuduo/EventLoop.h>
+#include <mymuduo/Logger.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <new>
+#include <thread>
+
+// 统计 queueInLoop 每个任务的堆分配次数，对比 std::function<void()>
+// 任务的形状和库里 runInLoop / queueInLoop 的调用点一样
+// ./bench_task [tasksPerRound]
+
+static std::atomic_long g_allocs(0);
+
+void *operator new(size_t size) {
+    ++g_allocs;
+    void *p = malloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+
+struct Conn : std::enable_shared_from_this<Conn> {
+    void connectEstablished() {}
+    void shutdownInLoop() {}
+};
+
+struct Server {
+    void removeConnectionInLoop(const std::shared_ptr<Conn> &conn) {}
+};
+
+using ConnPtr = std::shared_ptr<Conn>;
+using WriteComplete = std::function<void(const ConnPtr &)>;
+using HighWaterMark = std::function<void(const ConnPtr &, size_t)>;
+
+template <typename MakeTask>
+static void measure(EventLoop *loop, const char *name, int tasks, MakeTask make) {
+    // 先热身一轮，让对象池和各种缓存就位
+    for (int round = 0; round < 2; ++round) {
+        std::atomic_bool done(false);
+        long before = 0;
+        long queued = 0;
+        long stdFunction = 0;
+        loop->runInLoop([&] {
+            before = g_allocs.load();
+            for (int i = 0; i < tasks; ++i) {
+                loop->queueInLoop(make());
+            }
+            queued = g_allocs.load() - before;
+
+            before = g_allocs.load();
+            for (int i = 0; i < tasks; ++i) {
+                std::function<void()> f(make());
+                f();
+            }
+            stdFunction = g_allocs.load() - before;
+            loop->queueInLoop([&] { done = true; });
+        });
+        while (!done) {
+            ::usleep(100);
+        }
+        if (round == 1) {
+            printf("%-48s queueInLoop %6.2f allocs/task   std::function %6.2f allocs/task\n",
+                   name,
+                   static_cast<double>(queued) / tasks,
+                   static_cast<double>(stdFunction) / tasks);
+        }
+    }
+}
+
+// 其他线程 queueInLoop，等 loop 执行完之后再统计
+static void measureCrossThread(EventLoop *loop, int tasks, const ConnPtr &conn) {
+    for (int round = 0; round < 2; ++round) {
+        std::atomic_int executed(0);
+        long before = g_allocs.load();
+        for (int i = 0; i < tasks; ++i) {
+            loop->queueInLoop(std::bind(&Conn::connectEstablished, conn));
+        }
+        long queued = g_allocs.load() - before;
+        loop->queueInLoop([&] { ++executed; });
+        while (executed.load() == 0) {
+            ::usleep(100);
+        }
+        if (round == 1) {
+            printf("%-48s queueInLoop %6.2f allocs/task\n",
+                   "cross-thread bind(&Conn::m, conn)",
+                   static_cast<double>(queued) / tasks);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int tasks = argc > 1 ? atoi(argv[1]) : 512;  // 小于对象池容量，loop 来得及消费
+
+    Logger::setLogLevel(ERROR);
+    EventLoop loop;
+    std::thread driver([&] {
+        ConnPtr conn = std::make_shared<Conn>();
+        Server server;
+        WriteComplete writeComplete = [](const ConnPtr &) {};
+        HighWaterMark highWaterMark = [](const ConnPtr &, size_t) {};
+
+        measure(&loop, "bind(&Conn::connectEstablished, conn)", tasks, [&] {
+            return std::bind(&Conn::connectEstablished, conn);
+        });
+        measure(&loop, "bind(&Conn::shutdownInLoop, this)", tasks, [&] {
+            return std::bind(&Conn::shutdownInLoop, conn.get());
+        });
+        measure(&loop, "bind(&Server::removeConnectionInLoop, this, c)", tasks, [&] {
+            return std::bind(&Server::removeConnectionInLoop, &server, conn);
+        });
+        measure(&loop, "bind(writeCompleteCallback_, conn)", tasks, [&] {
+            return std::bind(writeComplete, conn);
+        });
+        measure(&loop, "bind(highWaterMarkCallback_, conn, len)", tasks, [&] {
+            return std::bind(highWaterMark, conn, static_cast<size_t>(64));
+        });
+        measureCrossThread(&loop, tasks, conn);
+        loop.quit();
+    });
+    loop.loop();
+    driver.join();
+    return 0;
+}
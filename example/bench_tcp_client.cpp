@@ -0,0 +1,155 @@
+#include <mymuduo/ConnectionPool.h>
+#include <mymuduo/EventLoopThread.h>
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpClient.h>
+#include <mymuduo/TcpServer.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 本地 echo TcpServer 作为上游，客户端一个 loop 上 concurrency 个请求并发，每个请求发 messageBytes 字节等完整回显
+// pool: ConnectionPool 预先建立 concurrency 个连接，acquire / release 复用
+// connect: 每个请求新建一个 TcpClient，连接建立之后发送，收到回显之后关闭连接
+// ./bench_tcp_client [pool|connect] [concurrency] [seconds] [messageBytes]
+
+static std::string g_message;
+static int64_t g_completed = 0;
+static bool g_running = true;
+
+static void onEcho(const TcpConnectionPtr &conn, Buffer *buf, Timestamp) { conn->send(buf); }
+
+// ---------------- pool ----------------
+
+struct PoolBench {
+    ConnectionPool *pool;
+
+    void issue() {
+        if (g_running) {
+            pool->acquire([this](const TcpConnectionPtr &conn) {
+                if (conn) {
+                    conn->send(g_message);
+                }
+            });
+        }
+    }
+
+    void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp) {
+        if (buf->readableBytes() < g_message.size()) {
+            return;
+        }
+        buf->retrieve(g_message.size());
+        ++g_completed;
+        pool->release(conn);
+        issue();
+    }
+};
+
+// ---------------- connect per request ----------------
+
+struct ConnectBench {
+    EventLoop *loop;
+    InetAddress serverAddr;
+    std::vector<std::unique_ptr<TcpClient>> clients;  // 每个并发槽位一个
+
+    void issue(size_t slot) {
+        if (!g_running) {
+            return;
+        }
+        TcpClient *client = new TcpClient(loop, serverAddr, "ConnectBench");
+        client->setConnectionCallback([this, slot](const TcpConnectionPtr &conn) {
+            if (conn->connected()) {
+                conn->send(g_message);
+            } else {
+                // 在 TcpClient 的回调里不能析构它，放到 loop 的回调队列里再换下一个
+                loop->queueInLoop([this, slot] { issue(slot); });
+            }
+        });
+        client->setMessageCallback([](const TcpConnectionPtr &conn, Buffer *buf, Timestamp) {
+            if (buf->readableBytes() < g_message.size()) {
+                return;
+            }
+            buf->retrieve(g_message.size());
+            ++g_completed;
+            conn->forceClose();
+        });
+        clients[slot].reset(client);
+        client->connect();
+    }
+};
+
+int main(int argc, char *argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "pool";
+    int concurrency = argc > 2 ? atoi(argv[2]) : 16;
+    int seconds = argc > 3 ? atoi(argv[3]) : 5;
+    size_t messageBytes = argc > 4 ? atoi(argv[4]) : 64;
+    g_message.assign(messageBytes, 'q');
+
+    Logger::setLogLevel(FATAL);
+    EventLoopThread serverThread(EventLoopThread::ThreadInitCallback(), "upstream");
+    EventLoop *serverLoop = serverThread.startLoop();
+    InetAddress serverAddr(9997);
+    std::unique_ptr<TcpServer> server;
+    serverLoop->runInLoop([&] {
+        server.reset(new TcpServer(serverLoop, serverAddr, "Upstream"));
+        server->setConnectionCallback([](const TcpConnectionPtr &) {});
+        server->setMessageCallback(onEcho);
+        server->start();
+    });
+
+    EventLoop loop;
+    std::unique_ptr<ConnectionPool> pool;
+    PoolBench poolBench;
+    ConnectBench connectBench{&loop, serverAddr, {}};
+    int64_t startCompleted = 0;
+
+    if (mode == "pool") {
+        pool.reset(new ConnectionPool(&loop, serverAddr, "Pool", concurrency));
+        poolBench.pool = pool.get();
+        pool->setMessageCallback(std::bind(&PoolBench::onMessage,
+                                           &poolBench,
+                                           std::placeholders::_1,
+                                           std::placeholders::_2,
+                                           std::placeholders::_3));
+        pool->start();
+        for (int i = 0; i < concurrency; ++i) {
+            poolBench.issue();  // 连接还没建立时排队，建立之后交给等待者
+        }
+    } else {
+        connectBench.clients.resize(concurrency);
+        for (int i = 0; i < concurrency; ++i) {
+            connectBench.issue(i);
+        }
+    }
+
+    // 预热 1 秒再开始统计
+    loop.runAfter(1.0, [&] { startCompleted = g_completed; });
+    loop.runAfter(1.0 + seconds, [&] {
+        int64_t completed = g_completed - startCompleted;
+        printf("%-7s %3d concurrent %4zu bytes: %9.0f requests/s\n",
+               mode.c_str(),
+               concurrency,
+               messageBytes,
+               static_cast<double>(completed) / seconds);
+        g_running = false;
+        loop.quit();
+    });
+    loop.loop();
+
+    pool.reset();
+    connectBench.clients.clear();
+    loop.runAfter(0.1, [&] { loop.quit(); });  // 处理析构时排队的关闭
+    loop.loop();
+    // TcpServer 只能在它的 loop 线程析构，等析构完再退出
+    std::promise<void> stopped;
+    serverLoop->runInLoop([&] {
+        server.reset();
+        stopped.set_value();
+    });
+    stopped.get_future().wait();
+    return 0;
+}
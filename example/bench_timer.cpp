@@ -0,0 +1,65 @@
+#include <mymuduo/EventLoop.h>
+#include <mymuduo/Timestamp.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// 定时器插入/取消/触发的吞吐，默认 100 万个定时器
+// ./bench_timer [numTimers]
+
+static EventLoop *g_loop = nullptr;
+static int g_numTimers = 0;
+static int g_fired = 0;
+static Timestamp g_firstFire;
+static Timestamp g_lastFire;
+
+static void noop() {}
+
+static void onFire() {
+    if (g_fired++ == 0) {
+        g_firstFire = Timestamp::now();
+    }
+    if (g_fired == g_numTimers) {
+        g_lastFire = Timestamp::now();
+        g_loop->quit();
+    }
+}
+
+static void report(const char *what, int n, Timestamp start, Timestamp end) {
+    double seconds = timeDifference(end, start);
+    printf("%-8s %9d timers in %8.3f ms, %12.0f ops/s\n", what, n, seconds * 1000, n / seconds);
+}
+
+int main(int argc, char *argv[]) {
+    g_numTimers = argc > 1 ? atoi(argv[1]) : 1000 * 1000;
+
+    EventLoop loop;
+    g_loop = &loop;
+
+    std::vector<TimerId> timers;
+    timers.reserve(g_numTimers);
+
+    // 1. 插入: 到期时间分布在 1s ~ 1h，覆盖时间轮的多个层级
+    Timestamp start(Timestamp::now());
+    for (int i = 0; i < g_numTimers; ++i) {
+        timers.push_back(loop.runAfter(1.0 + (i % 3600), noop));
+    }
+    report("insert", g_numTimers, start, Timestamp::now());
+
+    // 2. 取消
+    start = Timestamp::now();
+    for (size_t i = 0; i < timers.size(); ++i) {
+        loop.cancel(timers[i]);
+    }
+    report("cancel", g_numTimers, start, Timestamp::now());
+
+    // 3. 触发: 全部定时器在 100ms 后同一个 tick 到期，统计第一个到最后一个的触发速率
+    for (int i = 0; i < g_numTimers; ++i) {
+        loop.runAfter(0.1, onFire);
+    }
+    loop.loop();
+    report("fire", g_numTimers, g_firstFire, g_lastFire);
+
+    return 0;
+}
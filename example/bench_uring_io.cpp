@@ -0,0 +1,188 @@
+#include <mymuduo/Logger.h>
+#include <mymuduo/TcpServer.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// io_uring 完成模式（provided buffer RECV + SENDMSG + multishot ACCEPT）和就绪模式（readFd / writeFd）的对比
+// 1. 建立 numConnections 个空闲连接，统计服务端进程每个连接占用的内存（VmRSS 的增量，不包括内核 socket 缓冲区）
+// 2. 其中 activeConnections 个连接做 echo，每个连接收到回显之后再发下一条，统计吞吐和每个请求的 poller 系统调用
+//    （完成模式的 io_uring_enter 已经包括了收发，就绪模式每个请求还要再加上 read + write 两次系统调用）
+// 客户端 fork 到另一个进程，使用 epoll
+// ./bench_uring_io [epoll|uring|completion] [numConnections] [activeConnections] [messageBytes] [seconds]
+
+static int g_numConnections = 0;
+static int g_connections = 0;
+static long g_bytes = 0;  // 只在 loop 线程访问，大消息可能分多次回调，按字节数折算请求数
+static std::function<void()> g_allConnected;
+
+static double cpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);  // 只统计服务端进程
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long rssKb() {
+    FILE *fp = fopen("/proc/self/status", "r");
+    char line[256];
+    long kb = 0;
+    while (fp != nullptr && fgets(line, sizeof(line), fp) != nullptr) {
+        if (strncmp(line, "VmRSS:", 6) == 0) {
+            kb = atol(line + 6);
+            break;
+        }
+    }
+    if (fp != nullptr) {
+        fclose(fp);
+    }
+    return kb;
+}
+
+static void onConnection(const TcpConnectionPtr &conn) {
+    if (conn->connected() && ++g_connections == g_numConnections) {
+        g_allConnected();
+    }
+}
+
+static void onMessage(const TcpConnectionPtr &conn, Buffer *buf, Timestamp time) {
+    g_bytes += buf->readableBytes();
+    conn->send(buf);
+}
+
+// 连接全部建立之后收到 SIGUSR1 才开始发送，空闲连接的内存先统计
+static volatile sig_atomic_t g_start = 0;
+static void onStart(int) { g_start = 1; }
+
+static void runClients(const InetAddress &addr, int numConnections, int activeConnections, size_t messageBytes) {
+    int epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    std::vector<size_t> received(numConnections + 1024, 0);
+    std::vector<int> active;
+    std::string message(messageBytes, 'm');
+    for (int i = 0; i < numConnections; ++i) {
+        int sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(sockfd, (const sockaddr *)addr.getSockAddr(), sizeof(sockaddr_in)) < 0) {
+            perror("connect");
+            exit(1);
+        }
+        if (i < activeConnections) {
+            ::fcntl(sockfd, F_SETFL, O_NONBLOCK);
+            if (static_cast<size_t>(sockfd) >= received.size()) {
+                received.resize(sockfd + 1, 0);
+            }
+            struct epoll_event ev;
+            ev.events = EPOLLIN;
+            ev.data.fd = sockfd;
+            ::epoll_ctl(epfd, EPOLL_CTL_ADD, sockfd, &ev);
+            active.push_back(sockfd);
+        }
+    }
+
+    while (!g_start) {
+        ::usleep(1000);
+    }
+    for (int sockfd : active) {
+        if (::write(sockfd, message.data(), message.size()) != static_cast<ssize_t>(message.size())) {
+            perror("write");
+            exit(1);
+        }
+    }
+
+    std::vector<struct epoll_event> events(1024);
+    char buf[64 * 1024];
+    while (true) {
+        int n = ::epoll_wait(epfd, events.data(), static_cast<int>(events.size()), -1);
+        for (int i = 0; i < n; ++i) {
+            int sockfd = events[i].data.fd;
+            ssize_t nread = ::read(sockfd, buf, sizeof(buf));
+            if (nread <= 0) {
+                if (nread < 0 && errno == EAGAIN) {
+                    continue;
+                }
+                exit(0);
+            }
+            received[sockfd] += nread;
+            if (received[sockfd] >= messageBytes) {
+                received[sockfd] -= messageBytes;
+                if (::write(sockfd, message.data(), message.size()) != static_cast<ssize_t>(message.size())) {
+                    exit(0);
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "completion";
+    int numConnections = argc > 2 ? atoi(argv[2]) : 10000;
+    int activeConnections = argc > 3 ? atoi(argv[3]) : 1000;
+    size_t messageBytes = argc > 4 ? atoi(argv[4]) : 64;
+    int seconds = argc > 5 ? atoi(argv[5]) : 5;
+    g_numConnections = numConnections;
+    activeConnections = std::min(activeConnections, numConnections);
+
+    Logger::setLogLevel(ERROR);
+    EventLoop loop(mode == "epoll" ? EventLoop::kEPollPoller : EventLoop::kIoUringPoller);
+    InetAddress addr(9992);
+    TcpServer server(&loop, addr, "UringIoBench");
+    server.setConnectionCallback(onConnection);
+    server.setMessageCallback(onMessage);
+    server.setCompletionMode(mode == "completion");
+    server.start();
+
+    ::signal(SIGUSR1, onStart);
+    pid_t child = ::fork();
+    if (child == 0) {
+        runClients(addr, numConnections, activeConnections, messageBytes);
+        return 0;
+    }
+
+    long startRss = rssKb();
+    long idleRss = 0;
+    long startBytes = 0;
+    uint64_t startSyscalls = 0;
+    double startCpu = 0;
+    g_allConnected = [&] {
+        // 等 1 秒让连接都稳定下来，统计空闲连接的内存之后再开始 echo
+        loop.runAfter(1.0, [&] {
+            idleRss = rssKb();
+            ::kill(child, SIGUSR1);
+        });
+        loop.runAfter(2.0, [&] {
+            startBytes = g_bytes;
+            startSyscalls = loop.pollerSyscallCount();
+            startCpu = cpuSeconds();
+        });
+        loop.runAfter(2.0 + seconds, [&] {
+            double requests = static_cast<double>(g_bytes - startBytes) / messageBytes;
+            printf("%-10s %d connections (%d active)  %zu bytes: %6.0f bytes/conn idle   %9.0f requests/s   "
+                   "server CPU %5.2f us/request   poller syscalls %.4f/request\n",
+                   mode.c_str(),
+                   numConnections,
+                   activeConnections,
+                   messageBytes,
+                   (idleRss - startRss) * 1024.0 / numConnections,
+                   requests / seconds,
+                   (cpuSeconds() - startCpu) * 1e6 / requests,
+                   (loop.pollerSyscallCount() - startSyscalls) / requests);
+            loop.quit();
+        });
+    };
+    loop.loop();
+
+    ::kill(child, SIGKILL);
+    ::waitpid(child, nullptr, 0);
+    return 0;
+}